@@ -53,16 +53,12 @@ public:
 
     virtual const TfToken& GetPrimType() const = 0;
 
-    void SetUsed(bool used) { _used = used; }
-    bool IsUsed() const { return _used; }
-
     void SetPath(const SdfPath& path) { _path = path; }
     const SdfPath& GetPath() const { return _path; }
 
 private:
     AdapterSharedState* _sharedState;
     SdfPath _path;
-    bool _used{false};
 };
 
 using HdNukeAdapterPtr = std::shared_ptr<HdNukeAdapter>;
@@ -28,6 +28,8 @@
 #include <DDImage/LightOp.h>
 #include <DDImage/Iop.h>
 
+#include <vector>
+
 using namespace DD::Image;
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -43,50 +45,55 @@ HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::Request(const TfTo
 {
     auto fullPath = path.IsAbsolutePath() ? path : _sceneDelegate->GetConfig().DefaultDelegateID().AppendPath(path);
 
-    _requestedAdapters.insert(fullPath);
-
-    auto iter = _adapters.find(fullPath);
-    if (iter != _adapters.end()) {
+    AdapterHandle handle = GetHandle(fullPath);
+    if (const AdapterInfo* info = _adapters.Get(handle)) {
+        _Touch(handle);
+        // The adapter may request others, which moves its info.
+        HdNukeAdapterPtr adapter = info->adapter;
         // If we have requested this adapter before but it is not fulfilled try
         // to fulfill it.
         if (auto unfulfilled = GetUnfulfilledPromise(fullPath)) {
-            if (iter->second.adapter->SetUp(this, nukeData)) {
-                unfulfilled->adapter = iter->second.adapter;
+            if (adapter->SetUp(this, nukeData)) {
+                unfulfilled->adapter = adapter;
                 _unfulfilledPromises.erase(fullPath);
             }
             return unfulfilled;
         }
         // An adapter may not be able to correctly update itself. In this case,
         // it becomes unfulfilled.
-        bool fulfilled = iter->second.adapter->Update(this, nukeData);
+        bool fulfilled = adapter->Update(this, nukeData);
         if (!fulfilled) {
-            auto promise = std::make_shared<AdapterPromise>(fullPath, nullptr);
+            auto promise = std::make_shared<AdapterPromise>(fullPath, nullptr, handle);
             _unfulfilledPromises[fullPath] = promise;
             return promise;
         }
-        return std::make_shared<AdapterPromise>(fullPath, iter->second.adapter);
+        return std::make_shared<AdapterPromise>(fullPath, adapter, handle);
     }
 
     HdNukeAdapterFactory& factory = HdNukeAdapterFactory::Instance();
-    auto insert = _adapters.emplace(fullPath, AdapterInfo{
-        factory.Create(adapterType, _sceneDelegate->GetSharedState())});
-    AdapterInfo& info = insert.first->second;
+    HdNukeAdapterPtr adapter = factory.Create(adapterType, _sceneDelegate->GetSharedState());
+    handle = _adapters.Insert(AdapterInfo{adapter});
+    _adapters.Get(handle)->path = fullPath;
+    _handles[fullPath] = handle;
+    _Touch(handle);
 
-    HdNukeAdapterPtr adapter = info.adapter;
-    adapter->SetUsed(true);
     adapter->SetPath(fullPath);
     bool fulfilled = adapter->SetUp(this, nukeData);
 
-    info.primType = adapter->GetPrimType();
-    info.nukeData = nukeData;
+    const TfToken primType = adapter->GetPrimType();
+    // Setting up may have added adapters, so the info is looked up again.
+    if (AdapterInfo* info = _adapters.Get(handle)) {
+        info->primType = primType;
+        info->nukeData = nukeData;
+    }
 
-    _adaptersByPrimType[info.primType].insert(fullPath);
+    _adaptersByPrimType[primType].insert(fullPath);
 
     if (fulfilled) {
-        return std::make_shared<AdapterPromise>(fullPath, adapter);
+        return std::make_shared<AdapterPromise>(fullPath, adapter, handle);
     }
 
-    auto promise = std::make_shared<AdapterPromise>(fullPath, nullptr);
+    auto promise = std::make_shared<AdapterPromise>(fullPath, nullptr, handle);
     _unfulfilledPromises[fullPath] = promise;
 
     return promise;
@@ -94,10 +101,7 @@ HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::Request(const TfTo
 
 HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::Request(GeoInfo* geoInfo, const SdfPath& parentPath)
 {
-    const SdfPath& geoRoot = _sceneDelegate->GetConfig().GeoRoot();
-    GeoOp* sourceOp = op_cast<GeoOp*>(geoInfo->final_geo);
-    SdfPath subtree = geoRoot.AppendPath(GetPathFromOp(sourceOp))
-                             .AppendPath(GetRprimSubPath(*geoInfo, GetRprimType(*geoInfo)));
+    SdfPath subtree = _sceneDelegate->GetGeoInfoPath(*geoInfo);
 
     auto primType = HdNukeAdapterManagerPrimTypes->GenericGeoInfo;
     if (geoInfo->primitive(0)->getPrimitiveType() == eParticlesSprite) {
@@ -166,10 +170,7 @@ HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::Request(const Hydr
 HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::Request(GeoInfoVector& instances, const SdfPath& parentPath)
 {
     auto geoInfo = instances.front();
-    const SdfPath& geoRoot = _sceneDelegate->GetConfig().GeoRoot();
-    GeoOp* sourceOp = op_cast<GeoOp*>(geoInfo->final_geo);
-    SdfPath subtree = geoRoot.AppendPath(GetPathFromOp(sourceOp))
-                             .AppendPath(GetRprimSubPath(*geoInfo, GetRprimType(*geoInfo)));
+    SdfPath subtree = _sceneDelegate->GetGeoInfoPath(*geoInfo);
 
     return Request(HdNukeAdapterManagerPrimTypes->InstancedGeo, subtree, VtValue{instances});
 }
@@ -177,17 +178,32 @@ HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::Request(GeoInfoVec
 HdNukeAdapterManager::AdapterPromisePtr HdNukeAdapterManager::AddAdapter(const HdNukeAdapterPtr& adapter, const TfToken& primType, const SdfPath& path)
 {
     auto fullPath = path.IsAbsolutePath() ? path : _sceneDelegate->GetConfig().DefaultDelegateID().AppendPath(path);
-    _adapters[fullPath] = AdapterInfo{adapter, primType};
+    AdapterHandle handle = GetHandle(fullPath);
+    if (!_adapters.Contains(handle)) {
+        handle = _adapters.Insert(AdapterInfo{});
+        _handles[fullPath] = handle;
+    }
+    // Adapters added this way count as unused until they are requested.
+    _Unlink(handle);
+    AdapterInfo& info = *_adapters.Get(handle);
+    info = AdapterInfo{adapter, primType};
+    info.path = fullPath;
+    _Untouch(handle);
     _adaptersByPrimType[primType].insert(fullPath);
-    return std::make_shared<AdapterPromise>(fullPath, adapter);
+    return std::make_shared<AdapterPromise>(fullPath, adapter, handle);
 }
 
 unsigned int HdNukeAdapterManager::TryFulfillPromises()
 {
     for (auto iter = _unfulfilledPromises.begin(); iter != _unfulfilledPromises.end();) {
-        auto adapter = GetAdapter(iter->first);
-        if (adapter->SetUp(this, _adapters[iter->first].nukeData)) {
+        const AdapterInfo* info = _GetInfo(iter->first);
+        auto adapter = info->adapter;
+        const VtValue nukeData = info->nukeData;
+        if (adapter->SetUp(this, nukeData)) {
             iter->second->adapter = adapter;
+            // A fulfilled adapter counts as requested, so that it outlives the
+            // next RemoveUnusedAdapters along with its promise.
+            _Touch(iter->second->handle);
             iter = _unfulfilledPromises.erase(iter);
         }
         else {
@@ -200,18 +216,30 @@ unsigned int HdNukeAdapterManager::TryFulfillPromises()
 
 HdNukeAdapterPtr HdNukeAdapterManager::GetAdapter(const SdfPath& path) const
 {
-    auto iter = _adapters.find(path);
-    if (iter != _adapters.end()) {
-        return iter->second.adapter;
+    return GetAdapter(GetHandle(path));
+}
+
+HdNukeAdapterPtr HdNukeAdapterManager::GetAdapter(AdapterHandle handle) const
+{
+    if (const AdapterInfo* info = _adapters.Get(handle)) {
+        return info->adapter;
     }
     return nullptr;
 }
 
+HdNukeAdapterManager::AdapterHandle HdNukeAdapterManager::GetHandle(const SdfPath& path) const
+{
+    auto iter = _handles.find(path);
+    if (iter != _handles.end()) {
+        return iter->second;
+    }
+    return {};
+}
+
 const TfToken& HdNukeAdapterManager::GetPrimType(const SdfPath& path)
 {
-    auto iter = _adapters.find(path);
-    if (iter != _adapters.end()) {
-        return iter->second.primType;
+    if (const AdapterInfo* info = _GetInfo(path)) {
+        return info->primType;
     }
     static const TfToken &sEmpty{};
     return sEmpty;
@@ -221,23 +249,39 @@ void HdNukeAdapterManager::Remove(const SdfPath& path)
 {
     _unfulfilledPromises.erase(path);
 
-    auto it = _adapters.find(path);
-    if (it != _adapters.end()) {
-        AdapterInfo info = it->second;
-        info.adapter->TearDown(this);
-        _adaptersByPrimType[info.primType].erase(path);
-        _adapters.erase(it);
+    const AdapterHandle handle = GetHandle(path);
+    if (const AdapterInfo* info = _adapters.Get(handle)) {
+        _Unlink(handle);
+        const HdNukeAdapterPtr adapter = info->adapter;
+        const TfToken primType = info->primType;
+        adapter->TearDown(this);
+        _adaptersByPrimType[primType].erase(path);
+        // Tearing down may have changed the adapters, so the handle may no
+        // longer find anything.
+        _Unlink(handle);
+        if (_adapters.Erase(handle)) {
+            _handles.erase(path);
+        }
     }
 }
 
 void HdNukeAdapterManager::Clear()
 {
-    for (const auto& adapter : _adapters) {
-        adapter.second.adapter->TearDown(this);
+    // Tearing an adapter down may remove others, which moves the rest.
+    std::vector<HdNukeAdapterPtr> adapters;
+    adapters.reserve(_adapters.GetSize());
+    for (const AdapterInfo& info : _adapters) {
+        adapters.push_back(info.adapter);
     }
-    _adapters.clear();
+    for (const auto& adapter : adapters) {
+        adapter->TearDown(this);
+    }
+    _adapters.Clear();
+    _handles.clear();
     _adaptersByPrimType.clear();
     _unfulfilledPromises.clear();
+    _oldest = {};
+    _newest = {};
 }
 
 const SdfPathUnorderedSet& HdNukeAdapterManager::GetPathsForPrimType(const TfToken& type)
@@ -248,9 +292,9 @@ const SdfPathUnorderedSet& HdNukeAdapterManager::GetPathsForPrimType(const TfTok
 SdfPathUnorderedSet HdNukeAdapterManager::GetPathsForSubTree(const SdfPath& path)
 {
     SdfPathUnorderedSet paths;
-    for (const auto& adapter : _adapters) {
-        if (adapter.first.HasPrefix(path)) {
-            paths.insert(adapter.first);
+    for (const AdapterInfo& info : _adapters) {
+        if (info.path.HasPrefix(path)) {
+            paths.insert(info.path);
         }
     }
     return paths;
@@ -269,34 +313,106 @@ void HdNukeAdapterManager::SetUsed(bool used, const TfToken& primType)
 {
     const auto& primPaths = GetPathsForPrimType(primType);
     for (const auto& path : primPaths) {
-        GetAdapter(path)->SetUsed(used);
+        const AdapterHandle handle = GetHandle(path);
+        if (!_adapters.Contains(handle)) {
+            continue;
+        }
+        if (used) {
+            _Touch(handle);
+        }
+        else {
+            _Untouch(handle);
+        }
     }
 }
 
 void HdNukeAdapterManager::SetAllUnused()
 {
-    for (const auto& adapter : _adapters) {
-        adapter.second.adapter->SetUsed(false);
+    // The adapters requested in this generation are the ones at the end of
+    // the list.
+    while (const AdapterInfo* newest = _adapters.Get(_newest)) {
+        if (newest->generation != _generation) {
+            break;
+        }
+        _Untouch(_newest);
     }
 }
 
-const SdfPathUnorderedSet& HdNukeAdapterManager::GetRequestedAdapters() const
+SdfPathUnorderedSet HdNukeAdapterManager::GetRequestedAdapters() const
 {
-    return _requestedAdapters;
+    SdfPathUnorderedSet requested;
+    for (const AdapterInfo* info = _adapters.Get(_newest);
+         info != nullptr && info->generation == _generation;
+         info = _adapters.Get(info->older)) {
+        requested.insert(info->path);
+    }
+    return requested;
 }
 
 void HdNukeAdapterManager::RemoveUnusedAdapters()
 {
-    SdfPathUnorderedSet toRemove;
-    for (auto& adapter : _adapters) {
-        if (_requestedAdapters.find(adapter.first) == _requestedAdapters.end()) {
-            toRemove.insert(adapter.first);
+    // Tearing an adapter down may request or remove others, so the front of
+    // the list is looked at again after each removal.
+    while (const AdapterInfo* oldest = _adapters.Get(_oldest)) {
+        if (oldest->generation == _generation) {
+            break;
         }
-    }
-    for (const auto& path : toRemove) {
+        const SdfPath path = oldest->path;
         Remove(path);
     }
-    _requestedAdapters.clear();
+    _generation++;
+}
+
+HdNukeAdapterManager::AdapterInfo* HdNukeAdapterManager::_GetInfo(const SdfPath& path)
+{
+    return _adapters.Get(GetHandle(path));
+}
+
+void HdNukeAdapterManager::_Touch(AdapterHandle handle)
+{
+    _Unlink(handle);
+    _adapters.Get(handle)->generation = _generation;
+    _Link(handle, true);
+}
+
+void HdNukeAdapterManager::_Untouch(AdapterHandle handle)
+{
+    _Unlink(handle);
+    _adapters.Get(handle)->generation = 0;
+    _Link(handle, false);
+}
+
+void HdNukeAdapterManager::_Link(AdapterHandle handle, bool newest)
+{
+    AdapterInfo& info = *_adapters.Get(handle);
+    if (newest) {
+        info.older = _newest;
+        info.newer = {};
+        AdapterInfo* newestInfo = _adapters.Get(_newest);
+        (newestInfo != nullptr ? newestInfo->newer : _oldest) = handle;
+        _newest = handle;
+    }
+    else {
+        info.older = {};
+        info.newer = _oldest;
+        AdapterInfo* oldestInfo = _adapters.Get(_oldest);
+        (oldestInfo != nullptr ? oldestInfo->older : _newest) = handle;
+        _oldest = handle;
+    }
+}
+
+void HdNukeAdapterManager::_Unlink(AdapterHandle handle)
+{
+    AdapterInfo* info = _adapters.Get(handle);
+    if (info == nullptr || (!info->older.IsValid() && _oldest != handle)) {
+        return;
+    }
+    AdapterInfo* older = _adapters.Get(info->older);
+    AdapterInfo* newer = _adapters.Get(info->newer);
+    (older != nullptr ? older->newer : _oldest) = info->newer;
+    (newer != nullptr ? newer->older : _newest) = info->older;
+    info->older = {};
+    info->newer = {};
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -16,6 +16,7 @@
 #ifndef HDNUKE_ADAPTERMANAGER_H
 #define HDNUKE_ADAPTERMANAGER_H
 
+#include "slotMap.h"
 #include "types.h"
 
 #include <pxr/pxr.h>
@@ -24,6 +25,7 @@
 #include <pxr/base/tf/staticTokens.h>
 #include <pxr/usd/sdf/path.h>
 
+#include <cstdint>
 #include <memory>
 
 namespace DD
@@ -54,7 +56,11 @@ struct HydraMaterialContext;
   (Instancer)                             \
   (Environment)                           \
   (ParticleSprite)                        \
-  (InstancedGeo)
+  (InstancedGeo)                          \
+  (DuplicateGeo)                          \
+  (MeshChunk)                             \
+  (GeoBatch)                              \
+  (CardInstances)
 
 TF_DECLARE_PUBLIC_TOKENS(HdNukeAdapterManagerPrimTypes, HD_API, HDNUKEADAPTERMANAGER_PRIM_TYPES);
 
@@ -85,21 +91,38 @@ TF_DECLARE_PUBLIC_TOKENS(HdNukeAdapterManagerPrimTypes, HD_API, HDNUKEADAPTERMAN
 /// Automatically removing unused adapters is done by calling
 /// HdNukeAdapterManager::RemoveUnusedAdapters which checks for adapters that
 /// were not requested after the last time this method was called.
+///
+/// Requests are counted in generations, which RemoveUnusedAdapters starts
+/// anew. Each request, and each promise fulfilled, stamps the adapter with
+/// the current generation and moves it to the end of a list of the adapters
+/// ordered by the generation they were last requested in, so the unused adapters are
+/// the ones at the front of the list and are found without looking at the
+/// others.
+///
+/// The adapters are kept together in an HdNukeSlotMap, with an index from
+/// paths to their handles. Clients that look an adapter up often can keep its
+/// handle, which AdapterPromise::handle holds, and look it up with
+/// GetAdapter(AdapterHandle) without hashing its path.
 class HdNukeAdapterManager
 {
 public:
+    using AdapterHandle = HdNukeSlotHandle;
+
     /// Provides a placeholder for a HdNukeAdapter that might not be ready at
     /// the time HdNukeAdapterManager::Request returns
     /// A promise is considered unfulfilled if AdapterPromise::adapter is nullptr.
     struct AdapterPromise
     {
-        AdapterPromise(const SdfPath& adapterPath, const HdNukeAdapterPtr& adapterPtr)
+        AdapterPromise(const SdfPath& adapterPath, const HdNukeAdapterPtr& adapterPtr,
+                       AdapterHandle adapterHandle = {})
           : path{adapterPath}
           , adapter{adapterPtr}
+          , handle{adapterHandle}
         {
         }
         SdfPath path;               ///< Path pointing to the adapter. This is always filled.
         HdNukeAdapterPtr adapter;   ///< Points to the adapter if the promise has been fulfilled.
+        AdapterHandle handle;       ///< Handle to the adapter, fulfilled or not.
     };
     using AdapterPromisePtr = std::shared_ptr<AdapterPromise>;
 
@@ -156,6 +179,11 @@ public:
 
     /// Returns the adapter at \p path.
     HdNukeAdapterPtr GetAdapter(const SdfPath& path) const;
+    /// Returns the adapter \p handle refers to, or nullptr if it was removed.
+    HdNukeAdapterPtr GetAdapter(AdapterHandle handle) const;
+    /// Returns the handle to the adapter at \p path, or an invalid handle if
+    /// there is none.
+    AdapterHandle GetHandle(const SdfPath& path) const;
     /// Returns the prim type associated with the adapter at \p path.
     const TfToken& GetPrimType(const SdfPath& path);
 
@@ -174,12 +202,14 @@ public:
     /// Sets whether all adapters of \p primType are used or not.
     void SetUsed(bool used, const TfToken& primType);
 
-    /// Sets all adapters as unused.
+    /// Sets all adapters requested since the last call to
+    /// HdNukeAdapterManager::RemoveUnusedAdapters as unused.
     void SetAllUnused();
 
     /// Returns the path to all adapters that have been requested since the
-    /// last call to HdNukeAdapterManager::RemoveUnusedAdapters.
-    const SdfPathUnorderedSet& GetRequestedAdapters() const;
+    /// last call to HdNukeAdapterManager::RemoveUnusedAdapters or
+    /// HdNukeAdapterManager::SetAllUnused.
+    SdfPathUnorderedSet GetRequestedAdapters() const;
 
     /// Removes all unused adapters.
     void RemoveUnusedAdapters();
@@ -193,13 +223,37 @@ private:
         TfToken primType;
         VtValue nukeData;
         SdfPathUnorderedSet dependencies;
+
+        SdfPath path;
+
+        // The generation the adapter was last requested in, and its
+        // neighbours in the list of adapters by that generation.
+        uint64_t generation = 0;
+        AdapterHandle older;
+        AdapterHandle newer;
     };
 
-    SdfPathMap<AdapterInfo> _adapters;
+    AdapterInfo* _GetInfo(const SdfPath& path);
+
+    // Stamps the adapter with the current generation and moves it to the end
+    // of the list.
+    void _Touch(AdapterHandle handle);
+    // Marks the adapter unused and moves it to the front of the list.
+    void _Untouch(AdapterHandle handle);
+    void _Link(AdapterHandle handle, bool newest);
+    void _Unlink(AdapterHandle handle);
+
+    HdNukeSlotMap<AdapterInfo> _adapters;
+    SdfPathMap<AdapterHandle> _handles;
     TfTokenMap<SdfPathUnorderedSet> _adaptersByPrimType;
 
     SdfPathMap<AdapterPromisePtr> _unfulfilledPromises;
-    SdfPathUnorderedSet _requestedAdapters;
+
+    // The current generation, and the ends of the list of adapters ordered
+    // by the generation they were last requested in.
+    uint64_t _generation = 1;
+    AdapterHandle _oldest;
+    AdapterHandle _newest;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
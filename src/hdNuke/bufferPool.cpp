@@ -0,0 +1,182 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "bufferPool.h"
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec4f.h>
+#include <pxr/base/vt/array.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    template <typename T>
+    bool CopyArray(const VtValue& value, VtValue* copy)
+    {
+        if (!value.IsHolding<VtArray<T>>()) {
+            return false;
+        }
+        const VtArray<T>& array = value.UncheckedGet<VtArray<T>>();
+        VtArray<T> owned;
+        owned.assign(array.cdata(), array.cdata() + array.size());
+        *copy = VtValue::Take(owned);
+        return true;
+    }
+
+    // Copies the arrays of the element types zero-copy attributes are read
+    // as into storage of their own. Other values are returned as they are.
+    VtValue CopyOwned(const VtValue& value)
+    {
+        VtValue copy;
+        if (CopyArray<float>(value, &copy) || CopyArray<int>(value, &copy)
+                || CopyArray<GfVec2f>(value, &copy)
+                || CopyArray<GfVec3f>(value, &copy)
+                || CopyArray<GfVec4f>(value, &copy)) {
+            return copy;
+        }
+        return value;
+    }
+}
+
+
+HdNukeBufferPool::Reference&
+HdNukeBufferPool::Reference::operator=(Reference&& other)
+{
+    if (this != &other) {
+        Reset();
+        _pool = other._pool;
+        _entry = other._entry;
+        other._pool = nullptr;
+        other._entry = nullptr;
+    }
+    return *this;
+}
+
+const VtValue&
+HdNukeBufferPool::Reference::Get() const
+{
+    static const VtValue sEmpty;
+    // The value of an entry is never modified once it's in the pool, so it
+    // can be read without holding the lock.
+    return _entry != nullptr ? _entry->value : sEmpty;
+}
+
+void
+HdNukeBufferPool::Reference::Reset()
+{
+    if (_entry != nullptr) {
+        _pool->_Release(_entry);
+        _pool = nullptr;
+        _entry = nullptr;
+    }
+}
+
+HdNukeBufferPool&
+HdNukeBufferPool::GetInstance()
+{
+    static HdNukeBufferPool sPool;
+    return sPool;
+}
+
+HdNukeBufferPool::Reference
+HdNukeBufferPool::Share(const HdNukeContentHash& hash, VtValue&& value)
+{
+    if (value.IsEmpty()) {
+        return Reference();
+    }
+
+    _Key key{hash, std::type_index(value.GetTypeid())};
+
+    Reference pooled;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto result = _entries.emplace(key, _Entry());
+        _Entry& entry = result.first->second;
+        entry.useCount++;
+        if (result.second) {
+            entry.value = std::move(value);
+            entry.key = &result.first->first;
+            return Reference(this, &entry);
+        }
+        pooled = Reference(this, &entry);
+    }
+
+    return _Verify(std::move(pooled), value);
+}
+
+HdNukeBufferPool::Reference
+HdNukeBufferPool::ShareCopy(const HdNukeContentHash& hash, const VtValue& value)
+{
+    if (value.IsEmpty()) {
+        return Reference();
+    }
+
+    Reference pooled;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(_Key{hash, std::type_index(value.GetTypeid())});
+        if (it != _entries.end()) {
+            it->second.useCount++;
+            pooled = Reference(this, &it->second);
+        }
+    }
+    if (pooled) {
+        return _Verify(std::move(pooled), value);
+    }
+
+    // Copy outside of the lock. If another thread pools the same value in
+    // the meantime, Share hands out that one instead.
+    return Share(hash, CopyOwned(value));
+}
+
+size_t
+HdNukeBufferPool::GetEntryCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+HdNukeBufferPool::Reference
+HdNukeBufferPool::_Verify(Reference&& pooled, const VtValue& value)
+{
+    // The pooled value isn't modified while it is referenced, so it can be
+    // compared without holding the lock. Arrays sharing storage compare equal
+    // without looking at their elements.
+    if (pooled.Get() == value) {
+        return std::move(pooled);
+    }
+    return Reference();
+}
+
+void
+HdNukeBufferPool::_Release(_Entry* entry)
+{
+    // Let go of the value outside of the lock, since freeing a large array
+    // takes a while.
+    VtValue released;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--entry->useCount > 0) {
+            return;
+        }
+        released.Swap(entry->value);
+        _entries.erase(*entry->key);
+    }
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,164 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_BUFFERPOOL_H
+#define HDNUKE_BUFFERPOOL_H
+
+#include <pxr/pxr.h>
+
+#include <pxr/base/vt/value.h>
+
+#include "contentHash.h"
+
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A process-wide pool of converted geometry data, keyed by content.
+///
+/// Adapters hand the arrays and topologies they build to the pool along with
+/// a hash of the data they were built from. If a value with the same hash is
+/// already pooled, it is compared with the new one and returned instead when
+/// they are equal, so adapters with identical geometry
+/// (duplicated cards, copies of the same ReadGeo, ...) all share the same
+/// VtArray storage. Render delegates that track buffers by identity can then
+/// skip uploading the same data again.
+///
+/// Values stay in the pool for as long as a Reference to them exists.
+class HdNukeBufferPool
+{
+    struct _Entry;
+
+public:
+    /// Keeps a pooled value alive. Releasing the last reference to a value
+    /// removes it from the pool.
+    class Reference
+    {
+    public:
+        Reference() = default;
+        ~Reference() { Reset(); }
+
+        Reference(Reference&& other)
+            : _pool(other._pool)
+            , _entry(other._entry)
+        {
+            other._pool = nullptr;
+            other._entry = nullptr;
+        }
+
+        Reference& operator=(Reference&& other);
+
+        Reference(const Reference&) = delete;
+        Reference& operator=(const Reference&) = delete;
+
+        /// Returns the pooled value, or an empty value if this doesn't
+        /// reference anything.
+        const VtValue& Get() const;
+
+        /// Releases the referenced value.
+        void Reset();
+
+        explicit operator bool() const { return _entry != nullptr; }
+
+    private:
+        friend class HdNukeBufferPool;
+
+        Reference(HdNukeBufferPool* pool, _Entry* entry)
+            : _pool(pool)
+            , _entry(entry)
+        {
+        }
+
+        HdNukeBufferPool* _pool = nullptr;
+        _Entry* _entry = nullptr;
+    };
+
+    HdNukeBufferPool() = default;
+    HdNukeBufferPool(const HdNukeBufferPool&) = delete;
+    HdNukeBufferPool& operator=(const HdNukeBufferPool&) = delete;
+
+    /// Returns the pool shared by all adapters.
+    static HdNukeBufferPool& GetInstance();
+
+    /// Returns a reference to the pooled value for \p hash with the same type
+    /// as \p value, adding \p value to the pool if there is none yet.
+    ///
+    /// Returns an empty reference, leaving \p value as it was, if the pooled
+    /// value differs from \p value, which means their hashes collided. The
+    /// caller then keeps \p value to itself.
+    ///
+    /// \p hash must identify the contents of \p value, either by hashing the
+    /// value itself or the data it was deterministically converted from.
+    ///
+    /// Pooled values must never change, so \p value must own its data. Use
+    /// ShareCopy for arrays that point at memory the pool doesn't control.
+    Reference Share(const HdNukeContentHash& hash, VtValue&& value);
+
+    /// Same as Share, but adds a copy of \p value that owns its data to the
+    /// pool. This is for arrays made with HdNukeMakeForeignArray, whose Nuke
+    /// memory is rewritten in place once the geometry changes. The value is
+    /// only copied if there is nothing pooled for \p hash yet.
+    Reference ShareCopy(const HdNukeContentHash& hash, const VtValue& value);
+
+    /// Returns the number of distinct values in the pool.
+    size_t GetEntryCount() const;
+
+private:
+    struct _Key
+    {
+        HdNukeContentHash hash;
+        std::type_index type;
+
+        bool operator==(const _Key& other) const
+        {
+            return hash == other.hash && type == other.type;
+        }
+    };
+
+    struct _KeyHasher
+    {
+        size_t operator()(const _Key& key) const
+        {
+            return HdNukeContentHash::Hasher()(key.hash) ^ key.type.hash_code();
+        }
+    };
+
+    struct _Entry
+    {
+        VtValue value;
+        size_t useCount = 0;
+        // The key this entry is stored under in the map.
+        const _Key* key = nullptr;
+    };
+
+    // Returns pooled if its value is equal to value, or an empty reference
+    // otherwise.
+    Reference _Verify(Reference&& pooled, const VtValue& value);
+
+    void _Release(_Entry* entry);
+
+    // Entries are never moved by the map, so references can point at them.
+    using _EntryMap = std::unordered_map<_Key, _Entry, _KeyHasher>;
+    _EntryMap _entries;
+    mutable std::mutex _mutex;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_BUFFERPOOL_H
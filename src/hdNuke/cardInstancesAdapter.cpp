@@ -0,0 +1,243 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "cardInstancesAdapter.h"
+
+#include "adapterFactory.h"
+#include "adapterManager.h"
+#include "cardMatching.h"
+#include "meshTopology.h"
+#include "sceneDelegate.h"
+#include "tokens.h"
+#include "utils.h"
+
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/imaging/pxOsd/tokens.h>
+#include <pxr/imaging/hd/tokens.h>
+
+#include <DDImage/GeoInfo.h>
+
+#include <string>
+
+using namespace DD::Image;
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace
+{
+    // The number of floats in each element of a uv or normal attribute, or
+    // zero for types that can't hold one.
+    size_t FloatCount(AttribType type)
+    {
+        switch (type) {
+            case VECTOR2_ATTRIB:
+                return 2;
+            case VECTOR3_ATTRIB:
+            case NORMAL_ATTRIB:
+                return 3;
+            case VECTOR4_ATTRIB:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+}
+
+bool
+HdNukeCardInstancesAdapter::MatchCard(const GeoInfo& geo,
+                                      GfMatrix4d* cardTransform)
+{
+    const PointList* pointList = geo.point_list();
+    if (pointList == nullptr || GetRprimType(geo) != HdPrimTypeTokens->mesh) {
+        return false;
+    }
+
+    HdNukeCardAttribute uvs;
+    HdNukeCardAttribute normals;
+    for (const auto& attribCtx : geo.get_cache_pointer()->attributes) {
+        if (attribCtx.empty() || attribCtx.group == Group_Object) {
+            continue;
+        }
+        const std::string name(attribCtx.name);
+        HdNukeCardAttribute* attribute = nullptr;
+        if (name == HdNukeTokens->uv.GetString()) {
+            attribute = &uvs;
+        }
+        else if (name == HdNukeTokens->N.GetString()) {
+            attribute = &normals;
+        }
+        const size_t stride = FloatCount(attribCtx.type);
+        if (attribute == nullptr || stride == 0
+                || (attribCtx.group != Group_Points
+                    && attribCtx.group != Group_Vertices)) {
+            return false;
+        }
+        attribute->data = static_cast<const float*>(attribCtx.attribute->array());
+        attribute->stride = stride;
+        attribute->size = attribCtx.attribute->size();
+        attribute->perFaceVertex = attribCtx.group == Group_Vertices;
+    }
+
+    VtIntArray faceVertexCounts;
+    VtIntArray faceVertexIndices;
+    HdNukeMeshTopologyBuilder(geo).Build(faceVertexCounts, faceVertexIndices);
+
+    HdNukeCardFit fit;
+    if (!HdNukeMatchCard(reinterpret_cast<const float*>(pointList->data()),
+                         pointList->size(),
+                         faceVertexCounts.cdata(), faceVertexCounts.size(),
+                         faceVertexIndices.cdata(), faceVertexIndices.size(),
+                         uvs, normals, &fit)) {
+        return false;
+    }
+    cardTransform->SetScale(GfVec3d(fit.size[0], fit.size[1], 1.0));
+    cardTransform->SetTranslateOnly(
+        GfVec3d(fit.center[0], fit.center[1], fit.center[2]));
+    return true;
+}
+
+bool HdNukeCardInstancesAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!TF_VERIFY(nukeData.IsHolding<HdNukeCardSet>(),
+          "HdNukeCardInstancesAdapter expects a HdNukeCardSet")) {
+        return false;
+    }
+    const auto& cards = nukeData.UncheckedGet<HdNukeCardSet>();
+    if (cards.geoInfos.empty()) {
+        return false;
+    }
+
+    auto sceneDelegate = manager->GetSceneDelegate();
+    auto& renderIndex = sceneDelegate->GetRenderIndex();
+
+    _geoInfo = cards.geoInfos.front();
+    _MakeUnitCard();
+    _SetMaterial(manager);
+
+    SdfPath instancerPath = GetPath().AppendChild(HdInstancerTokens->instancer);
+    manager->Request(HdNukeAdapterManagerPrimTypes->Instancer, instancerPath,
+                     VtValue(_GetInstanceData(cards)));
+    renderIndex.InsertRprim(GetPrimType(), sceneDelegate, GetPath(), instancerPath);
+
+    // Shadow casting is part of what cards are grouped by, so it can't
+    // change for the lifetime of the adapter.
+    if (!_geoInfo->renderState.castShadow) {
+        auto excludePaths = GetSharedState()->_shadowCollection.GetExcludePaths();
+        excludePaths.push_back(GetPath());
+        GetSharedState()->_shadowCollection.SetExcludePaths(excludePaths);
+        renderIndex.GetChangeTracker().AddCollection(HdNukeTokens->shadowCollection);
+    }
+    return true;
+}
+
+bool HdNukeCardInstancesAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!TF_VERIFY(nukeData.IsHolding<HdNukeCardSet>(),
+          "HdNukeCardInstancesAdapter expects a HdNukeCardSet")) {
+        return false;
+    }
+    const auto& cards = nukeData.UncheckedGet<HdNukeCardSet>();
+    if (cards.geoInfos.empty()) {
+        return false;
+    }
+
+    // The unit card never changes, only the instances and the material.
+    _geoInfo = cards.geoInfos.front();
+
+    SdfPath instancerPath = GetPath().AppendChild(HdInstancerTokens->instancer);
+    manager->Request(HdNukeAdapterManagerPrimTypes->Instancer, instancerPath,
+                     VtValue(_GetInstanceData(cards)));
+
+    _SetMaterial(manager);
+    auto& changeTracker =
+        manager->GetSceneDelegate()->GetRenderIndex().GetChangeTracker();
+    changeTracker.MarkRprimDirty(GetPath(), HdChangeTracker::DirtyMaterialId);
+    return true;
+}
+
+const TfToken& HdNukeCardInstancesAdapter::GetPrimType() const
+{
+    return HdPrimTypeTokens->mesh;
+}
+
+void
+HdNukeCardInstancesAdapter::_MakeUnitCard()
+{
+    // Wound to face +Z like Nuke's cards, rather than the particle sprite.
+    _points = VtVec3fArray{
+        GfVec3f(-0.5f, -0.5f, 0.0f), GfVec3f(0.5f, -0.5f, 0.0f),
+        GfVec3f(0.5f, 0.5f, 0.0f), GfVec3f(-0.5f, 0.5f, 0.0f)
+    };
+    _topology = HdMeshTopology(PxOsdOpenSubdivTokens->none,
+                               UsdGeomTokens->rightHanded,
+                               VtIntArray{4}, VtIntArray{0, 1, 2, 3});
+    _displayStyle = HdDisplayStyle();
+
+    _extent.SetMin(GfVec3d(-0.5, -0.5, 0.0));
+    _extent.SetMax(GfVec3d(0.5, 0.5, 0.0));
+    _transform.SetIdentity();
+    _reprSelector = GetReprSelectorForGeo(*_geoInfo);
+    _wireframeColor = GetWireframeColor(*_geoInfo);
+    _displayColor = GetSharedState()->defaultDisplayColor;
+
+    _primvars.Clear();
+    _primvars.Add(HdNukeTokens->overrideWireframeColor, HdInterpolationConstant,
+                  HdNukeTokens->overrideWireframeColor);
+    _primvars.Add(HdTokens->points, HdInterpolationVertex,
+                  HdPrimvarRoleTokens->point);
+    _primvars.Add(HdNukeTokens->st, HdInterpolationVertex,
+                  HdPrimvarRoleTokens->textureCoordinate,
+                  VtValue(VtVec2fArray{
+                      GfVec2f(0.0f, 0.0f), GfVec2f(1.0f, 0.0f),
+                      GfVec2f(1.0f, 1.0f), GfVec2f(0.0f, 1.0f)
+                  }));
+}
+
+HdNukeInstanceData
+HdNukeCardInstancesAdapter::_GetInstanceData(const HdNukeCardSet& cards) const
+{
+    HdNukeInstanceData instanceData;
+    instanceData.transforms.resize(cards.geoInfos.size());
+    instanceData.colors.resize(cards.geoInfos.size());
+    for (size_t i = 0; i < cards.geoInfos.size(); i++) {
+        const GeoInfo& geo = *cards.geoInfos[i];
+        instanceData.transforms[i] =
+            cards.cardTransforms[i] * DDToGfMatrix4d(geo.matrix);
+
+        const AttribContext* cf =
+            geo.get_typed_group_attribcontext(Group_Object, "Cf", VECTOR4_ATTRIB);
+        if (cf != nullptr && !cf->empty() && cf->attribute) {
+            const Vector4& color = static_cast<const Vector4*>(cf->attribute->array())[0];
+            instanceData.colors[i] = GfVec3f(color.x, color.y, color.z);
+        }
+        else {
+            instanceData.colors[i] = GetSharedState()->defaultDisplayColor;
+        }
+    }
+    return instanceData;
+}
+
+class CardInstancesAdapterCreator : public HdNukeAdapterFactory::AdapterCreator {
+public:
+    HdNukeAdapterPtr Create(AdapterSharedState *sharedState) override
+    {
+        return std::make_shared<HdNukeCardInstancesAdapter>(sharedState);
+    }
+};
+
+static const AdapterRegister<CardInstancesAdapterCreator> sRegisterCardInstancesCreator(HdNukeAdapterManagerPrimTypes->CardInstances);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
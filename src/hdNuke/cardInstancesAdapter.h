@@ -0,0 +1,79 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_CARDINSTANCESADAPTER_H
+#define HDNUKE_CARDINSTANCESADAPTER_H
+
+#include <pxr/pxr.h>
+
+#include <pxr/base/gf/matrix4d.h>
+
+#include "geoAdapter.h"
+#include "instancerAdapter.h"
+#include "types.h"
+
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A set of cards drawn by one HdNukeCardInstancesAdapter.
+struct HdNukeCardSet
+{
+    GeoInfoVector geoInfos;
+    /// For each card, the transform from the unit card to its local space,
+    /// as given by HdNukeCardInstancesAdapter::MatchCard.
+    std::vector<GfMatrix4d> cardTransforms;
+
+    bool operator==(const HdNukeCardSet& other) const
+    {
+        return geoInfos == other.geoInfos
+               && cardTransforms == other.cardTransforms;
+    }
+};
+
+/// Shows a set of cards as instances of a single unit card.
+///
+/// Set up and updated with a HdNukeCardSet, whose cards should all use the
+/// same material and display mode. The unit card takes both from the first
+/// card, and an instancer carries the transform and object colour of each.
+class HdNukeCardInstancesAdapter : public HdNukeGeoAdapter
+{
+public:
+    HdNukeCardInstancesAdapter(AdapterSharedState* statePtr)
+        : HdNukeGeoAdapter(statePtr) { }
+    ~HdNukeCardInstancesAdapter() override { }
+
+    /// Returns whether \p geo is a card that looks the same as an instance
+    /// of the unit card, setting \p cardTransform to the transform from the
+    /// unit card to the local space of \p geo if it is. Cards with
+    /// attributes besides texture coordinates, normals and object ones
+    /// aren't matched, as those would be lost.
+    static bool MatchCard(const DD::Image::GeoInfo& geo,
+                          GfMatrix4d* cardTransform);
+
+    bool SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    bool Update(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    const TfToken& GetPrimType() const override;
+
+private:
+    void _MakeUnitCard();
+    HdNukeInstanceData _GetInstanceData(const HdNukeCardSet& cards) const;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_CARDINSTANCESADAPTER_H
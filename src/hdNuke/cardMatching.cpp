@@ -0,0 +1,161 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "cardMatching.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    // How far points may be off the plane, relative to the size of the card.
+    constexpr float kFlatness = 1e-4f;
+
+    // How far the faces may be from covering the card, relative to its area.
+    constexpr double kCoverage = 1e-4;
+
+    // How far texture coordinates and normals may be from the unit card's.
+    constexpr float kAttributeTolerance = 1e-3f;
+
+    inline const float* Element(const HdNukeCardAttribute& attribute, size_t index)
+    {
+        return attribute.data + index * attribute.stride;
+    }
+
+    // Checks an attribute has an element for each point or face vertex,
+    // calling check with each element and the point it belongs to.
+    template <typename CheckFn>
+    bool CheckAttribute(const HdNukeCardAttribute& attribute,
+                        size_t numPoints, const int* faceVertexIndices,
+                        size_t numFaceVertices, CheckFn check)
+    {
+        if (attribute.data == nullptr) {
+            return true;
+        }
+        const size_t count = attribute.perFaceVertex ? numFaceVertices : numPoints;
+        if (attribute.size < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const size_t point = attribute.perFaceVertex
+                                 ? static_cast<size_t>(faceVertexIndices[i]) : i;
+            if (!check(Element(attribute, i), point)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool HdNukeMatchCard(const float* points, size_t numPoints,
+                     const int* faceVertexCounts, size_t numFaces,
+                     const int* faceVertexIndices, size_t numFaceVertices,
+                     const HdNukeCardAttribute& uvs,
+                     const HdNukeCardAttribute& normals,
+                     HdNukeCardFit* fit)
+{
+    if (numPoints < 3 || numFaces == 0) {
+        return false;
+    }
+
+    float min[3] = {points[0], points[1], points[2]};
+    float max[3] = {points[0], points[1], points[2]};
+    for (size_t i = 1; i < numPoints; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            min[axis] = std::min(min[axis], points[i * 3 + axis]);
+            max[axis] = std::max(max[axis], points[i * 3 + axis]);
+        }
+    }
+    const float width = max[0] - min[0];
+    const float height = max[1] - min[1];
+    if (!(width > 0.0f && height > 0.0f)
+            || max[2] - min[2] > kFlatness * std::max(width, height)) {
+        return false;
+    }
+
+    // Faces that all face +Z and add up to the area of the bounding
+    // rectangle cover it exactly, with nothing overlapping or missing.
+    const double rectangleArea = static_cast<double>(width) * height;
+    double area = 0.0;
+    size_t offset = 0;
+    for (size_t face = 0; face < numFaces; face++) {
+        const int count = faceVertexCounts[face];
+        if (count < 3 || offset + count > numFaceVertices) {
+            return false;
+        }
+        double faceArea = 0.0;
+        for (int j = 0; j < count; j++) {
+            const int a = faceVertexIndices[offset + j];
+            const int b = faceVertexIndices[offset + (j + 1) % count];
+            if (a < 0 || b < 0 || static_cast<size_t>(a) >= numPoints
+                    || static_cast<size_t>(b) >= numPoints) {
+                return false;
+            }
+            faceArea += static_cast<double>(points[a * 3]) * points[b * 3 + 1]
+                        - static_cast<double>(points[b * 3]) * points[a * 3 + 1];
+        }
+        faceArea *= 0.5;
+        if (faceArea < -kCoverage * rectangleArea) {
+            return false;
+        }
+        area += faceArea;
+        offset += count;
+    }
+    if (offset != numFaceVertices
+            || std::abs(area - rectangleArea) > kCoverage * rectangleArea) {
+        return false;
+    }
+
+    const bool uvsMatch = CheckAttribute(
+        uvs, numPoints, faceVertexIndices, numFaceVertices,
+        [&](const float* uv, size_t point) {
+            float u = uv[0];
+            float v = uv[1];
+            if (uvs.stride >= 4 && uv[3] != 0.0f) {
+                u /= uv[3];
+                v /= uv[3];
+            }
+            const float expectedU = (points[point * 3] - min[0]) / width;
+            const float expectedV = (points[point * 3 + 1] - min[1]) / height;
+            return std::abs(u - expectedU) <= kAttributeTolerance
+                   && std::abs(v - expectedV) <= kAttributeTolerance;
+        });
+    if (!uvsMatch) {
+        return false;
+    }
+
+    const bool normalsMatch = CheckAttribute(
+        normals, numPoints, faceVertexIndices, numFaceVertices,
+        [](const float* normal, size_t) {
+            return normal[2] > 0.0f
+                   && std::abs(normal[0]) <= kAttributeTolerance * normal[2]
+                   && std::abs(normal[1]) <= kAttributeTolerance * normal[2];
+        });
+    if (!normalsMatch) {
+        return false;
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        fit->center[axis] = 0.5f * (min[axis] + max[axis]);
+    }
+    fit->size[0] = width;
+    fit->size[1] = height;
+    return true;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
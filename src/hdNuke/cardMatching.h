@@ -0,0 +1,70 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_CARDMATCHING_H
+#define HDNUKE_CARDMATCHING_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A per point or per face vertex attribute of a mesh checked by
+/// HdNukeMatchCard.
+struct HdNukeCardAttribute
+{
+    const float* data = nullptr;
+    /// The number of floats from one element to the next. Elements of four
+    /// floats are taken to be homogeneous.
+    size_t stride = 0;
+    /// The number of elements.
+    size_t size = 0;
+    bool perFaceVertex = false;
+};
+
+/// Where the unit card sits in the local space of a mesh that matches it.
+///
+/// The unit card is a square from -0.5 to 0.5 in X and Y facing +Z, with
+/// texture coordinates running from 0 to 1 across it. Scaling it by
+/// \c size and moving it to \c center gives the mesh.
+struct HdNukeCardFit
+{
+    float center[3] = {0.0f, 0.0f, 0.0f};
+    float size[2] = {1.0f, 1.0f};
+};
+
+/// Returns whether a mesh is a card, a flat rectangle in its local XY plane
+/// facing +Z, as made by Nuke's Card node, filling \p fit in if it is.
+///
+/// The faces may subdivide the rectangle in any way, but have to cover it
+/// exactly once. If given, \p uvs have to map the rectangle onto the unit
+/// square the same way as the unit card does, and \p normals have to point
+/// along +Z.
+///
+/// Such a mesh looks the same as the unit card under the transform given by
+/// \p fit, so it can be drawn as an instance of it.
+bool HdNukeMatchCard(const float* points, size_t numPoints,
+                     const int* faceVertexCounts, size_t numFaces,
+                     const int* faceVertexIndices, size_t numFaceVertices,
+                     const HdNukeCardAttribute& uvs,
+                     const HdNukeCardAttribute& normals,
+                     HdNukeCardFit* fit);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_CARDMATCHING_H
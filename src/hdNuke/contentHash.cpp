@@ -0,0 +1,353 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "contentHash.h"
+#include "conversionKernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define HDNUKE_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #define HDNUKE_TARGET_AVX2
+  #else
+    #define HDNUKE_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+#endif
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+// The hash follows the layout of XXH3: the input is consumed in 64 byte
+// stripes by eight independent 64 bit accumulators, keyed with a secret that
+// slides along with the stripe so reordered data hashes differently, and the
+// accumulators are scrambled after every block of stripes.
+
+namespace {
+
+constexpr uint64_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint64_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint64_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+constexpr size_t kStripeSize = 64;
+constexpr size_t kSecretSize = 192;
+constexpr size_t kStripesPerBlock = (kSecretSize - kStripeSize) / 8;
+constexpr size_t kBlockSize = kStripeSize * kStripesPerBlock;
+
+inline uint64_t Read64(const unsigned char* p)
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline void Write64(unsigned char* p, uint64_t value)
+{
+    std::memcpy(p, &value, sizeof(value));
+}
+
+// Multiplies two 64 bit values and folds the 128 bit product to 64 bits.
+inline uint64_t MultiplyFold(uint64_t a, uint64_t b)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    const uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#elif defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    const uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    const uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    const uint64_t hi_hi = (a >> 32) * (b >> 32);
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return lower ^ upper;
+#endif
+}
+
+inline uint64_t Avalanche(uint64_t hash)
+{
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ULL;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// The default secret, filled with splitmix64 output.
+struct Secret
+{
+    unsigned char bytes[kSecretSize];
+
+    Secret()
+    {
+        uint64_t state = kPrime64_1;
+        for (size_t i = 0; i < kSecretSize; i += 8) {
+            state += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            Write64(bytes + i, z ^ (z >> 31));
+        }
+    }
+
+    Secret(const Secret& base, uint64_t seed)
+    {
+        for (size_t i = 0; i < kSecretSize; i += 16) {
+            Write64(bytes + i, Read64(base.bytes + i) + seed);
+            Write64(bytes + i + 8, Read64(base.bytes + i + 8) - seed);
+        }
+    }
+};
+
+const Secret& DefaultSecret()
+{
+    static const Secret sSecret;
+    return sSecret;
+}
+
+inline void AccumulateStripe(uint64_t* acc, const unsigned char* data,
+                             const unsigned char* secret)
+{
+    for (size_t i = 0; i < 8; i++) {
+        const uint64_t value = Read64(data + i * 8);
+        const uint64_t key = value ^ Read64(secret + i * 8);
+        acc[i ^ 1] += value;
+        acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+    }
+}
+
+// Accumulating the stripes is where nearly all of the time goes, so it has
+// SIMD versions of the same arithmetic. Scrambling only happens once a block
+// and stays scalar.
+
+void AccumulateScalar(uint64_t* acc, const unsigned char* data,
+                      const unsigned char* secret, size_t numStripes)
+{
+    for (size_t n = 0; n < numStripes; n++) {
+        AccumulateStripe(acc, data + n * kStripeSize, secret + n * 8);
+    }
+}
+
+#if HDNUKE_X86
+
+void AccumulateSSE(uint64_t* acc, const unsigned char* data,
+                   const unsigned char* secret, size_t numStripes)
+{
+    __m128i* accVec = reinterpret_cast<__m128i*>(acc);
+    __m128i lanes[4];
+    for (size_t i = 0; i < 4; i++) {
+        lanes[i] = _mm_loadu_si128(accVec + i);
+    }
+
+    for (size_t n = 0; n < numStripes; n++) {
+        const unsigned char* stripe = data + n * kStripeSize;
+        const unsigned char* key = secret + n * 8;
+        for (size_t i = 0; i < 4; i++) {
+            const __m128i value = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(stripe + i * 16));
+            const __m128i keyed = _mm_xor_si128(
+                value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i * 16)));
+            // Low times high 32 bits of each 64 bit lane.
+            const __m128i high = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            const __m128i product = _mm_mul_epu32(keyed, high);
+            // Each value is added to the other lane of its pair.
+            const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+        }
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        _mm_storeu_si128(accVec + i, lanes[i]);
+    }
+}
+
+HDNUKE_TARGET_AVX2
+void AccumulateAVX2(uint64_t* acc, const unsigned char* data,
+                    const unsigned char* secret, size_t numStripes)
+{
+    __m256i* accVec = reinterpret_cast<__m256i*>(acc);
+    __m256i lanes[2];
+    for (size_t i = 0; i < 2; i++) {
+        lanes[i] = _mm256_loadu_si256(accVec + i);
+    }
+
+    for (size_t n = 0; n < numStripes; n++) {
+        const unsigned char* stripe = data + n * kStripeSize;
+        const unsigned char* key = secret + n * 8;
+        for (size_t i = 0; i < 2; i++) {
+            const __m256i value = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(stripe + i * 32));
+            const __m256i keyed = _mm256_xor_si256(
+                value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i * 32)));
+            const __m256i high = _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            const __m256i product = _mm256_mul_epu32(keyed, high);
+            const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm256_add_epi64(lanes[i], _mm256_add_epi64(product, swapped));
+        }
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+        _mm256_storeu_si256(accVec + i, lanes[i]);
+    }
+}
+
+#endif  // HDNUKE_X86
+
+using AccumulateFn = void (*)(uint64_t*, const unsigned char*,
+                              const unsigned char*, size_t);
+
+AccumulateFn GetAccumulate(HdNukeSimdLevel level)
+{
+    switch (level) {
+#if HDNUKE_X86
+        case HdNukeSimdLevel::AVX2:
+            return AccumulateAVX2;
+        case HdNukeSimdLevel::SSE:
+            return AccumulateSSE;
+#endif
+        default:
+            return AccumulateScalar;
+    }
+}
+
+inline void Scramble(uint64_t* acc, const unsigned char* secret)
+{
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= Read64(secret + i * 8);
+        acc[i] = value * kPrime32_1;
+    }
+}
+
+inline uint64_t MergeAccumulators(const uint64_t* acc,
+                                  const unsigned char* secret, uint64_t start)
+{
+    uint64_t result = start;
+    for (size_t i = 0; i < 4; i++) {
+        result += MultiplyFold(acc[i * 2] ^ Read64(secret + i * 16),
+                               acc[i * 2 + 1] ^ Read64(secret + i * 16 + 8));
+    }
+    return Avalanche(result);
+}
+
+inline uint64_t Mix16(const unsigned char* data, const unsigned char* secret,
+                      uint64_t seed)
+{
+    return MultiplyFold(Read64(data) ^ (Read64(secret) + seed),
+                        Read64(data + 8) ^ (Read64(secret + 8) - seed));
+}
+
+// Inputs up to a stripe long are zero padded to a whole stripe and mixed in
+// 16 byte pieces. The length goes into the result so the padding can't be
+// confused with trailing zeros.
+HdNukeContentHash HashShort(const unsigned char* data, size_t size,
+                            uint64_t seed)
+{
+    unsigned char padded[kStripeSize] = {};
+    if (size > 0) {
+        std::memcpy(padded, data, size);
+    }
+
+    const unsigned char* secret = DefaultSecret().bytes;
+    uint64_t low = size * kPrime64_1;
+    uint64_t high = ~(size * kPrime64_2);
+    for (size_t i = 0; i < kStripeSize; i += 16) {
+        low += Mix16(padded + i, secret + i, seed);
+        high += Mix16(padded + i, secret + kSecretSize - kStripeSize + i, seed);
+    }
+
+    HdNukeContentHash hash;
+    hash.low = Avalanche(low);
+    hash.high = Avalanche(high ^ seed);
+    return hash;
+}
+
+HdNukeContentHash HashLong(const unsigned char* data, size_t size,
+                           uint64_t seed, AccumulateFn Accumulate)
+{
+    const Secret seeded(DefaultSecret(), seed);
+    const unsigned char* secret = seeded.bytes;
+
+    uint64_t acc[8] = {
+        kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3,
+        kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1
+    };
+
+    const size_t numBlocks = (size - 1) / kBlockSize;
+    for (size_t n = 0; n < numBlocks; n++) {
+        Accumulate(acc, data + n * kBlockSize, secret, kStripesPerBlock);
+        Scramble(acc, secret + kSecretSize - kStripeSize);
+    }
+
+    // The remaining whole stripes, then the last stripe, which may overlap
+    // the ones before it.
+    const size_t numStripes = ((size - 1) - numBlocks * kBlockSize) / kStripeSize;
+    Accumulate(acc, data + numBlocks * kBlockSize, secret, numStripes);
+    AccumulateStripe(acc, data + size - kStripeSize,
+                     secret + kSecretSize - kStripeSize - 7);
+
+    HdNukeContentHash hash;
+    hash.low = MergeAccumulators(acc, secret + 11, size * kPrime64_1);
+    hash.high = MergeAccumulators(acc, secret + kSecretSize - kStripeSize - 11,
+                                  ~(size * kPrime64_2));
+    return hash;
+}
+
+}  // namespace
+
+HdNukeContentHash
+HdNukeHashContent(const void* data, size_t size, uint64_t seed)
+{
+    static const AccumulateFn sAccumulate =
+        GetAccumulate(HdNukeConversionKernels::GetSupportedLevel());
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if (size <= kStripeSize) {
+        return HashShort(bytes, size, seed);
+    }
+    return HashLong(bytes, size, seed, sAccumulate);
+}
+
+HdNukeContentHash
+HdNukeHashContent(const void* data, size_t size, uint64_t seed,
+                  HdNukeSimdLevel level)
+{
+    if (level > HdNukeConversionKernels::GetSupportedLevel()) {
+        level = HdNukeSimdLevel::Scalar;
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if (size <= kStripeSize) {
+        return HashShort(bytes, size, seed);
+    }
+    return HashLong(bytes, size, seed, GetAccumulate(level));
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
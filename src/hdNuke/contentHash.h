@@ -0,0 +1,83 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_CONTENTHASH_H
+#define HDNUKE_CONTENTHASH_H
+
+#include <pxr/pxr.h>
+
+#include "conversionKernels.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A 128 bit hash of a block of memory.
+///
+/// Wide enough that two buffers with the same hash almost always have the
+/// same contents. The buffer pool still compares the contents of values with
+/// the same hash before sharing them.
+struct HdNukeContentHash
+{
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const HdNukeContentHash& other) const
+    {
+        return low == other.low && high == other.high;
+    }
+
+    bool operator!=(const HdNukeContentHash& other) const
+    {
+        return !(*this == other);
+    }
+
+    /// Hash functor for unordered containers keyed by content hash.
+    struct Hasher
+    {
+        size_t operator()(const HdNukeContentHash& hash) const
+        {
+            return static_cast<size_t>(hash.low);
+        }
+    };
+};
+
+/// Hashes \p size bytes at \p data. Different seeds give unrelated hashes,
+/// so hashes of several buffers can be chained by seeding each with the one
+/// before.
+HdNukeContentHash HdNukeHashContent(const void* data, size_t size,
+                                    uint64_t seed = 0);
+
+/// Same as above, but uses the implementation for \p level rather than the
+/// best one the CPU supports. All levels give the same hash.
+HdNukeContentHash HdNukeHashContent(const void* data, size_t size,
+                                    uint64_t seed, HdNukeSimdLevel level);
+
+/// Returns a hash of \p data seeded with \p previous.
+inline HdNukeContentHash
+HdNukeHashContent(const void* data, size_t size,
+                  const HdNukeContentHash& previous)
+{
+    HdNukeContentHash hash = HdNukeHashContent(data, size, previous.low);
+    hash.high ^= previous.high;
+    return hash;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_CONTENTHASH_H
@@ -0,0 +1,234 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "conversionKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define HDNUKE_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+    // MSVC doesn't need the instruction set enabled to use its intrinsics.
+    #define HDNUKE_TARGET_AVX2
+  #else
+    #define HDNUKE_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+#endif
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+
+// Scalar kernels, also used for the tails of the SIMD ones.
+
+void HomogeneousToVec2fScalar(const float* src, float* dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++, src += 4, dst += 2) {
+        const float w = src[3] != 0.0f ? src[3] : 1.0f;
+        dst[0] = src[0] / w;
+        dst[1] = src[1] / w;
+    }
+}
+
+void Vec4fToVec3fScalar(const float* src, float* dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++, src += 4, dst += 3) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+#if HDNUKE_X86
+
+// SSE kernels. The build already enables SSE for all targets.
+
+void HomogeneousToVec2fSSE(const float* src, float* dst, size_t count)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2, src += 8, dst += 4) {
+        const __m128 a = _mm_loadu_ps(src);
+        const __m128 b = _mm_loadu_ps(src + 4);
+
+        // Broadcast w, replacing zeros with ones so those are copied as is.
+        __m128 wa = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 wb = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128 maskA = _mm_cmpneq_ps(wa, zero);
+        const __m128 maskB = _mm_cmpneq_ps(wb, zero);
+        wa = _mm_or_ps(_mm_and_ps(maskA, wa), _mm_andnot_ps(maskA, one));
+        wb = _mm_or_ps(_mm_and_ps(maskB, wb), _mm_andnot_ps(maskB, one));
+
+        const __m128 ra = _mm_div_ps(a, wa);
+        const __m128 rb = _mm_div_ps(b, wb);
+        _mm_storeu_ps(dst, _mm_shuffle_ps(ra, rb, _MM_SHUFFLE(1, 0, 1, 0)));
+    }
+    HomogeneousToVec2fScalar(src, dst, count - i);
+}
+
+void Vec4fToVec3fSSE(const float* src, float* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, src += 16, dst += 12) {
+        const __m128 c0 = _mm_loadu_ps(src);
+        const __m128 c1 = _mm_loadu_ps(src + 4);
+        const __m128 c2 = _mm_loadu_ps(src + 8);
+        const __m128 c3 = _mm_loadu_ps(src + 12);
+
+        // r0 g0 b0 r1
+        const __m128 t0 = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(0, 0, 2, 2));
+        _mm_storeu_ps(dst, _mm_shuffle_ps(c0, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+        // g1 b1 r2 g2
+        _mm_storeu_ps(dst + 4, _mm_shuffle_ps(c1, c2, _MM_SHUFFLE(1, 0, 2, 1)));
+        // b2 r3 g3 b3
+        const __m128 t2 = _mm_shuffle_ps(c2, c3, _MM_SHUFFLE(0, 0, 2, 2));
+        _mm_storeu_ps(dst + 8, _mm_shuffle_ps(t2, c3, _MM_SHUFFLE(2, 1, 2, 0)));
+    }
+    Vec4fToVec3fScalar(src, dst, count - i);
+}
+
+// AVX2 kernels, only called when the CPU supports them.
+
+HDNUKE_TARGET_AVX2
+void HomogeneousToVec2fAVX2(const float* src, float* dst, size_t count)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, src += 16, dst += 8) {
+        // Two coordinates per register, one per 128 bit lane.
+        const __m256 a = _mm256_loadu_ps(src);
+        const __m256 b = _mm256_loadu_ps(src + 8);
+
+        __m256 wa = _mm256_permute_ps(a, _MM_SHUFFLE(3, 3, 3, 3));
+        __m256 wb = _mm256_permute_ps(b, _MM_SHUFFLE(3, 3, 3, 3));
+        wa = _mm256_blendv_ps(one, wa, _mm256_cmp_ps(wa, zero, _CMP_NEQ_OQ));
+        wb = _mm256_blendv_ps(one, wb, _mm256_cmp_ps(wb, zero, _CMP_NEQ_OQ));
+
+        const __m256 ra = _mm256_div_ps(a, wa);
+        const __m256 rb = _mm256_div_ps(b, wb);
+
+        // Lanes hold (uv0 uv2 | uv1 uv3), so swap the middle pairs back.
+        const __m256 xy = _mm256_shuffle_ps(ra, rb, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256d ordered = _mm256_permute4x64_pd(_mm256_castps_pd(xy),
+                                                      _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_ps(dst, _mm256_castpd_ps(ordered));
+    }
+    HomogeneousToVec2fSSE(src, dst, count - i);
+}
+
+HDNUKE_TARGET_AVX2
+void Vec4fToVec3fAVX2(const float* src, float* dst, size_t count)
+{
+    const __m256i packIndices = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+    // Every store writes two padding floats past the six valid ones, which
+    // the next store overwrites. Stop while at least one more value is left
+    // so the last store stays inside the destination.
+    size_t i = 0;
+    for (; i + 4 < count; i += 4, src += 16, dst += 12) {
+        const __m256 c01 = _mm256_loadu_ps(src);
+        const __m256 c23 = _mm256_loadu_ps(src + 8);
+        _mm256_storeu_ps(dst, _mm256_permutevar8x32_ps(c01, packIndices));
+        _mm256_storeu_ps(dst + 6, _mm256_permutevar8x32_ps(c23, packIndices));
+    }
+    Vec4fToVec3fSSE(src, dst, count - i);
+}
+
+bool CpuSupportsAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    // The OS must also save the AVX registers.
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // HDNUKE_X86
+
+const HdNukeConversionKernels kScalarKernels = {
+    HomogeneousToVec2fScalar,
+    Vec4fToVec3fScalar
+};
+
+#if HDNUKE_X86
+const HdNukeConversionKernels kSSEKernels = {
+    HomogeneousToVec2fSSE,
+    Vec4fToVec3fSSE
+};
+
+const HdNukeConversionKernels kAVX2Kernels = {
+    HomogeneousToVec2fAVX2,
+    Vec4fToVec3fAVX2
+};
+#endif
+
+}  // namespace
+
+HdNukeSimdLevel
+HdNukeConversionKernels::GetSupportedLevel()
+{
+#if HDNUKE_X86
+    static const HdNukeSimdLevel sLevel =
+        CpuSupportsAVX2() ? HdNukeSimdLevel::AVX2 : HdNukeSimdLevel::SSE;
+    return sLevel;
+#else
+    return HdNukeSimdLevel::Scalar;
+#endif
+}
+
+const HdNukeConversionKernels&
+HdNukeConversionKernels::Get()
+{
+    static const HdNukeConversionKernels& sKernels = Get(GetSupportedLevel());
+    return sKernels;
+}
+
+const HdNukeConversionKernels&
+HdNukeConversionKernels::Get(HdNukeSimdLevel level)
+{
+    if (level > GetSupportedLevel()) {
+        return kScalarKernels;
+    }
+
+    switch (level) {
+#if HDNUKE_X86
+        case HdNukeSimdLevel::AVX2:
+            return kAVX2Kernels;
+        case HdNukeSimdLevel::SSE:
+            return kSSEKernels;
+#endif
+        default:
+            return kScalarKernels;
+    }
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,64 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_CONVERSIONKERNELS_H
+#define HDNUKE_CONVERSIONKERNELS_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Instruction sets the conversion kernels are implemented for.
+enum class HdNukeSimdLevel
+{
+    Scalar,
+    SSE,
+    AVX2
+};
+
+/// Kernels converting Nuke's four component attributes to the narrower
+/// types Hydra expects.
+///
+/// The implementation is picked once at runtime from the best instruction set
+/// the CPU supports, falling back to plain C++ where no SIMD version exists.
+struct HdNukeConversionKernels
+{
+    /// Converts \p count homogeneous Vector4 coordinates at \p src to Vec2f
+    /// at \p dst, dividing x and y by w. Coordinates with a w of zero are
+    /// copied as they are.
+    void (*homogeneousToVec2f)(const float* src, float* dst, size_t count);
+
+    /// Converts \p count Vector4 values at \p src to Vec3f at \p dst,
+    /// dropping the fourth component.
+    void (*vec4fToVec3f)(const float* src, float* dst, size_t count);
+
+    /// Returns the kernels for the best instruction set supported by the CPU.
+    static const HdNukeConversionKernels& Get();
+
+    /// Returns the kernels for \p level, or the scalar ones if the CPU
+    /// doesn't support it.
+    static const HdNukeConversionKernels& Get(HdNukeSimdLevel level);
+
+    /// Returns the best instruction set supported by the CPU.
+    static HdNukeSimdLevel GetSupportedLevel();
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_CONVERSIONKERNELS_H
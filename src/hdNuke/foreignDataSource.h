@@ -0,0 +1,85 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_FOREIGNDATASOURCE_H
+#define HDNUKE_FOREIGNDATASOURCE_H
+
+#include <pxr/pxr.h>
+
+#include <pxr/base/vt/array.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A VtArray foreign data source backed by a ref-counted Nuke buffer.
+///
+/// VtArrays made with HdNukeMakeForeignArray point straight at the memory of
+/// a Nuke PointList or Attribute instead of holding a copy of it. The source
+/// holds a reference to the Nuke buffer, so the memory outlives Nuke's own
+/// geometry cache for as long as any VtArray (including the copies held by
+/// render delegates) still points into it. The source deletes itself once the
+/// last of those arrays is released.
+///
+/// Nuke may rewrite the memory of a buffer in place when the geometry
+/// changes, which the arrays pointing at it then see, so they are only made
+/// when HdNukeSceneDelegate::SetZeroCopyBuffers turns this on.
+///
+/// VtArray treats foreign data as shared, so any write access through a
+/// non-const accessor detaches the array into a private copy first.
+template <class BufferPtr>
+class HdNukeForeignDataSource : public Vt_ArrayForeignDataSource
+{
+public:
+    HdNukeForeignDataSource(const BufferPtr& buffer)
+        : Vt_ArrayForeignDataSource(&_Detached)
+        , _buffer(buffer)
+    {
+    }
+
+private:
+    static void _Detached(Vt_ArrayForeignDataSource* self)
+    {
+        delete static_cast<HdNukeForeignDataSource*>(self);
+    }
+
+    BufferPtr _buffer;
+};
+
+/// Returns a VtArray of \p size elements of type T that points at \p data,
+/// which must be owned by \p buffer.
+///
+/// Falls back to copying the data if there is no buffer to keep it alive.
+template <typename T, class BufferPtr>
+inline VtArray<T>
+HdNukeMakeForeignArray(const BufferPtr& buffer, const void* data, size_t size)
+{
+    const T* dataPtr = static_cast<const T*>(data);
+    if (dataPtr == nullptr) {
+        return VtArray<T>();
+    }
+    if (not buffer) {
+        VtArray<T> array;
+        array.assign(dataPtr, dataPtr + size);
+        return array;
+    }
+
+    auto* source = new HdNukeForeignDataSource<BufferPtr>(buffer);
+    return VtArray<T>(source, const_cast<T*>(dataPtr), size);
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_FOREIGNDATASOURCE_H
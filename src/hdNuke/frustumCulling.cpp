@@ -0,0 +1,60 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "frustumCulling.h"
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+bool
+HdNukeIsBoxInFrustum(const double* min, const double* max,
+                     const double* viewProjection)
+{
+    // Bits for each of the six clip planes the corners seen so far are all
+    // outside of: -x, +x, -y, +y, -z, +z.
+    unsigned int outside = 0x3f;
+    for (int corner = 0; corner < 8; corner++) {
+        const double point[3] = {
+            (corner & 1) ? max[0] : min[0],
+            (corner & 2) ? max[1] : min[1],
+            (corner & 4) ? max[2] : min[2]
+        };
+        double clip[4];
+        for (int column = 0; column < 4; column++) {
+            clip[column] = point[0] * viewProjection[column]
+                           + point[1] * viewProjection[4 + column]
+                           + point[2] * viewProjection[8 + column]
+                           + viewProjection[12 + column];
+        }
+        const double w = clip[3];
+        unsigned int planes = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            if (clip[axis] < -w) {
+                planes |= 1u << (axis * 2);
+            }
+            if (clip[axis] > w) {
+                planes |= 1u << (axis * 2 + 1);
+            }
+        }
+        outside &= planes;
+        if (outside == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
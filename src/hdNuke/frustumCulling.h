@@ -0,0 +1,38 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_FRUSTUMCULLING_H
+#define HDNUKE_FRUSTUMCULLING_H
+
+#include <pxr/pxr.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Returns whether any part of the box from \p min to \p max may be in view
+/// of a camera, given three doubles each.
+///
+/// \p viewProjection maps the space of the box to the clip space of the
+/// camera, with points as row vectors, so the data() of a GfMatrix4d can be
+/// passed. The box is only reported out of view when all of its corners are
+/// outside the same clip plane. That never culls a box that is in view, but
+/// keeps some boxes near the corners of the frustum that aren't.
+bool HdNukeIsBoxInFrustum(const double* min, const double* max,
+                          const double* viewProjection);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_FRUSTUMCULLING_H
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <pxr/base/gf/bbox3d.h>
+#include <pxr/base/tf/stringUtils.h>
 #include <pxr/usd/usdGeom/tokens.h>
 
 #include <pxr/imaging/pxOsd/tokens.h>
@@ -19,33 +21,578 @@
 #include <pxr/imaging/hd/tokens.h>
 
 #include "geoAdapter.h"
+#include "bufferPool.h"
+#include "conversionKernels.h"
+#include "meshChunkAdapter.h"
+#include "meshChunking.h"
+#include "meshDecimation.h"
+#include "meshTopology.h"
+#include "primvarPromotion.h"
+#include "primvarRequirements.h"
 #include "tokens.h"
 #include "utils.h"
+#include "vertexWelding.h"
 #include "adapterFactory.h"
 #include "adapterManager.h"
 #include "sceneDelegate.h"
 
+#include <DDImage/Enumeration_KnobI.h>
 #include <DDImage/GeoOp.h>
 #include <DDImage/Iop.h>
+#include <DDImage/Knob.h>
 #include <DDImage/RenderParticles.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
 using namespace DD::Image;
 
 PXR_NAMESPACE_OPEN_SCOPE
 
 
-// This token is not made public anywhere in USD
-TF_DEFINE_PRIVATE_TOKENS(
-    HdNukeGeoAdapterTokens,
+namespace
+{
+    size_t AttribElementSize(AttribType attrType)
+    {
+        switch (attrType) {
+            case FLOAT_ATTRIB:
+            case INT_ATTRIB:
+                return 4;
+            case VECTOR2_ATTRIB:
+                return 8;
+            case VECTOR3_ATTRIB:
+            case NORMAL_ATTRIB:
+                return 12;
+            case VECTOR4_ATTRIB:
+                return 16;
+            case MATRIX3_ATTRIB:
+                return 36;
+            case MATRIX4_ATTRIB:
+                return 64;
+            default:
+                return 0;
+        }
+    }
+
+    // Hashes the contents of an attribute, used to tell whether it needs to
+    // be converted again and to find its converted data in the buffer pool.
+    HdNukeContentHash AttributeContentHash(const Attribute& attribute)
+    {
+        const AttribType attrType = attribute.type();
+        const size_t size = attribute.size();
+        void* rawData = attribute.array();
+
+        if (attrType == STD_STRING_ATTRIB) {
+            const std::string* strings = static_cast<const std::string*>(rawData);
+            HdNukeContentHash hash = HdNukeHashContent(nullptr, 0, size);
+            for (size_t i = 0; i < size; i++) {
+                hash = HdNukeHashContent(strings[i].data(), strings[i].size(), hash);
+            }
+            return hash;
+        }
+        if (attrType == STRING_ATTRIB) {
+            char* const* strings = static_cast<char* const*>(rawData);
+            HdNukeContentHash hash = HdNukeHashContent(nullptr, 0, size);
+            for (size_t i = 0; i < size; i++) {
+                if (strings[i] != nullptr) {
+                    hash = HdNukeHashContent(strings[i], std::strlen(strings[i]), hash);
+                }
+            }
+            return hash;
+        }
+
+        return HdNukeHashContent(rawData, size * AttribElementSize(attrType), size);
+    }
+
+    // Returns the subdivision scheme named by a subdiv_scheme knob on the
+    // source op, or failing that by a subdivScheme attribute on the geometry.
+    // Empty if neither names one.
+    std::string GetSubdivSchemeName(const GeoInfo& geo)
+    {
+        std::string scheme;
+        if (Knob* knob = geo.source_geo->knob("subdiv_scheme")) {
+            if (Enumeration_KnobI* enumKnob = knob->enumerationKnob()) {
+                scheme = enumKnob->getItemValueString(static_cast<int>(knob->get_value()));
+            }
+            else if (knob->get_text() != nullptr) {
+                scheme = knob->get_text();
+            }
+        }
+        if (scheme.empty()) {
+            const auto* schemeCtx = geo.get_group_attribcontext(
+                Group_Object, HdNukeTokens->subdivScheme.GetText());
+            if (schemeCtx != nullptr && !schemeCtx->empty()) {
+                void* rawData = schemeCtx->attribute->array();
+                if (schemeCtx->type == STD_STRING_ATTRIB) {
+                    scheme = static_cast<std::string*>(rawData)[0];
+                }
+                else if (schemeCtx->type == STRING_ATTRIB
+                         && static_cast<char**>(rawData)[0] != nullptr) {
+                    scheme = static_cast<char**>(rawData)[0];
+                }
+            }
+        }
+        return scheme;
+    }
+
+    // An attribute queued for conversion by _RebuildPrimvars, along with the
+    // slot its converted value is written to.
+    struct PrimvarConversion
+    {
+        enum Kind
+        {
+            General,
+            TextureCoordinates,
+            Colors
+        };
+
+        TfToken name;
+        const AttribContext* attribCtx;
+        Kind kind;
+        // Whether to try storing a face-varying attribute per point, and
+        // whether that worked out.
+        bool promote;
+        bool promoted;
+        // The hash the converted data is shared in the buffer pool under.
+        HdNukeContentHash contentHash;
+        VtValue result;
+        HdNukeBufferPool::Reference pooled;
+        // Whether the result points into Nuke's attribute memory.
+        bool foreign = false;
+    };
+
+    // What ConvertAttribute needs to know besides the attribute itself.
+    struct ConversionContext
+    {
+        bool zeroCopy;
+        // The face vertices of the mesh and its number of points, used to
+        // promote face-varying attributes.
+        const VtIntArray* faceVertexIndices;
+        size_t numPoints;
+        // The weld map point attributes are compacted with, if any.
+        const HdNukeWeldMap* weldMap;
+        // Whether to share the converted data through the buffer pool.
+        bool shareBuffers;
+    };
+
+    template <typename T>
+    VtValue MakeArrayValue(const void* data, size_t size)
+    {
+        const T* dataPtr = static_cast<const T*>(data);
+        VtArray<T> array;
+        array.assign(dataPtr, dataPtr + size);
+        return VtValue::Take(array);
+    }
+
+    // Converts a single attribute to the value handed to Hydra, or returns an
+    // empty value if its type isn't supported. Only reads the attribute, so
+    // it is safe to call for several attributes at the same time.
+    VtValue ConvertAttribute(PrimvarConversion& conversion,
+                             const ConversionContext& context)
+    {
+        const AttribContext& attribCtx = *conversion.attribCtx;
+        const Attribute& attribute = *attribCtx.attribute;
+        const AttribType attrType = attribute.type();
+        const void* data = attribute.array();
+        size_t size = attribute.size();
+
+        // Face-varying values that agree on every corner of each point can be
+        // stored once per point instead.
+        std::vector<char> pointData;
+        conversion.promoted = false;
+        if (context.weldMap != nullptr && attribCtx.group == Group_Points
+                && size == context.weldMap->pointRemap.size()) {
+            const size_t elementSize = AttribElementSize(attrType);
+            if (elementSize > 0) {
+                pointData.resize(context.numPoints * elementSize);
+                HdNukeGatherPointValues(data, elementSize,
+                                        context.weldMap->representatives,
+                                        pointData.data());
+                data = pointData.data();
+                size = context.numPoints;
+            }
+        }
+        if (conversion.promote && size > 1
+                && size == context.faceVertexIndices->size()) {
+            const size_t elementSize = AttribElementSize(attrType);
+            std::vector<int> pointFaceVertices;
+            if (elementSize > 0
+                    && HdNukeFindUniformPointValues(
+                        data, elementSize, context.faceVertexIndices->cdata(),
+                        size, context.numPoints, pointFaceVertices)) {
+                pointData.resize(context.numPoints * elementSize);
+                HdNukeGatherPointValues(data, elementSize, pointFaceVertices,
+                                        pointData.data());
+                data = pointData.data();
+                size = context.numPoints;
+                conversion.promoted = true;
+            }
+        }
+
+        // XXX: Special case for UVs. Nuke stores UVs as Vector4
+        // (homogeneous 3D coordinates), but USD/Hydra conventions stipulate Vec2f.
+        // Thus, we do type conversion in the case of a float vecter attr with
+        // width > 2, just to be nice.
+        if (conversion.kind == PrimvarConversion::TextureCoordinates) {
+            VtVec2fArray uvs(size);
+            HdNukeConversionKernels::Get().homogeneousToVec2f(
+                static_cast<const float*>(data),
+                reinterpret_cast<float*>(uvs.data()), size);
+            return VtValue(uvs);
+        }
+
+        // Cf is Vector4, but displayColor needs Vector3
+        if (conversion.kind == PrimvarConversion::Colors) {
+            VtVec3fArray colors(size);
+            HdNukeConversionKernels::Get().vec4fToVec3f(
+                static_cast<const float*>(data),
+                reinterpret_cast<float*>(colors.data()), size);
+            return VtValue(colors);
+        }
+
+        // General-purpose attribute conversions
+        if (size == 1) {
+            const void* rawData = data;
+            const float* floatData = static_cast<const float*>(rawData);
+
+            switch (attrType) {
+                case FLOAT_ATTRIB:
+                    return VtValue(floatData[0]);
+                case INT_ATTRIB:
+                    return VtValue(static_cast<const int32_t*>(rawData)[0]);
+                case STRING_ATTRIB:
+                    return VtValue(std::string(static_cast<char* const*>(rawData)[0]));
+                case STD_STRING_ATTRIB:
+                    return VtValue(static_cast<const std::string*>(rawData)[0]);
+                case VECTOR2_ATTRIB:
+                    return VtValue(GfVec2f(floatData));
+                case VECTOR3_ATTRIB:
+                case NORMAL_ATTRIB:
+                    return VtValue(GfVec3f(floatData));
+                case VECTOR4_ATTRIB:
+                    return VtValue(GfVec4f(floatData));
+                case MATRIX3_ATTRIB:
+                    {
+                        GfMatrix3f gfMatrix;
+                        std::copy(floatData, floatData + 9, gfMatrix.data());
+                        return VtValue(gfMatrix);
+                    }
+                case MATRIX4_ATTRIB:
+                    {
+                        GfMatrix4f gfMatrix;
+                        std::copy(floatData, floatData + 16, gfMatrix.data());
+                        return VtValue(gfMatrix);
+                    }
+                default:
+                    return VtValue();
+            }
+        }
+
+        conversion.foreign = false;
+        if (context.zeroCopy && data == attribute.array()) {
+            // These types have the same memory layout in Nuke and Gf, so
+            // Hydra can read the attribute memory directly.
+            conversion.foreign = true;
+            switch (attrType) {
+                case FLOAT_ATTRIB:
+                    return DDAttrToForeignVtArrayValue<float>(attribCtx.attribute);
+                case INT_ATTRIB:
+                    return DDAttrToForeignVtArrayValue<int32_t>(attribCtx.attribute);
+                case VECTOR2_ATTRIB:
+                    return DDAttrToForeignVtArrayValue<GfVec2f>(attribCtx.attribute);
+                case VECTOR3_ATTRIB:
+                case NORMAL_ATTRIB:
+                    return DDAttrToForeignVtArrayValue<GfVec3f>(attribCtx.attribute);
+                case VECTOR4_ATTRIB:
+                    return DDAttrToForeignVtArrayValue<GfVec4f>(attribCtx.attribute);
+                default:
+                    conversion.foreign = false;
+                    break;
+            }
+        }
+
+        switch (attrType) {
+            case FLOAT_ATTRIB:
+                return MakeArrayValue<float>(data, size);
+            case INT_ATTRIB:
+                return MakeArrayValue<int32_t>(data, size);
+            case VECTOR2_ATTRIB:
+                return MakeArrayValue<GfVec2f>(data, size);
+            case VECTOR3_ATTRIB:
+            case NORMAL_ATTRIB:
+                return MakeArrayValue<GfVec3f>(data, size);
+            case VECTOR4_ATTRIB:
+                return MakeArrayValue<GfVec4f>(data, size);
+            case MATRIX3_ATTRIB:
+                return MakeArrayValue<GfMatrix3f>(data, size);
+            case MATRIX4_ATTRIB:
+                return MakeArrayValue<GfMatrix4f>(data, size);
+            case STD_STRING_ATTRIB:
+                return MakeArrayValue<std::string>(data, size);
+            default:
+                // XXX: Ignoring char* array attrs for now... not sure whether they
+                // need special-case handling.
+                // case STRING_ATTRIB:
+                return VtValue();
+        }
+    }
+
+    // Works out the name and role of the primvar a Nuke attribute becomes.
+    void PrimvarForAttribute(const TfToken& attribName, TfToken* name,
+                             TfToken* role)
+    {
+        *name = attribName;
+        if (attribName == HdNukeTokens->Cf) {
+            *name = HdTokens->displayColor;
+            *role = HdPrimvarRoleTokens->color;
+        }
+        else if (attribName == HdNukeTokens->uv) {
+            *name = HdNukeTokens->st;
+            *role = HdPrimvarRoleTokens->textureCoordinate;
+        }
+        else if (attribName == HdNukeTokens->N) {
+            *name = HdTokens->normals;
+            *role = HdPrimvarRoleTokens->normal;
+        }
+        else if (attribName == HdNukeTokens->size) {
+            *name = HdTokens->widths;
+        }
+        else if (attribName == HdNukeTokens->PW) {
+            *role = HdPrimvarRoleTokens->point;
+        }
+        else if (attribName == HdNukeTokens->vel) {
+            *name = HdTokens->velocities;
+            *role = HdPrimvarRoleTokens->vector;
+        }
+        else {
+            *role = HdPrimvarRoleTokens->none;
+        }
+    }
+
+    // Converts an attribute, swapping in the pooled copy of identical data
+    // converted by another adapter if there is one. Only writes to the
+    // conversion, so it is safe to call for several at the same time.
+    void RunConversion(PrimvarConversion& conversion,
+                       const ConversionContext& context)
+    {
+        conversion.result = ConvertAttribute(conversion, context);
+        if (conversion.result.IsEmpty()) {
+            TF_WARN("HdNukeGeoAdapter::_RebuildPrimvars : Unhandled "
+                    "attribute type: %d", conversion.attribCtx->attribute->type());
+            return;
+        }
+        if (context.shareBuffers && conversion.result.IsArrayValued()) {
+            // Nuke rewrites the memory of zero-copy arrays in place, so those
+            // are copied before they go into the pool.
+            HdNukeBufferPool& pool = HdNukeBufferPool::GetInstance();
+            conversion.pooled = conversion.foreign
+                ? pool.ShareCopy(conversion.contentHash, conversion.result)
+                : pool.Share(conversion.contentHash, std::move(conversion.result));
+            if (conversion.pooled) {
+                conversion.result = conversion.pooled.Get();
+            }
+        }
+    }
+
+    // Keeps a converted attribute where Get looks for it. pooledPrimvars may
+    // be null when no buffers are shared.
+    void StoreConversion(PrimvarConversion& conversion, HdNukePrimvarTable& primvars,
+                         TfTokenMap<HdNukeBufferPool::Reference>* pooledPrimvars)
+    {
+        if (conversion.pooled) {
+            (*pooledPrimvars)[conversion.name] = std::move(conversion.pooled);
+        }
+        else if (pooledPrimvars != nullptr) {
+            pooledPrimvars->erase(conversion.name);
+        }
+        primvars.SetValue(conversion.name, std::move(conversion.result));
+    }
+}
+
+// An attribute whose conversion is left until the render delegate asks for
+// it, in lazy mode. The attribute is read in place, so like zero-copy
+// buffers it relies on Nuke keeping the geometry until the next sync.
+struct HdNukeLazyPrimvar
+{
+    PrimvarConversion conversion;
+    ConversionContext context;
+    std::once_flag once;
+    bool converted = false;
+
+    // Converts the attribute the first time it's called, however many
+    // threads call it at once, and returns the result.
+    const VtValue& Get()
+    {
+        std::call_once(once, [this]() {
+            RunConversion(conversion, context);
+            converted = true;
+        });
+        return conversion.result;
+    }
+};
+
+namespace
+{
+    VtIntArray ToVtIntArray(const std::vector<int>& values)
+    {
+        VtIntArray array(values.size());
+        std::copy(values.begin(), values.end(), array.data());
+        return array;
+    }
+
+    template <typename T>
+    bool SliceArray(const VtValue& value, const std::vector<int>& indices,
+                    VtValue& slice)
+    {
+        if (!value.IsHolding<VtArray<T>>()) {
+            return false;
+        }
+        const VtArray<T>& array = value.UncheckedGet<VtArray<T>>();
+        if (!indices.empty() && static_cast<size_t>(
+                *std::max_element(indices.begin(), indices.end())) >= array.size()) {
+            slice = VtValue();
+            return true;
+        }
+        VtArray<T> result(indices.size());
+        const T* source = array.cdata();
+        T* destination = result.data();
+        for (size_t i = 0; i < indices.size(); i++) {
+            destination[i] = source[indices[i]];
+        }
+        slice = VtValue::Take(result);
+        return true;
+    }
+
+    // Returns the elements of an array value at \p indices, or the value
+    // itself if it isn't an array. Returns an empty value if the array is
+    // too short.
+    VtValue SliceArrayValue(const VtValue& value, const std::vector<int>& indices)
+    {
+        VtValue slice;
+        if (SliceArray<float>(value, indices, slice)
+                || SliceArray<int32_t>(value, indices, slice)
+                || SliceArray<GfVec2f>(value, indices, slice)
+                || SliceArray<GfVec3f>(value, indices, slice)
+                || SliceArray<GfVec4f>(value, indices, slice)
+                || SliceArray<GfMatrix3f>(value, indices, slice)
+                || SliceArray<GfMatrix4f>(value, indices, slice)
+                || SliceArray<std::string>(value, indices, slice)) {
+            return slice;
+        }
+        return value;
+    }
+
+    // How many times fewer faces each LOD level has than the mesh.
+    const size_t kLodReductions[] = {4, 16};
 
-    (overrideWireframeColor)
-);
+    // The screen area each face of a LOD level should cover, in pixels.
+    const double kPixelsPerLodFace = 4.0;
+
+    // LOD builds are queued here, so they run alongside the sync rather
+    // than holding it up.
+    tbb::task_arena& LodArena()
+    {
+        static tbb::task_arena arena;
+        return arena;
+    }
+}
+
+// The data a background LOD build works from and the levels it built. The
+// build only reads its own copy of the mesh, so the adapter can change or
+// go away while it runs.
+struct HdNukeMeshLodBuild
+{
+    HdNukeContentHash hash;
+    std::vector<float> points;
+    std::vector<int> faceVertexCounts;
+    std::vector<int> faceVertexIndices;
+    std::vector<size_t> targetFaces;
+    std::vector<HdNukeMeshLod> lods;
+    std::atomic<bool> done{false};
+};
+
+struct HdNukeGeoAdapter::_OptionalState
+{
+    // Content hashes of the current points and topology.
+    HdNukeContentHash pointsHash;
+    HdNukeContentHash topologyHash;
+
+    // What each attribute looked like when it was last converted, and the
+    // primvars converted again by the last call to _RebuildPrimvars.
+    TfTokenMap<_AttributeState> attributeStates;
+    TfTokenVector dirtyPrimvars;
+
+    // The primvars waiting to be converted when they are asked for.
+    TfTokenMap<std::shared_ptr<HdNukeLazyPrimvar>> lazyPrimvars;
+
+    // The pooled data backing the topology and the converted primvars,
+    // shared with any other adapter holding the same contents.
+    HdNukeBufferPool::Reference pooledTopology;
+    TfTokenMap<HdNukeBufferPool::Reference> pooledPrimvars;
+
+    // How points are merged when welding, and the hash of the unwelded
+    // topology it was made for.
+    HdNukeWeldMap weldMap;
+    HdNukeContentHash weldMapHash;
+
+    // How the mesh is split into chunks and the data of each, if it is.
+    std::vector<HdNukeMeshChunk> chunks;
+    std::vector<std::shared_ptr<const HdNukeMeshChunkData>> chunkData;
+
+    // The decimated levels of the mesh, finest first, and the hash of the
+    // points and topology they were built from. The hash of the current
+    // points and topology, the level shown and its data, and the build in
+    // progress, if any.
+    std::vector<HdNukeMeshLod> lods;
+    HdNukeContentHash lodHash;
+    HdNukeContentHash lodSourceHash;
+    int lodLevel = -1;
+    std::shared_ptr<const HdNukeMeshChunkData> lodData;
+    std::shared_ptr<HdNukeMeshLodBuild> lodBuild;
+
+    // The primvars that are converted, when only those are.
+    HdNukePrimvarRequirements primvarRequirements;
+    bool filterPrimvars = false;
+};
 
 HdNukeGeoAdapter::HdNukeGeoAdapter(AdapterSharedState* statePtr)
     : HdNukeAdapter(statePtr)
 {
 }
 
+HdNukeGeoAdapter::~HdNukeGeoAdapter()
+{
+}
+
+HdNukeGeoAdapter::_OptionalState&
+HdNukeGeoAdapter::_GetOptionalState()
+{
+    if (!_optional) {
+        _optional = std::make_unique<_OptionalState>();
+    }
+    return *_optional;
+}
+
+bool
+HdNukeGeoAdapter::_IsChunked() const
+{
+    return _optional && !_optional->chunks.empty();
+}
+
+const HdNukeMeshChunkData*
+HdNukeGeoAdapter::_GetLodData() const
+{
+    return _optional ? _optional->lodData.get() : nullptr;
+}
+
 void
 HdNukeGeoAdapter::Update(const GeoInfo& geo, HdDirtyBits dirtyBits,
                          bool isInstanced)
@@ -67,12 +614,7 @@ HdNukeGeoAdapter::Update(const GeoInfo& geo, HdDirtyBits dirtyBits,
     }
 
     if (dirtyBits & HdChangeTracker::DirtyVisibility) {
-        if (GetSharedState()->interactive) {
-          _visible = geo.display3d != DISPLAY_OFF;
-        }
-        else {
-          _visible = geo.render_mode != RENDER_OFF;
-        }
+        _visible = _IsShown(geo);
     }
 
     if (dirtyBits & HdChangeTracker::DirtyPrimvar) {
@@ -109,82 +651,145 @@ HdNukeGeoAdapter::Update(const GeoInfo& geo, HdDirtyBits dirtyBits,
 HdPrimvarDescriptorVector
 HdNukeGeoAdapter::GetPrimvarDescriptors(HdInterpolation interpolation) const
 {
-    switch (interpolation) {
-        case HdInterpolationConstant:
-            return _constantPrimvarDescriptors;
-        case HdInterpolationUniform:
-            return _uniformPrimvarDescriptors;
-        case HdInterpolationVertex:
-            return _vertexPrimvarDescriptors;
-        case HdInterpolationFaceVarying:
-            return _faceVaryingPrimvarDescriptors;
-        default:
-            return HdPrimvarDescriptorVector();
-    }
+    return _primvars.GetDescriptors(interpolation);
 }
 
 void
 HdNukeGeoAdapter::_RebuildMeshTopology(const GeoInfo& geo)
 {
-    const uint32_t numPrimitives = geo.primitives();
-
-    size_t totalFaces = 0;
-    size_t totalVerts = 0;
-    const Primitive** primArray = geo.primitive_array();
-    for (size_t primIndex = 0; primIndex < numPrimitives; primIndex++)
-    {
-        totalFaces += primArray[primIndex]->faces();
-        totalVerts += primArray[primIndex]->vertices();
-    }
-
     VtIntArray faceVertexCounts;
-    faceVertexCounts.reserve(totalFaces);
     VtIntArray faceVertexIndices;
-    faceVertexIndices.reserve(totalVerts);
+    HdNukeMeshTopologyBuilder(geo).Build(faceVertexCounts, faceVertexIndices);
+
+    // Delegates only refine meshes that subdivide, so the refine level
+    // follows the scheme.
+    _subdivScheme = GetSubdivSchemeForGeo(geo);
+    const int refineLevel = _subdivScheme == PxOsdOpenSubdivTokens->none
+                            ? 0 : GetSharedState()->subdivRefineLevel;
+    _displayStyleChanged = refineLevel != _displayStyle.refineLevel;
+    _displayStyle = HdDisplayStyle(refineLevel);
+
+    _WeldPoints(geo, faceVertexCounts, faceVertexIndices);
+
+    const bool verifyChanges = GetSharedState()->verifyContentChanges;
+    const bool shareBuffers = GetSharedState()->shareBuffers;
+    HdNukeContentHash hash;
+    if (verifyChanges || shareBuffers || GetSharedState()->promoteFaceVarying) {
+        hash = HdNukeHashContent(
+            faceVertexCounts.cdata(), faceVertexCounts.size() * sizeof(int));
+        hash = HdNukeHashContent(
+            faceVertexIndices.cdata(), faceVertexIndices.size() * sizeof(int), hash);
+        hash = HdNukeHashContent(_subdivScheme.GetText(), _subdivScheme.size(), hash);
+    }
 
-    std::vector<uint32_t> faceVertices(16);
+    // Rebuilding the same faces doesn't need a new topology.
+    HdNukeContentHash& topologyHash = _GetOptionalState().topologyHash;
+    _topologyChanged = !verifyChanges || hash != topologyHash
+                       || _topology.GetNumFaces() == 0;
+    topologyHash = hash;
+    if (!_topologyChanged) {
+        return;
+    }
 
-    for (uint32_t primIndex = 0; primIndex < numPrimitives; primIndex++)
-    {
-        const Primitive* prim = primArray[primIndex];
-        const PrimitiveType primType = prim->getPrimitiveType();
-        if (primType == ePoint or primType == eParticles
-                or primType == eParticlesSprite) {
-            // TODO: Warn/debug
-            continue;
+    _topology = HdMeshTopology(_subdivScheme,
+                               UsdGeomTokens->rightHanded, faceVertexCounts,
+                               faceVertexIndices);
+
+    if (shareBuffers) {
+        HdNukeBufferPool::Reference& pooledTopology = _GetOptionalState().pooledTopology;
+        pooledTopology = HdNukeBufferPool::GetInstance().Share(
+            hash, VtValue(_topology));
+        if (pooledTopology) {
+            _topology = pooledTopology.Get().UncheckedGet<HdMeshTopology>();
         }
+    }
+    else if (_optional) {
+        _optional->pooledTopology.Reset();
+    }
+}
 
-        for (uint32_t faceIndex = 0; faceIndex < prim->faces(); faceIndex++)
-        {
-            const uint32_t numFaceVertices = prim->face_vertices(faceIndex);
-            if (numFaceVertices > faceVertices.size()) {
-              faceVertices.resize(numFaceVertices);
-            }
-            faceVertexCounts.push_back(numFaceVertices);
-
-            prim->get_face_vertices(faceIndex, faceVertices.data());
-            for (uint32_t faceVertexIndex = 0;
-                 faceVertexIndex < numFaceVertices; faceVertexIndex++)
-            {
-                faceVertexIndices.push_back(
-                    prim->vertex(faceVertices[faceVertexIndex]));
-            }
+void
+HdNukeGeoAdapter::_WeldPoints(const GeoInfo& geo,
+                              const VtIntArray& faceVertexCounts,
+                              VtIntArray& faceVertexIndices)
+{
+    const PointList* pointList = geo.point_list();
+    if (!GetSharedState()->weldVertices || pointList == nullptr
+            || GetPrimType() != HdPrimTypeTokens->mesh) {
+        if (_optional) {
+            _optional->weldMap = HdNukeWeldMap();
+            _optional->weldMapHash = HdNukeContentHash();
         }
+        return;
     }
 
-    _topology = HdMeshTopology(PxOsdOpenSubdivTokens->smooth,
-                               UsdGeomTokens->rightHanded, faceVertexCounts,
-                               faceVertexIndices);
+    // Animated meshes keep their connectivity from frame to frame, so the
+    // weld map is only worked out again when the unwelded topology changes.
+    HdNukeContentHash hash = HdNukeHashContent(
+        faceVertexCounts.cdata(), faceVertexCounts.size() * sizeof(int),
+        pointList->size());
+    hash = HdNukeHashContent(
+        faceVertexIndices.cdata(), faceVertexIndices.size() * sizeof(int), hash);
+    _OptionalState& optional = _GetOptionalState();
+    if (hash != optional.weldMapHash) {
+        optional.weldMap = HdNukeBuildWeldMap(
+            reinterpret_cast<const float*>(pointList->data()), pointList->size(),
+            GetSharedState()->weldTolerance);
+        optional.weldMapHash = hash;
+    }
+
+    HdNukeRemapPointIndices(optional.weldMap, faceVertexIndices.data(),
+                            faceVertexIndices.size());
 }
 
 void HdNukeGeoAdapter::_RebuildPointList(const GeoInfo& geo)
 {
     const PointList* pointList = geo.point_list();
     if (ARCH_UNLIKELY(!pointList)) {
+        _pointsChanged = !_points.empty();
+        if (_optional) {
+            _optional->pointsHash = HdNukeContentHash();
+        }
         _points.clear();
         return;
     }
 
+    // Upstream ops often report point changes that didn't move anything, so
+    // keep the current array if the positions are the same.
+    // Welding changes the points as well, so the weld map is part of the hash.
+    const HdNukeWeldMap* weldMap = _optional ? &_optional->weldMap : nullptr;
+    if (GetSharedState()->verifyContentChanges) {
+        const HdNukeContentHash hash = HdNukeHashContent(
+            pointList->data(), pointList->size() * sizeof(Vector3),
+            _optional ? _optional->weldMapHash : HdNukeContentHash());
+        HdNukeContentHash& pointsHash = _GetOptionalState().pointsHash;
+        _pointsChanged = hash != pointsHash || _points.empty();
+        pointsHash = hash;
+        if (!_pointsChanged) {
+            return;
+        }
+    }
+    else {
+        _pointsChanged = true;
+    }
+
+    if (weldMap && !weldMap->IsEmpty()
+            && weldMap->pointRemap.size() == pointList->size()) {
+        _points.resize(weldMap->GetWeldedPointCount());
+        HdNukeGatherPointValues(pointList->data(), sizeof(Vector3),
+                                weldMap->representatives, _points.data());
+        return;
+    }
+
+    if (GetSharedState()->zeroCopyBuffers) {
+        static_assert(sizeof(Vector3) == sizeof(GfVec3f),
+                      "Vector3 and GfVec3f layouts differ");
+        _points = HdNukeMakeForeignArray<GfVec3f>(
+            geo.get_cache_pointer()->points, pointList->data(),
+            pointList->size());
+        return;
+    }
+
     const auto* rawPoints = reinterpret_cast<const GfVec3f*>(pointList->data());
     _points.assign(rawPoints, rawPoints + pointList->size());
 }
@@ -196,21 +801,27 @@ HdNukeGeoAdapter::Get(const TfToken& key) const
     if (key == HdTokens->transform) {
         return VtValue{GetTransform()};
     }
+    const HdNukeMeshChunkData* lodData = _GetLodData();
     if (key == HdTokens->points) {
-        return VtValue(_points);
+        return lodData ? VtValue(lodData->points) : VtValue(_points);
     }
-    else if (key == HdTokens->displayColor) {
-      if (_colors.size() != 0) {
-        return VtValue(_colors);
-      }
-      return VtValue(_displayColor);
+
+    // Hydra syncs rprims in parallel, so this can be called from several
+    // threads at once.
+    if (_optional) {
+        auto lazyPrimvar = _optional->lazyPrimvars.find(key);
+        if (lazyPrimvar != _optional->lazyPrimvars.end()) {
+            const VtValue& value = lazyPrimvar->second->Get();
+            if (key == HdTokens->displayColor && value.IsEmpty()) {
+                return VtValue(_displayColor);
+            }
+            return value;
+        }
     }
-    else if (key == HdNukeGeoAdapterTokens->overrideWireframeColor) {
+
+    if (key == HdNukeTokens->overrideWireframeColor) {
         return VtValue(_wireframeColor);
     }
-    else if (key == HdNukeTokens->st) {
-        return VtValue(_uvs);
-    }
     else if (key == HdNukeTokens->materialId) {
         return VtValue{_materialId};
     }
@@ -218,7 +829,7 @@ HdNukeGeoAdapter::Get(const TfToken& key) const
         return VtValue{GetExtent()};
     }
     else if (key == HdNukeTokens->meshTopology) {
-        return VtValue{GetMeshTopology()};
+        return lodData ? VtValue{lodData->topology} : VtValue{GetMeshTopology()};
     }
     else if (key == HdNukeTokens->visible) {
         return VtValue{GetVisible()};
@@ -229,16 +840,27 @@ HdNukeGeoAdapter::Get(const TfToken& key) const
     else if (key == HdNukeTokens->reprSelector) {
         return VtValue{GetReprSelector()};
     }
+    else if (key == HdNukeTokens->displayStyle) {
+        return VtValue{GetDisplayStyle()};
+    }
 
-    auto it = _primvarData.find(key);
-    if (it != _primvarData.end()) {
-        return it->second;
+    const HdNukePrimvarTable& primvars = lodData ? lodData->primvars
+                                                 : _primvars;
+    const VtValue& value = primvars.GetValue(key);
+    if (!value.IsEmpty()) {
+        return value;
     }
 
     // Deal with fallbacks for keys which may have have been handled already
+    if (key == HdTokens->displayColor) {
+      return VtValue(_displayColor);
+    }
     if (key == HdTokens->widths) {
       return VtValue(_pointSize);
     }
+    if (key == HdNukeTokens->st) {
+      return VtValue(VtVec2fArray());
+    }
 
     TF_WARN("HdNukeGeoAdapter::Get : Unrecognized key: %s", key.GetText());
     return VtValue();
@@ -261,235 +883,257 @@ HdNukeGeoAdapter::_RebuildPrimvars(const GeoInfo& geo)
     // Group_Points (?)  -> HdInterpolationVertex
     // Group_Vertices    -> HdInterpolationFaceVarying
 
-    static HdPrimvarDescriptor displayColorDescriptor(
-            HdTokens->displayColor, HdInterpolationConstant,
-            HdPrimvarRoleTokens->color);
-    static HdPrimvarDescriptor overrideWireframeColorDescriptor(
-            HdNukeGeoAdapterTokens->overrideWireframeColor, HdInterpolationConstant,
-            HdNukeGeoAdapterTokens->overrideWireframeColor);
-    static HdPrimvarDescriptor widthsColorDescriptor(
-            HdTokens->widths, HdInterpolationConstant,
-            TfToken());
+    // Keep what the delegate converted since the last rebuild, and forget
+    // the rest so it counts as changed.
+    _FinishLazyPrimvars(false);
+
+    // Attributes that haven't changed since the last rebuild keep their
+    // converted data, so only the ones that did are converted again.
+    HdNukePrimvarTable previousPrimvars = std::move(_primvars);
+    _primvars.Clear();
+    _primvars.Add(HdNukeTokens->overrideWireframeColor, HdInterpolationConstant,
+                  HdNukeTokens->overrideWireframeColor);
 
     // XXX: Hydra doesn't officially state that a `points` descriptor is
     // required (even for Rprim types with implied points), and there's a good
     // case to be made that it *shouldn't* be, but Storm currently seems to rely
     // on it when generating GLSL code, so we take the conservative approach.
-    static HdPrimvarDescriptor pointsDescriptor(
-            HdTokens->points, HdInterpolationVertex,
-            HdPrimvarRoleTokens->point);
-
-    // TODO: Try to reuse existing descriptors?
-    _constantPrimvarDescriptors.clear();
-    _constantPrimvarDescriptors.push_back(overrideWireframeColorDescriptor);
-    _uniformPrimvarDescriptors.clear();
-    _vertexPrimvarDescriptors.clear();
-    _vertexPrimvarDescriptors.push_back(pointsDescriptor);
-    _faceVaryingPrimvarDescriptors.clear();
+    _primvars.Add(HdTokens->points, HdInterpolationVertex,
+                  HdPrimvarRoleTokens->point);
 
-    _primvarData.clear();
-    _primvarData.reserve(geo.get_attribcontext_count());
+    _OptionalState& optional = _GetOptionalState();
+    TfTokenMap<_AttributeState>& attributeStates = optional.attributeStates;
+    TfTokenVector& dirtyPrimvars = optional.dirtyPrimvars;
+    TfTokenMap<_AttributeState> previousStates;
+    previousStates.swap(attributeStates);
 
-    _colors.clear();
+    dirtyPrimvars.clear();
 
     // TODO: Look up color from GeoInfo
     _displayColor = GetSharedState()->defaultDisplayColor;
 
     bool haveVertexWidths = false;
 
-    for (const auto& attribCtx : geo.get_cache_pointer()->attributes)
+    const bool shareBuffers = GetSharedState()->shareBuffers;
+    ConversionContext context{GetSharedState()->zeroCopyBuffers, nullptr, 0,
+                              nullptr, shareBuffers};
+
+    // Face-varying attributes are checked for promotion to vertex ones
+    // against the current topology.
+    const bool promote = GetSharedState()->promoteFaceVarying
+                         && GetPrimType() == HdPrimTypeTokens->mesh;
+    if (promote) {
+        context.faceVertexIndices = &_topology.GetFaceVertexIndices();
+        context.numPoints = geo.points();
+    }
+    // Point attributes of welded meshes are compacted like the points.
+    if (_optional && !_optional->weldMap.IsEmpty()) {
+        context.weldMap = &_optional->weldMap;
+        context.numPoints = _optional->weldMap.GetWeldedPointCount();
+    }
+
+    const auto& attributes = geo.get_cache_pointer()->attributes;
+    const bool parallel = GetSharedState()->parallelPrimvars;
+
+    // The primvar each attribute becomes, and whether anything reads it.
+    // Attributes nothing reads are left alone, without even being hashed.
+    struct AttributePrimvar
     {
+        TfToken name;
+        TfToken role;
+        bool wanted = false;
+    };
+    const HdNukePrimvarRequirements* requirements =
+        _optional && _optional->filterPrimvars ? &_optional->primvarRequirements
+                                               : nullptr;
+    std::vector<AttributePrimvar> attributePrimvars(attributes.size());
+    for (size_t attribIndex = 0; attribIndex < attributes.size(); attribIndex++) {
+        const auto& attribCtx = attributes[attribIndex];
         if (attribCtx.empty()) {
             continue;
         }
-
-        TfToken primvarName(attribCtx.name);
-        TfToken role;
-
-        if (primvarName == HdNukeTokens->Cf) {
-            // Ignore displayColor for instances because otherwise
-            // our displayColor overrides the instancer's one.
-            if (_isInstanced) {
-              continue;
-            }
-            primvarName = HdTokens->displayColor;
-            role = HdPrimvarRoleTokens->color;
-        }
-        else if (primvarName == HdNukeTokens->uv) {
-            primvarName = HdNukeTokens->st;
-            role = HdPrimvarRoleTokens->textureCoordinate;
+        const TfToken attribName(attribCtx.name);
+        // Ignore displayColor for instances because otherwise
+        // our displayColor overrides the instancer's one.
+        if (attribName == HdNukeTokens->Cf && _isInstanced) {
+            continue;
         }
-        else if (primvarName == HdNukeTokens->N) {
-            primvarName = HdTokens->normals;
-            role = HdPrimvarRoleTokens->normal;
+        AttributePrimvar& primvar = attributePrimvars[attribIndex];
+        PrimvarForAttribute(attribName, &primvar.name, &primvar.role);
+        // Whitelisted names may be Nuke's as well as Hydra's.
+        primvar.wanted = requirements == nullptr
+                         || requirements->IsRequired(primvar.name)
+                         || requirements->IsRequired(attribName);
+    }
+
+    // Hashing the contents touches every attribute in full, so it gets the
+    // same treatment as the conversions below.
+    std::vector<HdNukeContentHash> contentHashes(attributes.size());
+    auto hashAttribute = [&](size_t attribIndex) {
+        if (attributePrimvars[attribIndex].wanted) {
+            contentHashes[attribIndex] =
+                AttributeContentHash(*attributes[attribIndex].attribute);
         }
-        else if (primvarName == HdNukeTokens->size) {
-            primvarName = HdTokens->widths;
-            haveVertexWidths = true;
+    };
+    if (parallel) {
+        tbb::parallel_for(size_t(0), attributes.size(), hashAttribute);
+    }
+    else {
+        for (size_t attribIndex = 0; attribIndex < attributes.size(); attribIndex++) {
+            hashAttribute(attribIndex);
         }
-        else if (primvarName == HdNukeTokens->PW) {
-            role = HdPrimvarRoleTokens->point;
+    }
+
+    std::vector<PrimvarConversion> conversions;
+    conversions.reserve(attributes.size());
+
+    for (size_t attribIndex = 0; attribIndex < attributes.size(); attribIndex++)
+    {
+        const auto& attribCtx = attributes[attribIndex];
+        if (attribCtx.empty()) {
+            continue;
         }
-        else if (primvarName == HdNukeTokens->vel) {
-            primvarName = HdTokens->velocities;
-            role = HdPrimvarRoleTokens->vector;
+
+        const AttributePrimvar& primvar = attributePrimvars[attribIndex];
+        if (!primvar.wanted) {
+            continue;
         }
-        else {
-            role = HdPrimvarRoleTokens->none;
+        const TfToken& primvarName = primvar.name;
+        const TfToken& role = primvar.role;
+        if (primvarName == HdTokens->widths) {
+            haveVertexWidths = true;
         }
 
+        HdInterpolation interpolation;
         switch (attribCtx.group) {
             case Group_Object:
-                _constantPrimvarDescriptors.emplace_back(
-                    primvarName, HdInterpolationConstant, role);
+                interpolation = HdInterpolationConstant;
                 break;
             case Group_Primitives:
-                _uniformPrimvarDescriptors.emplace_back(
-                    primvarName, HdInterpolationUniform, role);
+                interpolation = HdInterpolationUniform;
                 break;
             case Group_Points:
-                _vertexPrimvarDescriptors.emplace_back(
-                    primvarName, HdInterpolationVertex, role);
+                interpolation = HdInterpolationVertex;
                 break;
             case Group_Vertices:
-                _faceVaryingPrimvarDescriptors.emplace_back(
-                    primvarName, HdInterpolationFaceVarying, role);
+                interpolation = HdInterpolationFaceVarying;
                 break;
             default:
                 continue;
         }
+        _primvars.Add(primvarName, interpolation, role);
 
         // Store attribute data
         const Attribute& attribute = *attribCtx.attribute;
         const AttribType attrType = attribute.type();
 
-        // XXX: Special case for UVs. Nuke stores UVs as Vector4
-        // (homogeneous 3D coordinates), but USD/Hydra conventions stipulate Vec2f.
-        // Thus, we do type conversion in the case of a float vecter attr with
-        // width > 2, just to be nice.
-        if (primvarName == HdNukeTokens->st && attrType == VECTOR4_ATTRIB)
-        {
-            const auto size = attribute.size();
-            _uvs.resize(size);
-            float* outPtr = reinterpret_cast<float*>(_uvs.data());
-            for (size_t i = 0; i < size; i++) {
-                Vector4 uv = attribute.vector4(i).divide_w();
-                *outPtr++ = uv.x;
-                *outPtr++ = uv.y;
+        // Whether a face-varying attribute can be promoted also depends on
+        // the topology, so that is part of its state.
+        const bool promoteAttribute = promote && attribCtx.group == Group_Vertices;
+        HdNukeContentHash contentHash = contentHashes[attribIndex];
+        if (promoteAttribute) {
+            contentHash = HdNukeHashContent(&optional.topologyHash,
+                                            sizeof(HdNukeContentHash), contentHash);
+        }
+        // Same for point attributes and the weld map.
+        if (context.weldMap != nullptr && attribCtx.group == Group_Points) {
+            contentHash = HdNukeHashContent(&optional.weldMapHash,
+                                            sizeof(HdNukeContentHash), contentHash);
+        }
+
+        _AttributeState state{
+            attribute.array(), attribute.size(), attrType, attribCtx.group,
+            contentHash};
+
+        const bool isColors = primvarName == HdTokens->displayColor
+                              && attrType == VECTOR4_ATTRIB;
+
+        auto previousState = previousStates.find(primvarName);
+        if (previousState != previousStates.end()
+                && previousState->second == state) {
+            state.promoted = previousState->second.promoted;
+            attributeStates[primvarName] = state;
+            if (state.promoted) {
+                _primvars.SetInterpolation(primvarName, HdInterpolationVertex);
+            }
+
+            VtValue previous = previousPrimvars.TakeValue(primvarName);
+            if (!previous.IsEmpty()) {
+                _primvars.SetValue(primvarName, std::move(previous));
+                continue;
             }
-            continue;
         }
+        attributeStates[primvarName] = state;
+        dirtyPrimvars.push_back(primvarName);
 
-        // Cf is Vector4, but displayColor needs Vector3
-        if (primvarName == HdTokens->displayColor && attrType == VECTOR4_ATTRIB)
-        {
-            const auto size = attribute.size();
-            _colors.resize(size);
-            Vector4* dataPtr = static_cast<Vector4*>(attribute.array());
-            GfVec3f* outPtr = _colors.data();
-            for (size_t i = 0; i < size; i++, dataPtr++) {
-                *outPtr++ = GfVec3f(dataPtr->x, dataPtr->y, dataPtr->z);
+        PrimvarConversion::Kind kind = PrimvarConversion::General;
+        if (primvarName == HdNukeTokens->st && attrType == VECTOR4_ATTRIB) {
+            kind = PrimvarConversion::TextureCoordinates;
+        }
+        else if (isColors) {
+            kind = PrimvarConversion::Colors;
+        }
+        conversions.push_back({primvarName, &attribCtx, kind, promoteAttribute, false, contentHash, VtValue(),
+                               HdNukeBufferPool::Reference()});
+    }
+
+    // In lazy mode only the descriptors are worked out here, and the
+    // delegate converts the attributes it asks for on its sync threads.
+    // Whether a face-varying attribute can be promoted decides its
+    // interpolation, so those are still converted up front.
+    if (GetSharedState()->lazyPrimvars) {
+        auto& lazyPrimvars = _GetOptionalState().lazyPrimvars;
+        std::vector<PrimvarConversion> eagerConversions;
+        for (auto& conversion : conversions) {
+            if (conversion.promote) {
+                eagerConversions.push_back(std::move(conversion));
+                continue;
             }
-            _StorePrimvarArray(primvarName, VtValue(_colors));
-            continue;
+            auto lazyPrimvar = std::make_shared<HdNukeLazyPrimvar>();
+            lazyPrimvar->conversion = std::move(conversion);
+            lazyPrimvar->context = context;
+            lazyPrimvars[lazyPrimvar->conversion.name] = std::move(lazyPrimvar);
+        }
+        conversions.swap(eagerConversions);
+    }
+
+    // The conversions are independent of each other and only write to their
+    // own slot, so they can run concurrently.
+    auto convert = [&](PrimvarConversion& conversion) {
+        RunConversion(conversion, context);
+    };
+    if (parallel && conversions.size() > 1) {
+        tbb::task_group taskGroup;
+        for (auto& conversion : conversions) {
+            taskGroup.run([&convert, &conversion]() { convert(conversion); });
         }
+        taskGroup.wait();
+    }
+    else {
+        for (auto& conversion : conversions) {
+            convert(conversion);
+        }
+    }
 
-        // General-purpose attribute conversions
-        if (attribute.size() == 1) {
-            void* rawData = attribute.array();
-            float* floatData = static_cast<float*>(rawData);
+    // Buffers shared before sharing was turned off are let go as their
+    // primvars are converted again.
+    TfTokenMap<HdNukeBufferPool::Reference>* pooledPrimvars = nullptr;
+    if (shareBuffers || _optional) {
+        pooledPrimvars = &_GetOptionalState().pooledPrimvars;
+    }
 
-            switch (attrType) {
-                case FLOAT_ATTRIB:
-                    _StorePrimvarScalar(primvarName, floatData[0]);
-                    break;
-                case INT_ATTRIB:
-                    _StorePrimvarScalar(primvarName,
-                                        static_cast<int32_t*>(rawData)[0]);
-                    break;
-                case STRING_ATTRIB:
-                    _StorePrimvarScalar(primvarName,
-                                        std::string(static_cast<char**>(rawData)[0]));
-                    break;
-                case STD_STRING_ATTRIB:
-                    _StorePrimvarScalar(primvarName,
-                                        static_cast<std::string*>(rawData)[0]);
-                    break;
-                case VECTOR2_ATTRIB:
-                    _StorePrimvarScalar(primvarName, GfVec2f(floatData));
-                    break;
-                case VECTOR3_ATTRIB:
-                case NORMAL_ATTRIB:
-                    _StorePrimvarScalar(primvarName, GfVec3f(floatData));
-                    break;
-                case VECTOR4_ATTRIB:
-                    _StorePrimvarScalar(primvarName, GfVec4f(floatData));
-                    break;
-                case MATRIX3_ATTRIB:
-                    {
-                        GfMatrix3f gfMatrix;
-                        std::copy(floatData, floatData + 9, gfMatrix.data());
-                        _StorePrimvarScalar(primvarName, gfMatrix);
-                    }
-                    break;
-                case MATRIX4_ATTRIB:
-                    {
-                        GfMatrix4f gfMatrix;
-                        std::copy(floatData, floatData + 16, gfMatrix.data());
-                        _StorePrimvarScalar(primvarName, gfMatrix);
-                    }
-                    break;
-                default:
-                    TF_WARN("HdNukeGeoAdapter::_RebuildPrimvars : Unhandled "
-                            "attribute type: %d", attrType);
-                    continue;
-            }
+    // Merge the results in attribute order, so the outcome doesn't depend on
+    // the order the tasks finished in.
+    for (auto& conversion : conversions) {
+        if (conversion.result.IsEmpty()) {
+            continue;
         }
-        else {
-            switch (attrType) {
-                case FLOAT_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<float>(attribute));
-                    break;
-                case INT_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<int32_t>(attribute));
-                    break;
-                case VECTOR2_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<GfVec2f>(attribute));
-                    break;
-                case VECTOR3_ATTRIB:
-                case NORMAL_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<GfVec3f>(attribute));
-                    break;
-                case VECTOR4_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<GfVec4f>(attribute));
-                    break;
-                case MATRIX3_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<GfMatrix3f>(attribute));
-                    break;
-                case MATRIX4_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<GfMatrix4f>(attribute));
-                    break;
-                case STD_STRING_ATTRIB:
-                    _StorePrimvarArray(primvarName,
-                                       DDAttrToVtArrayValue<std::string>(attribute));
-                    break;
-                default:
-                    TF_WARN("HdNukeGeoAdapter::_RebuildPrimvars : Unhandled "
-                            "attribute type: %d", attrType);
-                    continue;
 
-                // XXX: Ignoring char* array attrs for now... not sure whether they
-                // need special-case handling.
-                // case STRING_ATTRIB:
-            }
+        if (conversion.promoted) {
+            _primvars.SetInterpolation(conversion.name, HdInterpolationVertex);
+            attributeStates[conversion.name].promoted = true;
         }
+        StoreConversion(conversion, _primvars, pooledPrimvars);
     }
 
     // Deal with Particles primitives default point size. We must only do this if we didn't have per-vertex sizes.
@@ -499,7 +1143,7 @@ HdNukeGeoAdapter::_RebuildPrimvars(const GeoInfo& geo)
     if (!haveVertexWidths) {
       const Primitive* firstPrim = geo.primitive(0);
       if (firstPrim != nullptr && firstPrim->getPrimitiveType() == eParticles && !_points.empty()) {
-        _constantPrimvarDescriptors.push_back(widthsColorDescriptor);
+        _primvars.Add(HdTokens->widths, HdInterpolationConstant, TfToken());
         // Use the first point to work out an approximate size. Maybe the centroid would be better.
         const GfVec3f& p = _points[0];
         const DD::Image::Vector3 point(p[0], p[1], p[2]);
@@ -508,15 +1152,32 @@ HdNukeGeoAdapter::_RebuildPrimvars(const GeoInfo& geo)
         const float width = v.length();
         DD::Image::Vector4 diameter = GetSharedState()->projMatrix.transform(DD::Image::Vector4(width, 0, eye.z, 1));
         const float screenPointSize = (diameter.x/diameter.w)*GetSharedState()->viewportHeight*0.5f;
-        _pointSize = GetRenderParticlesPointSize(firstPrim)/screenPointSize;
+        const float pointSize = GetRenderParticlesPointSize(firstPrim)/screenPointSize;
+        if (pointSize != _pointSize) {
+          _pointSize = pointSize;
+          dirtyPrimvars.push_back(HdTokens->widths);
+        }
       }
     }
 
-    if (_colors.size() == 0 && !_isInstanced) {
+    // Attributes that went away need to be dirtied as well.
+    for (const auto& previousState : previousStates) {
+        if (attributeStates.find(previousState.first) == attributeStates.end()) {
+            dirtyPrimvars.push_back(previousState.first);
+            if (pooledPrimvars != nullptr) {
+                pooledPrimvars->erase(previousState.first);
+            }
+        }
+    }
+
+    if (_primvars.Find(HdTokens->displayColor) == nullptr && !_isInstanced) {
       // We can't declare displayColor with two different interpolations, so only add it
-      // as constant if we didn't already add it as vertex interpolation.
-      _constantPrimvarDescriptors.push_back(displayColorDescriptor);
+      // as constant if we didn't already add it from an attribute.
+      _primvars.Add(HdTokens->displayColor, HdInterpolationConstant,
+                    HdPrimvarRoleTokens->color);
     }
+
+    _primvarLayoutChanged = !_primvars.HasSameLayout(previousPrimvars);
 }
 
 HdReprSelector
@@ -558,6 +1219,76 @@ HdNukeGeoAdapter::GetReprSelectorForGeo(const DD::Image::GeoInfo& geo) const
     }
 }
 
+TfToken
+HdNukeGeoAdapter::GetSubdivSchemeForGeo(const DD::Image::GeoInfo& geo) const
+{
+    return GetSubdivScheme(geo, GetSharedState()->subdivScheme);
+}
+
+TfToken
+HdNukeGeoAdapter::GetSubdivScheme(const DD::Image::GeoInfo& geo,
+                                  const TfToken& defaultScheme)
+{
+    // The source op or the geometry override the HydraRender default.
+    const std::string scheme = GetSubdivSchemeName(geo);
+    if (scheme.empty()) {
+        return defaultScheme;
+    }
+
+    const TfToken schemeToken(scheme);
+    if (schemeToken != PxOsdOpenSubdivTokens->none
+            && schemeToken != PxOsdOpenSubdivTokens->catmullClark
+            && schemeToken != PxOsdOpenSubdivTokens->loop
+            && schemeToken != PxOsdOpenSubdivTokens->bilinear) {
+        TF_WARN("HdNukeGeoAdapter: Unknown subdivision scheme '%s' on %s",
+                scheme.c_str(), geo.source_geo->node_name().c_str());
+        return defaultScheme;
+    }
+    return schemeToken;
+}
+
+HdNukeContentHash
+HdNukeGeoAdapter::GetContentFingerprint(const DD::Image::GeoInfo& geo)
+{
+    VtIntArray faceVertexCounts;
+    VtIntArray faceVertexIndices;
+    HdNukeMeshTopologyBuilder(geo).Build(faceVertexCounts, faceVertexIndices);
+
+    HdNukeContentHash hash = HdNukeHashContent(
+        faceVertexCounts.cdata(), faceVertexCounts.size() * sizeof(int));
+    hash = HdNukeHashContent(
+        faceVertexIndices.cdata(), faceVertexIndices.size() * sizeof(int), hash);
+
+    const std::string scheme = GetSubdivSchemeName(geo);
+    hash = HdNukeHashContent(scheme.data(), scheme.size(), hash);
+
+    const PointList* pointList = geo.point_list();
+    if (pointList != nullptr) {
+        hash = HdNukeHashContent(
+            pointList->data(), pointList->size() * sizeof(Vector3), hash);
+    }
+
+    for (const auto& attribCtx : geo.get_cache_pointer()->attributes) {
+        if (attribCtx.empty()) {
+            continue;
+        }
+        // The object colour of an instance comes from the instancer, so
+        // copies that only differ in colour can still share a prototype.
+        const std::string name(attribCtx.name);
+        if (attribCtx.group == Group_Object && name == HdNukeTokens->Cf.GetString()) {
+            continue;
+        }
+        const int layout[2] = {static_cast<int>(attribCtx.group),
+                               static_cast<int>(attribCtx.type)};
+        hash = HdNukeHashContent(name.data(), name.size(), hash);
+        const HdNukeContentHash contentHash =
+            AttributeContentHash(*attribCtx.attribute);
+        hash = HdNukeHashContent(layout, sizeof(layout), hash);
+        hash = HdNukeHashContent(&contentHash, sizeof(contentHash), hash);
+    }
+    return hash;
+}
+
 GfVec4f
 HdNukeGeoAdapter::GetWireframeColor(const DD::Image::GeoInfo& geo) const
 {
@@ -587,10 +1318,11 @@ HdNukeGeoAdapter::MakeParticleSprite()
   _points.push_back(pxr::GfVec3f( 0.5f,  0.5f, 0.0f));
   _points.push_back(pxr::GfVec3f( 0.5f, -0.5f, 0.0f));
 
-  _uvs.push_back(pxr::GfVec2f(0, 0));
-  _uvs.push_back(pxr::GfVec2f(0, 1));
-  _uvs.push_back(pxr::GfVec2f(1, 1));
-  _uvs.push_back(pxr::GfVec2f(1, 0));
+  VtVec2fArray uvs;
+  uvs.push_back(pxr::GfVec2f(0, 0));
+  uvs.push_back(pxr::GfVec2f(0, 1));
+  uvs.push_back(pxr::GfVec2f(1, 1));
+  uvs.push_back(pxr::GfVec2f(1, 0));
 
   VtIntArray faceVertexCounts;
   faceVertexCounts.push_back(4);
@@ -612,21 +1344,11 @@ HdNukeGeoAdapter::MakeParticleSprite()
 
   _transform.SetIdentity();
 
-  static HdPrimvarDescriptor pointsDescriptor(
-          HdTokens->points, HdInterpolationVertex,
-          HdPrimvarRoleTokens->point);
-  static HdPrimvarDescriptor uvsDescriptor(
-          HdNukeTokens->st, HdInterpolationVertex,
-          HdPrimvarRoleTokens->textureCoordinate);
-  static HdPrimvarDescriptor displayColorDescriptor(
-          HdTokens->displayColor, HdInterpolationConstant,
-          HdPrimvarRoleTokens->color);
-
-  _constantPrimvarDescriptors.clear();
-
-  _vertexPrimvarDescriptors.clear();
-  _vertexPrimvarDescriptors.push_back(pointsDescriptor);
-  _vertexPrimvarDescriptors.push_back(uvsDescriptor);
+  _primvars.Clear();
+  _primvars.Add(HdTokens->points, HdInterpolationVertex,
+                HdPrimvarRoleTokens->point);
+  _primvars.Add(HdNukeTokens->st, HdInterpolationVertex,
+                HdPrimvarRoleTokens->textureCoordinate, VtValue::Take(uvs));
 
   _displayColor = GfVec3f(1, 1, 1);
 }
@@ -705,24 +1427,43 @@ bool HdNukeGeoAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue& nukeD
         return false;
     }
 
+    // Geometry that starts out hidden isn't converted or added to the render
+    // index until it is first shown, as it may never be.
     _geoInfo = nukeData.UncheckedGet<GeoInfo*>();
+    _visible = false;
+    if (_IsShown(*_geoInfo)) {
+        _Convert(manager);
+    }
+    return true;
+}
+
+void HdNukeGeoAdapter::_Convert(HdNukeAdapterManager* manager)
+{
     GeoOp* sourceOp = op_cast<GeoOp*>(_geoInfo->final_geo);
     _hash = sourceOp->Op::hash();
+    _converted = true;
+    _pendingUpdateMask = 0;
+    _pendingSubdivScheme = false;
 
     auto sceneDelegate = manager->GetSceneDelegate();
     auto& renderIndex = sceneDelegate->GetRenderIndex();
     auto& changeTracker = renderIndex.GetChangeTracker();
 
     _SetMaterial(manager);
+    _UpdatePrimvarRequirements(manager);
 
     Update(*_geoInfo, HdChangeTracker::AllDirty, false);
-    if (GetVisible()) {
+    const bool chunked = _UpdateChunks(HdChangeTracker::AllDirty);
+    if (!chunked) {
         renderIndex.InsertRprim(GetPrimType(), sceneDelegate, GetPath());
     }
     else {
         renderIndex.RemoveRprim(GetPath());
     }
-    changeTracker.MarkRprimDirty(GetPath());
+    if (!chunked) {
+        _UpdateLod(changeTracker, HdChangeTracker::AllDirty);
+        changeTracker.MarkRprimDirty(GetPath());
+    }
 
     _castsShadow = _geoInfo->renderState.castShadow;
     if (!_castsShadow) {
@@ -734,7 +1475,7 @@ bool HdNukeGeoAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue& nukeD
 
     UpdateHashArray(sourceOp, _opStateHashes);
 
-    return true;
+    _RequestChunks(manager);
 }
 
 bool HdNukeGeoAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nukeData)
@@ -744,18 +1485,106 @@ bool HdNukeGeoAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nuke
         return false;
     }
     _geoInfo = nukeData.UncheckedGet<GeoInfo*>();
+    const bool shown = _IsShown(*_geoInfo);
+    if (!_converted) {
+        if (shown) {
+            _Convert(manager);
+        }
+        return true;
+    }
 
     auto sceneDelegate = manager->GetSceneDelegate();
     auto& renderIndex = sceneDelegate->GetRenderIndex();
     auto& changeTracker = renderIndex.GetChangeTracker();
     GeoOp* sourceOp = op_cast<GeoOp*>(_geoInfo->final_geo);
 
+    // Converted geometry stays in the render index while it's hidden, so
+    // showing it again only flips its visibility. Changes made while it is
+    // hidden are held back and converted together once it's shown.
     if (_hash != sourceOp->Op::hash()) {
-        auto dirtyBits = DirtyBitsFromUpdateMask(UpdateHashArray(sourceOp, _opStateHashes));
+        _pendingUpdateMask |= UpdateHashArray(sourceOp, _opStateHashes);
+        // Changing the subdivision scheme changes the op hash but none of
+        // the group hashes, so look for it separately.
+        if (GetPrimType() == HdPrimTypeTokens->mesh
+                && GetSubdivSchemeForGeo(*_geoInfo) != _subdivScheme) {
+            _pendingSubdivScheme = true;
+        }
+    }
+
+    // The material decides which attributes are converted, so look at it
+    // first, and convert the attributes again if what it reads changed.
+    _SetMaterial(manager);
+    if (_UpdatePrimvarRequirements(manager)) {
+        _pendingUpdateMask |= Mask_Attributes;
+    }
+
+    HdDirtyBits rebuiltBits = HdChangeTracker::Clean;
+    if (shown && (_pendingUpdateMask != 0 || _pendingSubdivScheme)) {
+        const uint32_t updateMask = _pendingUpdateMask;
+        _pendingUpdateMask = 0;
+        auto dirtyBits = DirtyBitsFromUpdateMask(updateMask);
+        if (_pendingSubdivScheme) {
+            dirtyBits |= HdChangeTracker::DirtyTopology;
+            _pendingSubdivScheme = false;
+        }
         Update(*_geoInfo, dirtyBits, false);
-        changeTracker.MarkRprimDirty(GetPath(), dirtyBits);
+        if ((dirtyBits & HdChangeTracker::DirtyTopology) && _displayStyleChanged) {
+            dirtyBits |= HdChangeTracker::DirtyDisplayStyle;
+        }
 
-        if (GetVisible()) {
+        // The update mask is coarse, so narrow the dirty bits down to the data
+        // the rebuild actually changed. If primvars were added or removed
+        // everything stays dirty, as hdStorm needs DirtyPoints to regenerate
+        // its shaders.
+        const bool primvarLayoutChanged =
+            (updateMask & Mask_Attributes) && _primvarLayoutChanged;
+        if (!primvarLayoutChanged) {
+            if (updateMask & Mask_Attributes) {
+                dirtyBits &= ~(HdChangeTracker::DirtyPrimvar
+                               | HdChangeTracker::DirtyNormals
+                               | HdChangeTracker::DirtyPoints
+                               | HdChangeTracker::DirtyWidths);
+                if (updateMask & Mask_Points) {
+                    dirtyBits |= HdChangeTracker::DirtyPoints;
+                }
+            }
+            if ((dirtyBits & HdChangeTracker::DirtyPoints) && !_pointsChanged) {
+                dirtyBits &= ~(HdChangeTracker::DirtyPoints
+                               | HdChangeTracker::DirtyExtent);
+            }
+            if ((dirtyBits & HdChangeTracker::DirtyTopology) && !_topologyChanged) {
+                dirtyBits &= ~HdChangeTracker::DirtyTopology;
+            }
+        }
+        const bool markPrimvars = !primvarLayoutChanged
+                                  && (updateMask & Mask_Attributes);
+        // Points moved along their velocities for motion blur change with
+        // them.
+        static const TfTokenVector sNoPrimvars;
+        const TfTokenVector& dirtyPrimvars =
+            _optional ? _optional->dirtyPrimvars : sNoPrimvars;
+        if (markPrimvars
+                && GetSharedState()->motionBlur == HdNukeMotionBlur::Velocity
+                && std::find(dirtyPrimvars.begin(), dirtyPrimvars.end(),
+                             HdTokens->velocities) != dirtyPrimvars.end()) {
+            dirtyBits |= HdChangeTracker::DirtyPoints;
+        }
+
+        // Chunks and LOD levels re-slice whole kinds of data, so
+        // individually dirtied primvars count as all of them.
+        rebuiltBits = dirtyBits | (markPrimvars && !dirtyPrimvars.empty()
+                                   ? HdChangeTracker::DirtyPrimvar
+                                   : HdChangeTracker::Clean);
+        const bool chunked = _UpdateChunks(rebuiltBits);
+        if (!chunked) {
+            if (markPrimvars) {
+                for (const auto& primvarName : dirtyPrimvars) {
+                    changeTracker.MarkPrimvarDirty(GetPath(), primvarName);
+                }
+            }
+            if (dirtyBits != HdChangeTracker::Clean) {
+                changeTracker.MarkRprimDirty(GetPath(), dirtyBits);
+            }
             renderIndex.InsertRprim(GetPrimType(), sceneDelegate, GetPath());
         }
         else {
@@ -763,8 +1592,22 @@ bool HdNukeGeoAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nuke
         }
     }
 
-    _SetMaterial(manager);
-    changeTracker.MarkRprimDirty(GetPath(), HdChangeTracker::DirtyMaterialId);
+    if (shown != _visible) {
+        _visible = shown;
+        if (!_IsChunked()) {
+            changeTracker.MarkRprimDirty(GetPath(), HdChangeTracker::DirtyVisibility);
+        }
+    }
+
+    // The level shown depends on the camera as well, so is picked on every
+    // update rather than only when the geometry changed.
+    if (!_IsChunked()) {
+        _UpdateLod(changeTracker, rebuiltBits);
+    }
+
+    if (!_IsChunked()) {
+        changeTracker.MarkRprimDirty(GetPath(), HdChangeTracker::DirtyMaterialId);
+    }
 
     if (!_castsShadow && _geoInfo->renderState.castShadow) {
         auto excludePaths = GetSharedState()->_shadowCollection.GetExcludePaths();
@@ -786,9 +1629,349 @@ bool HdNukeGeoAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nuke
     _castsShadow = _geoInfo->renderState.castShadow;
 
     _hash = sourceOp->Op::hash();
+    _RequestChunks(manager);
+    return true;
+}
+
+bool
+HdNukeGeoAdapter::_UpdateChunks(HdDirtyBits dirtyBits)
+{
+    const size_t faceBudget = GetSharedState()->chunkFaceBudget;
+    if (!GetSharedState()->chunkMeshes || GetPrimType() != HdPrimTypeTokens->mesh
+            || static_cast<size_t>(_topology.GetNumFaces()) <= faceBudget) {
+        if (_optional) {
+            _optional->chunks.clear();
+            _optional->chunkData.clear();
+        }
+        return false;
+    }
+
+    // The split only follows the topology, so animated points stay in the
+    // chunks they started in and only those chunks' points are dirtied.
+    _OptionalState& optional = _GetOptionalState();
+    std::vector<HdNukeMeshChunk>& chunks = optional.chunks;
+    auto& chunkData = optional.chunkData;
+    if ((dirtyBits & HdChangeTracker::DirtyTopology) || chunks.empty()) {
+        const VtIntArray& faceVertexCounts = _topology.GetFaceVertexCounts();
+        const VtIntArray& faceVertexIndices = _topology.GetFaceVertexIndices();
+        chunks = HdNukeBuildMeshChunks(
+            reinterpret_cast<const float*>(_points.cdata()), _points.size(),
+            faceVertexCounts.cdata(), faceVertexCounts.size(),
+            faceVertexIndices.cdata(), faceVertexIndices.size(), faceBudget);
+        chunkData.clear();
+        if (chunks.empty()) {
+            return false;
+        }
+    }
+
+    const HdDirtyBits primvarBits = HdChangeTracker::DirtyPrimvar
+                                    | HdChangeTracker::DirtyNormals
+                                    | HdChangeTracker::DirtyWidths;
+    const HdDirtyBits dataBits = HdChangeTracker::DirtyTopology
+                                 | HdChangeTracker::DirtyPoints
+                                 | HdChangeTracker::DirtyExtent
+                                 | primvarBits;
+    if (chunkData.size() == chunks.size() && !(dirtyBits & dataBits)) {
+        return true;
+    }
+    // Slicing reads all of the primvars.
+    _FinishLazyPrimvars(true);
+    if (chunkData.size() != chunks.size()) {
+        chunkData.assign(chunks.size(), nullptr);
+    }
+
+    auto sliceChunk = [&](size_t chunkIndex) {
+        const HdNukeMeshChunk& chunk = chunks[chunkIndex];
+        const auto& previous = chunkData[chunkIndex];
+        auto data = previous ? std::make_shared<HdNukeMeshChunkData>(*previous)
+                             : std::make_shared<HdNukeMeshChunkData>();
+        const HdDirtyBits chunkBits = previous ? dirtyBits & dataBits
+                                               : HdChangeTracker::AllDirty;
+        data->dirtyBits = chunkBits;
+
+        if (chunkBits & HdChangeTracker::DirtyTopology) {
+            data->topology = HdMeshTopology(
+                _subdivScheme, UsdGeomTokens->rightHanded,
+                ToVtIntArray(chunk.faceVertexCounts),
+                ToVtIntArray(chunk.faceVertexIndices));
+        }
+
+        if (chunkBits & (HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyExtent)) {
+            const VtValue points = SliceArrayValue(VtValue(_points), chunk.points);
+            data->points = points.IsHolding<VtVec3fArray>()
+                           ? points.UncheckedGet<VtVec3fArray>() : VtVec3fArray();
+            data->extent = GfRange3d();
+            for (const GfVec3f& point : data->points) {
+                data->extent.UnionWith(GfVec3d(point));
+            }
+        }
+
+        if (chunkBits & primvarBits) {
+            _GatherPrimvars(chunk.faces, chunk.points, chunk.faceVertices, *data);
+        }
+
+        chunkData[chunkIndex] = std::move(data);
+    };
+    if (GetSharedState()->parallelPrimvars) {
+        tbb::parallel_for(size_t(0), chunks.size(), sliceChunk);
+    }
+    else {
+        for (size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++) {
+            sliceChunk(chunkIndex);
+        }
+    }
     return true;
 }
 
+void
+HdNukeGeoAdapter::_RequestChunks(HdNukeAdapterManager* manager)
+{
+    // Chunks that aren't requested are removed at the end of the sync, which
+    // takes care of meshes that now have fewer chunks. Hidden meshes keep
+    // theirs, which follow the visibility of the mesh.
+    if (!_optional) {
+        return;
+    }
+    const auto& chunkData = _optional->chunkData;
+    for (size_t chunkIndex = 0; chunkIndex < chunkData.size(); chunkIndex++) {
+        const SdfPath chunkPath = GetPath().AppendChild(
+            TfToken(TfStringPrintf("chunk%zu", chunkIndex)));
+        manager->Request(HdNukeAdapterManagerPrimTypes->MeshChunk, chunkPath,
+                         VtValue(HdNukeMeshChunkSource{this, chunkData[chunkIndex]}));
+    }
+}
+
+void
+HdNukeGeoAdapter::_FinishLazyPrimvars(bool convertAll)
+{
+    if (!_optional || _optional->lazyPrimvars.empty()) {
+        return;
+    }
+    if (convertAll) {
+        std::vector<HdNukeLazyPrimvar*> lazyPrimvars;
+        for (auto& lazyPrimvar : _optional->lazyPrimvars) {
+            lazyPrimvars.push_back(lazyPrimvar.second.get());
+        }
+        tbb::parallel_for(size_t(0), lazyPrimvars.size(), [&](size_t i) {
+            lazyPrimvars[i]->Get();
+        });
+    }
+
+    for (auto& lazyPrimvar : _optional->lazyPrimvars) {
+        PrimvarConversion& conversion = lazyPrimvar.second->conversion;
+        if (!lazyPrimvar.second->converted) {
+            _optional->attributeStates.erase(lazyPrimvar.first);
+        }
+        else if (!conversion.result.IsEmpty()) {
+            StoreConversion(conversion, _primvars, &_optional->pooledPrimvars);
+        }
+    }
+    _optional->lazyPrimvars.clear();
+}
+
+void
+HdNukeGeoAdapter::_GatherPrimvars(const std::vector<int>& faces,
+                                  const std::vector<int>& points,
+                                  const std::vector<int>& faceVertices,
+                                  HdNukeMeshChunkData& data) const
+{
+    data.primvars = _primvars;
+    for (auto& primvar : data.primvars) {
+        if (primvar.value.IsEmpty()) {
+            continue;
+        }
+        switch (primvar.interpolation) {
+            case HdInterpolationUniform:
+                primvar.value = SliceArrayValue(primvar.value, faces);
+                break;
+            case HdInterpolationVertex:
+                primvar.value = SliceArrayValue(primvar.value, points);
+                break;
+            case HdInterpolationFaceVarying:
+                primvar.value = SliceArrayValue(primvar.value, faceVertices);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void
+HdNukeGeoAdapter::_UpdateLod(HdChangeTracker& changeTracker, HdDirtyBits dirtyBits)
+{
+    const AdapterSharedState* sharedState = GetSharedState();
+    const bool useLods = sharedState->interactive && sharedState->buildLods
+                         && !_IsChunked()
+                         && GetPrimType() == HdPrimTypeTokens->mesh
+                         && static_cast<size_t>(_topology.GetNumFaces())
+                            > sharedState->lodFaceThreshold;
+    // Without levels built before there is no level shown to take down.
+    if (!useLods && !_optional) {
+        return;
+    }
+    _OptionalState& optional = _GetOptionalState();
+    if (!useLods) {
+        optional.lods.clear();
+        optional.lodBuild.reset();
+        optional.lodHash = HdNukeContentHash();
+        optional.lodSourceHash = HdNukeContentHash();
+    }
+    else {
+        if ((dirtyBits & (HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyTopology))
+                || optional.lodSourceHash == HdNukeContentHash()) {
+            const VtIntArray& faceVertexCounts = _topology.GetFaceVertexCounts();
+            const VtIntArray& faceVertexIndices = _topology.GetFaceVertexIndices();
+            HdNukeContentHash hash = HdNukeHashContent(
+                faceVertexCounts.cdata(), faceVertexCounts.size() * sizeof(int));
+            hash = HdNukeHashContent(
+                faceVertexIndices.cdata(), faceVertexIndices.size() * sizeof(int), hash);
+            optional.lodSourceHash = HdNukeHashContent(
+                _points.cdata(), _points.size() * sizeof(GfVec3f), hash);
+        }
+
+        // Levels of points or topology that have since changed are no use,
+        // and neither is a build of them once it finishes. Only one build
+        // runs at a time, so animated meshes don't queue one per frame.
+        if (optional.lodHash != optional.lodSourceHash) {
+            optional.lods.clear();
+            if (optional.lodBuild
+                    && optional.lodBuild->done.load(std::memory_order_acquire)) {
+                if (optional.lodBuild->hash == optional.lodSourceHash) {
+                    for (auto& lod : optional.lodBuild->lods) {
+                        if (lod.GetFaceCount() > 0) {
+                            optional.lods.push_back(std::move(lod));
+                        }
+                    }
+                    optional.lodHash = optional.lodSourceHash;
+                }
+                optional.lodBuild.reset();
+            }
+            if (optional.lodHash != optional.lodSourceHash && !optional.lodBuild
+                    && _visible) {
+                _StartLodBuild();
+            }
+        }
+    }
+
+    const HdDirtyBits lodBits = HdChangeTracker::DirtyPoints
+                                | HdChangeTracker::DirtyTopology
+                                | HdChangeTracker::DirtyPrimvar
+                                | HdChangeTracker::DirtyNormals
+                                | HdChangeTracker::DirtyWidths;
+    const int level = _SelectLodLevel();
+    if (level == optional.lodLevel && (level < 0 || !(dirtyBits & lodBits))) {
+        return;
+    }
+
+    if (level >= 0) {
+        _FinishLazyPrimvars(true);
+        const HdNukeMeshLod& lod = optional.lods[level];
+        auto data = std::make_shared<HdNukeMeshChunkData>();
+        data->topology = HdMeshTopology(
+            _subdivScheme, UsdGeomTokens->rightHanded,
+            VtIntArray(lod.GetFaceCount(), 3), ToVtIntArray(lod.faceVertexIndices));
+        data->points.resize(lod.points.size() / 3);
+        std::copy(lod.points.begin(), lod.points.end(),
+                  reinterpret_cast<float*>(data->points.data()));
+        data->extent = _extent;
+        _GatherPrimvars(lod.faceSources, lod.pointSources, lod.faceVertexSources,
+                        *data);
+        optional.lodData = std::move(data);
+    }
+    else {
+        optional.lodData.reset();
+    }
+
+    // Changes to the data of the same level were already dirtied by the
+    // update that made them.
+    if (level != optional.lodLevel) {
+        changeTracker.MarkRprimDirty(GetPath(), lodBits);
+    }
+    optional.lodLevel = level;
+}
+
+void
+HdNukeGeoAdapter::_StartLodBuild()
+{
+    // The points may be Nuke's own memory, which can change under a build
+    // running in the background, so the build gets a copy.
+    _OptionalState& optional = _GetOptionalState();
+    auto build = std::make_shared<HdNukeMeshLodBuild>();
+    build->hash = optional.lodSourceHash;
+    const float* points = reinterpret_cast<const float*>(_points.cdata());
+    build->points.assign(points, points + _points.size() * 3);
+    const VtIntArray& faceVertexCounts = _topology.GetFaceVertexCounts();
+    const VtIntArray& faceVertexIndices = _topology.GetFaceVertexIndices();
+    build->faceVertexCounts.assign(faceVertexCounts.begin(), faceVertexCounts.end());
+    build->faceVertexIndices.assign(faceVertexIndices.begin(), faceVertexIndices.end());
+
+    // Levels are counted in triangles, which each face is fanned into.
+    const size_t numTriangles = faceVertexIndices.size()
+                                - std::min(faceVertexIndices.size(),
+                                           2 * faceVertexCounts.size());
+    for (size_t reduction : kLodReductions) {
+        build->targetFaces.push_back(numTriangles / reduction);
+    }
+
+    optional.lodBuild = build;
+    LodArena().enqueue([build]() {
+        build->lods = HdNukeBuildMeshLods(
+            build->points.data(), build->points.size() / 3,
+            build->faceVertexCounts.data(), build->faceVertexCounts.size(),
+            build->faceVertexIndices.data(), build->faceVertexIndices.size(),
+            build->targetFaces);
+        build->done.store(true, std::memory_order_release);
+    });
+}
+
+int
+HdNukeGeoAdapter::_SelectLodLevel() const
+{
+    if (!_optional || _optional->lods.empty()) {
+        return -1;
+    }
+    const std::vector<HdNukeMeshLod>& lods = _optional->lods;
+
+    // Project a sphere around the bounds of the mesh to the screen, and use
+    // the coarsest level that still has enough faces to cover it.
+    const AdapterSharedState* sharedState = GetSharedState();
+    const GfRange3d bounds = GfBBox3d(_extent, _transform).ComputeAlignedRange();
+    const GfVec3d center = bounds.GetMidpoint();
+    const float radius = static_cast<float>(0.5 * bounds.GetSize().GetLength());
+    const Vector3 eye = sharedState->modelView.transform(
+        Vector3(center[0], center[1], center[2]));
+    if (eye.length() <= radius) {
+        return -1;
+    }
+    const Vector4 edge = sharedState->projMatrix.transform(
+        Vector4(radius, 0, eye.z, 1));
+    if (edge.w <= 0.0f) {
+        // Behind the camera.
+        return static_cast<int>(lods.size()) - 1;
+    }
+    const double screenRadius =
+        std::abs(edge.x / edge.w) * sharedState->viewportHeight * 0.5;
+    // The square around the sphere on screen.
+    const double faces = 4.0 * screenRadius * screenRadius / kPixelsPerLodFace;
+
+    int level = -1;
+    for (size_t i = 0; i < lods.size(); i++) {
+        if (static_cast<double>(lods[i].GetFaceCount()) >= faces) {
+            level = static_cast<int>(i);
+        }
+    }
+    return level;
+}
+
+bool
+HdNukeGeoAdapter::_IsShown(const GeoInfo& geo) const
+{
+    if (GetSharedState()->interactive) {
+        return geo.display3d != DISPLAY_OFF;
+    }
+    return geo.render_mode != RENDER_OFF;
+}
+
 void HdNukeGeoAdapter::TearDown(HdNukeAdapterManager* manager)
 {
     auto sceneDelegate = manager->GetSceneDelegate();
@@ -802,6 +1985,7 @@ void HdNukeGeoAdapter::_SetMaterial(HdNukeAdapterManager* manager)
         auto sceneDelegate = manager->GetSceneDelegate();
         auto promise = manager->Request(TfToken{"defaultParticleMaterialId"}, sceneDelegate->DefaultParticleMaterialId());
         _materialId = promise->path;
+        _materialHandle = promise->handle;
     }
     else if (auto material = materialOpForGeo(_geoInfo)) {
         HdMaterialNetworkMap materialNetwork;
@@ -815,7 +1999,96 @@ void HdNukeGeoAdapter::_SetMaterial(HdNukeAdapterManager* manager)
 
         auto promise = manager->Request(materialContext);
         _materialId = promise->path;
+        _materialHandle = promise->handle;
+    }
+}
+
+VtValue
+HdNukeGeoAdapter::GetMotionPoints(const VtVec3fArray& points) const
+{
+    if (_IsChunked() || _GetLodData()) {
+        return VtValue();
+    }
+    if (!_optional || _optional->weldMap.IsEmpty()) {
+        return points.size() == _points.size() ? VtValue(points) : VtValue();
+    }
+    const HdNukeWeldMap& weldMap = _optional->weldMap;
+    if (points.size() != weldMap.pointRemap.size()) {
+        return VtValue();
+    }
+    VtVec3fArray weldedPoints(weldMap.GetWeldedPointCount());
+    HdNukeGatherPointValues(points.cdata(), sizeof(GfVec3f),
+                            weldMap.representatives, weldedPoints.data());
+    return VtValue::Take(weldedPoints);
+}
+
+VtValue
+HdNukeGeoAdapter::GetVelocityPoints(float time) const
+{
+    if (_IsChunked() || _GetLodData()) {
+        return VtValue();
+    }
+    const VtValue velocities = Get(HdTokens->velocities);
+    if (!velocities.IsHolding<VtVec3fArray>()) {
+        return VtValue();
     }
+    const VtVec3fArray& pointVelocities = velocities.UncheckedGet<VtVec3fArray>();
+    if (pointVelocities.size() != _points.size()) {
+        return VtValue();
+    }
+
+    VtVec3fArray points(_points.size());
+    const GfVec3f* position = _points.cdata();
+    const GfVec3f* velocity = pointVelocities.cdata();
+    GfVec3f* movedPoint = points.data();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size()),
+                      [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i != range.end(); i++) {
+            movedPoint[i] = position[i] + velocity[i] * time;
+        }
+    });
+    return VtValue::Take(points);
+}
+
+bool
+HdNukeGeoAdapter::_UpdatePrimvarRequirements(HdNukeAdapterManager* manager)
+{
+    HdNukePrimvarRequirements requirements;
+    bool filterPrimvars = GetSharedState()->filterPrimvars;
+    if (filterPrimvars) {
+        requirements.AddPatterns(GetSharedState()->primvarWhitelist);
+        // Motion blur from velocities reads them whatever the material does.
+        if (GetSharedState()->motionBlur == HdNukeMotionBlur::Velocity) {
+            requirements.AddPrimvar(HdTokens->velocities);
+        }
+        // Nothing can be left out until the material's network is known.
+        if (!_materialId.IsEmpty()) {
+            // The handle no longer finds the material if it was set up again.
+            HdNukeAdapterPtr material = manager->GetAdapter(_materialHandle);
+            if (!material) {
+                _materialHandle = manager->GetHandle(_materialId);
+                material = manager->GetAdapter(_materialHandle);
+            }
+            const VtValue network = material
+                ? material->Get(HdNukeTokens->materialResource) : VtValue();
+            if (network.IsHolding<HdMaterialNetworkMap>()) {
+                requirements.AddMaterial(network.UncheckedGet<HdMaterialNetworkMap>());
+            }
+            else {
+                filterPrimvars = false;
+            }
+        }
+    }
+
+    const bool filteredPrimvars = _optional && _optional->filterPrimvars;
+    if (filterPrimvars == filteredPrimvars
+            && (!filterPrimvars || requirements == _optional->primvarRequirements)) {
+        return false;
+    }
+    _OptionalState& optional = _GetOptionalState();
+    optional.filterPrimvars = filterPrimvars;
+    optional.primvarRequirements = std::move(requirements);
+    return true;
 }
 
 class GeoAdapterCreator : public HdNukeAdapterFactory::AdapterCreator { public:
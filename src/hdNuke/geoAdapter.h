@@ -24,17 +24,24 @@
 #include <DDImage/GeoInfo.h>
 
 #include "adapter.h"
+#include "contentHash.h"
+#include "primvarTable.h"
+#include "slotMap.h"
 #include "types.h"
 
+#include <memory>
+
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+struct HdNukeMeshChunkData;
+
 
 class HdNukeGeoAdapter : public HdNukeAdapter
 {
 public:
     HdNukeGeoAdapter(AdapterSharedState* statePtr);
-    ~HdNukeGeoAdapter() override { }
+    ~HdNukeGeoAdapter() override;
 
     void Update(const DD::Image::GeoInfo& geo, HdDirtyBits dirtyBits,
                 bool isInstanced);
@@ -47,6 +54,8 @@ public:
 
     inline HdMeshTopology GetMeshTopology() const { return _topology; }
 
+    inline HdDisplayStyle GetDisplayStyle() const { return _displayStyle; }
+
     VtValue Get(const TfToken& key) const override;
 
     const TfToken& GetPrimType() const override;
@@ -56,6 +65,17 @@ public:
 
     HdReprSelector GetReprSelector() const;
 
+    //! Returns a hash of the faces, points and attributes of \p geo. GeoInfos
+    //! with the same fingerprint convert to the same prim apart from their
+    //! transform and object colour, so can be drawn as instances of one.
+    static HdNukeContentHash GetContentFingerprint(const DD::Image::GeoInfo& geo);
+
+    //! Returns the subdivision scheme named by the source op or the
+    //! attributes of \p geo, or \p defaultScheme if they name none or one
+    //! that isn't known.
+    static TfToken GetSubdivScheme(const DD::Image::GeoInfo& geo,
+                                   const TfToken& defaultScheme);
+
     //! Makes an adapter for an imaginary unit card at the origin. This is used
     //! as a prototype for instancing particle sprites.
     void MakeParticleSprite();
@@ -63,55 +83,145 @@ public:
     //! Set if this geo is being used as a instancer prototype
     void SetIsInstanced(bool isInstanced);
 
+    //! Returns the points of the prim at another time for motion blur, given
+    //! Nuke's points of the geometry at that time. Returns an empty value
+    //! when they don't match the prim, as when the number of points changed
+    //! or the prim is split into chunks or showing a decimated level.
+    VtValue GetMotionPoints(const VtVec3fArray& points) const;
+
+    //! Returns the points of the prim moved along their velocities for
+    //! \p time frames, or an empty value if there are no velocities per point.
+    VtValue GetVelocityPoints(float time) const;
+
     bool SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
     bool Update(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
     void TearDown(HdNukeAdapterManager* manager) override;
 
 protected:
+    friend class HdNukeMeshChunkAdapter;
+
+    // The state of lazy and filtered primvars, shared buffers, welding,
+    // chunking and LOD. Most adapters use none of them, so it is only made,
+    // by _GetOptionalState, when one is first used.
+    struct _OptionalState;
+    _OptionalState& _GetOptionalState();
+
+    // Converts the geometry in full and adds it to the render index, the
+    // first time it is shown.
+    void _Convert(HdNukeAdapterManager* manager);
+    // Whether the geometry is drawn in the current mode.
+    bool _IsShown(const DD::Image::GeoInfo& geo) const;
+
     void _RebuildPointList(const DD::Image::GeoInfo& geo);
     void _RebuildPrimvars(const DD::Image::GeoInfo& geo);
+    // Moves the primvars converted by the delegate in lazy mode in with the
+    // others, after converting the rest if convertAll is set.
+    void _FinishLazyPrimvars(bool convertAll);
     void _RebuildMeshTopology(const DD::Image::GeoInfo& geo);
+    void _WeldPoints(const DD::Image::GeoInfo& geo,
+                     const VtIntArray& faceVertexCounts,
+                     VtIntArray& faceVertexIndices);
     virtual void _SetMaterial(HdNukeAdapterManager* manager);
-
-    template <typename T>
-    inline void _StorePrimvarScalar(TfToken& key, const T& value) {
-        _primvarData.emplace(key, VtValue(value));
-    }
-
-    inline void _StorePrimvarArray(TfToken& key, VtValue&& array) {
-        _primvarData.emplace(key, std::move(array));
-    }
+    // Works out which primvars the material and the whitelist need when
+    // primvar filtering is on. Returns whether that changed.
+    bool _UpdatePrimvarRequirements(HdNukeAdapterManager* manager);
+
+    // Splits the mesh into chunks when chunking is on and it is over the face
+    // budget, slicing the data dirtied by dirtyBits out for each chunk.
+    // Returns whether the mesh is shown as chunks rather than as a whole.
+    bool _UpdateChunks(HdDirtyBits dirtyBits);
+    void _RequestChunks(HdNukeAdapterManager* manager);
+
+    // Gathers the primvars of the mesh at the given faces, points and face
+    // vertices into data, according to their interpolation.
+    void _GatherPrimvars(const std::vector<int>& faces,
+                         const std::vector<int>& points,
+                         const std::vector<int>& faceVertices,
+                         HdNukeMeshChunkData& data) const;
+
+    // In interactive mode, shows a decimated level of a mesh over the LOD
+    // face threshold in its place when it is small enough on screen. The
+    // levels are built in the background, and used from the first update
+    // after they are ready. dirtyBits are the data the update rebuilt.
+    void _UpdateLod(HdChangeTracker& changeTracker, HdDirtyBits dirtyBits);
+    void _StartLodBuild();
+    int _SelectLodLevel() const;
+
+    // Whether the mesh is shown as chunks rather than as a whole.
+    bool _IsChunked() const;
+    // The data of the LOD level shown, or nullptr if the mesh is shown in
+    // full.
+    const HdNukeMeshChunkData* _GetLodData() const;
 
     HdReprSelector GetReprSelectorForGeo(const DD::Image::GeoInfo& geo) const;
     GfVec4f GetWireframeColor(const DD::Image::GeoInfo& geo) const;
+    TfToken GetSubdivSchemeForGeo(const DD::Image::GeoInfo& geo) const;
 
+    // Members are grouped by alignment, largest first, so the adapter has
+    // as little padding as possible; geoAdapterTest checks its size.
     GfMatrix4d _transform;
     GfRange3d _extent;
-    bool _visible = true;
 
     VtVec3fArray _points;
-    VtVec2fArray _uvs;
-    VtVec3fArray _colors;
 
     HdMeshTopology _topology;
-
-    HdPrimvarDescriptorVector _constantPrimvarDescriptors;
-    HdPrimvarDescriptorVector _uniformPrimvarDescriptors;
-    HdPrimvarDescriptorVector _vertexPrimvarDescriptors;
-    HdPrimvarDescriptorVector _faceVaryingPrimvarDescriptors;
-
-    TfTokenMap<VtValue> _primvarData;
+    TfToken _subdivScheme;
+
+    // The primvars of every interpolation and their converted data, apart
+    // from those worked out when asked for, like the points.
+    HdNukePrimvarTable _primvars;
+
+    // What an attribute looked like when it was last converted.
+    struct _AttributeState
+    {
+        const void* data;
+        size_t size;
+        DD::Image::AttribType type;
+        DD::Image::GroupType group;
+        HdNukeContentHash contentHash;
+        // Whether a face-varying attribute was stored per point. Follows from
+        // the rest, so isn't compared.
+        bool promoted = false;
+
+        bool operator==(const _AttributeState& other) const
+        {
+            return data == other.data && size == other.size
+                   && type == other.type && group == other.group
+                   && contentHash == other.contentHash;
+        }
+    };
+
+    // Null until the adapter first uses one of the optional features or
+    // tracks changes to its contents.
+    std::unique_ptr<_OptionalState> _optional;
 
     HdReprSelector _reprSelector;
+    DD::Image::GeoInfo* _geoInfo;
+    SdfPath _materialId;
+    DD::Image::Hash _hash;
+    GeoOpHashArray _opStateHashes;
+
+    HdDisplayStyle _displayStyle;
     GfVec4f _wireframeColor;
     GfVec3f _displayColor;
     float _pointSize = 1.0f;
+    HdNukeSlotHandle _materialHandle;
+    // The changes to the geometry, subdivision scheme included, that haven't
+    // been converted as it was hidden.
+    uint32_t _pendingUpdateMask = 0;
+    bool _pendingSubdivScheme = false;
+    // Whether the geometry has been converted since it was set up.
+    bool _converted = false;
+
+    bool _visible = true;
     bool _isInstanced = false;
-    DD::Image::GeoInfo* _geoInfo;
-    SdfPath _materialId;
-    DD::Image::Hash _hash;
     bool _castsShadow;
-    GeoOpHashArray _opStateHashes;
+    bool _displayStyleChanged = false;
+    // Whether the last rebuild of the points, topology and primvars actually
+    // changed them, and whether it changed the set of primvar descriptors.
+    bool _pointsChanged = false;
+    bool _topologyChanged = false;
+    bool _primvarLayoutChanged = false;
 };
 
 using HdNukeGeoAdapterPtr = std::shared_ptr<HdNukeGeoAdapter>;
@@ -0,0 +1,396 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "geoBatchAdapter.h"
+
+#include "adapterFactory.h"
+#include "adapterManager.h"
+#include "conversionKernels.h"
+#include "meshTopology.h"
+#include "sceneDelegate.h"
+#include "tokens.h"
+#include "utils.h"
+
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/imaging/hd/tokens.h>
+
+#include <DDImage/GeoOp.h>
+
+#include <tbb/parallel_for.h>
+
+#include <vector>
+
+using namespace DD::Image;
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace
+{
+    // The geometry of one member, in world space.
+    struct MemberGeometry
+    {
+        VtIntArray faceVertexCounts;
+        VtIntArray faceVertexIndices;
+        std::vector<GfVec3f> points;
+        // Per face vertex, or empty if the member doesn't have them.
+        std::vector<GfVec2f> uvs;
+        std::vector<GfVec3f> normals;
+        std::vector<GfVec3f> colors;
+    };
+
+    // Finds a face-varying, vertex or constant attribute, returning its
+    // values for the face vertices of the member in values. faceVertexSources
+    // gives the face vertex of the GeoInfo each face vertex of the member
+    // came from.
+    template <typename T>
+    bool GetFaceVertexValues(const GeoInfo& geo, const char* name,
+                             AttribType type, const VtIntArray& faceVertexIndices,
+                             const std::vector<size_t>& faceVertexSources,
+                             std::vector<T>& values)
+    {
+        for (GroupType group : {Group_Vertices, Group_Points, Group_Object}) {
+            const AttribContext* context =
+                geo.get_typed_group_attribcontext(group, name, type);
+            if (context == nullptr || context->empty() || !context->attribute) {
+                continue;
+            }
+            const Attribute& attribute = *context->attribute;
+            const T* data = static_cast<const T*>(attribute.array());
+            values.resize(faceVertexIndices.size());
+            for (size_t i = 0; i < faceVertexIndices.size(); i++) {
+                const size_t index = group == Group_Object ? 0
+                                     : group == Group_Vertices ? faceVertexSources[i]
+                                     : static_cast<size_t>(faceVertexIndices[i]);
+                if (index >= attribute.size()) {
+                    values.clear();
+                    return false;
+                }
+                values[i] = data[index];
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void ConvertMember(const GeoInfo& geo, MemberGeometry& member)
+    {
+        // A member without points has nothing to draw, and any faces it has
+        // couldn't refer to anything, so it's left out.
+        const PointList* pointList = geo.point_list();
+        const size_t numPoints = pointList != nullptr ? pointList->size() : 0;
+        if (numPoints == 0) {
+            return;
+        }
+
+        VtIntArray faceVertexCounts;
+        VtIntArray faceVertexIndices;
+        HdNukeMeshTopologyBuilder(geo).Build(faceVertexCounts, faceVertexIndices);
+
+        // Drop faces that refer to points that don't exist rather than read
+        // past the point list, keeping track of where the face vertices that
+        // are left came from.
+        std::vector<size_t> faceVertexSources;
+        faceVertexSources.reserve(faceVertexIndices.size());
+        member.faceVertexIndices.reserve(faceVertexIndices.size());
+        size_t faceStart = 0;
+        for (const int count : faceVertexCounts) {
+            const size_t faceEnd = faceStart + static_cast<size_t>(count);
+            bool valid = faceEnd <= faceVertexIndices.size();
+            for (size_t i = faceStart; valid && i < faceEnd; i++) {
+                valid = faceVertexIndices[i] >= 0
+                        && static_cast<size_t>(faceVertexIndices[i]) < numPoints;
+            }
+            if (valid) {
+                member.faceVertexCounts.push_back(count);
+                for (size_t i = faceStart; i < faceEnd; i++) {
+                    member.faceVertexIndices.push_back(faceVertexIndices[i]);
+                    faceVertexSources.push_back(i);
+                }
+            }
+            faceStart = faceEnd;
+        }
+
+        member.points.resize(numPoints);
+        for (size_t i = 0; i < numPoints; i++) {
+            const Vector3 point = geo.matrix.transform((*pointList)[i]);
+            member.points[i].Set(point.x, point.y, point.z);
+        }
+
+        std::vector<Vector4> uvs;
+        if (GetFaceVertexValues(geo, HdNukeTokens->uv.GetText(), VECTOR4_ATTRIB,
+                                member.faceVertexIndices, faceVertexSources,
+                                uvs)) {
+            member.uvs.resize(uvs.size());
+            HdNukeConversionKernels::Get().homogeneousToVec2f(
+                reinterpret_cast<const float*>(uvs.data()),
+                reinterpret_cast<float*>(member.uvs.data()), uvs.size());
+        }
+
+        std::vector<Vector3> normals;
+        if (GetFaceVertexValues(geo, HdNukeTokens->N.GetText(), NORMAL_ATTRIB,
+                                member.faceVertexIndices, faceVertexSources,
+                                normals)) {
+            // Normals take the inverse transpose of the matrix.
+            const Matrix4 inverse = geo.matrix.inverse();
+            member.normals.resize(normals.size());
+            for (size_t i = 0; i < normals.size(); i++) {
+                Vector3 normal = inverse.ntransform(normals[i]);
+                normal.normalize();
+                member.normals[i].Set(normal.x, normal.y, normal.z);
+            }
+        }
+
+        std::vector<Vector4> colors;
+        if (GetFaceVertexValues(geo, HdNukeTokens->Cf.GetText(), VECTOR4_ATTRIB,
+                                member.faceVertexIndices, faceVertexSources,
+                                colors)) {
+            member.colors.resize(colors.size());
+            HdNukeConversionKernels::Get().vec4fToVec3f(
+                reinterpret_cast<const float*>(colors.data()),
+                reinterpret_cast<float*>(member.colors.data()), colors.size());
+        }
+    }
+}
+
+bool HdNukeGeoBatchAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!TF_VERIFY(nukeData.IsHolding<GeoInfoVector>(),
+          "HdNukeGeoBatchAdapter expects a GeoInfoVector")) {
+        return false;
+    }
+    const auto& members = nukeData.UncheckedGet<GeoInfoVector>();
+    if (members.empty()) {
+        return false;
+    }
+
+    auto sceneDelegate = manager->GetSceneDelegate();
+    auto& renderIndex = sceneDelegate->GetRenderIndex();
+
+    _Rebuild(manager, members);
+    _SetMaterial(manager);
+    renderIndex.InsertRprim(GetPrimType(), sceneDelegate, GetPath());
+    renderIndex.GetChangeTracker().MarkRprimDirty(GetPath());
+
+    // Shadow casting is part of what members are batched by, so it can't
+    // change for the lifetime of the batch.
+    if (!members.front()->renderState.castShadow) {
+        auto excludePaths = GetSharedState()->_shadowCollection.GetExcludePaths();
+        excludePaths.push_back(GetPath());
+        GetSharedState()->_shadowCollection.SetExcludePaths(excludePaths);
+        renderIndex.GetChangeTracker().AddCollection(HdNukeTokens->shadowCollection);
+    }
+    return true;
+}
+
+bool HdNukeGeoBatchAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!TF_VERIFY(nukeData.IsHolding<GeoInfoVector>(),
+          "HdNukeGeoBatchAdapter expects a GeoInfoVector")) {
+        return false;
+    }
+    const auto& members = nukeData.UncheckedGet<GeoInfoVector>();
+    if (members.empty()) {
+        return false;
+    }
+
+    auto& changeTracker =
+        manager->GetSceneDelegate()->GetRenderIndex().GetChangeTracker();
+    if (_Rebuild(manager, members)) {
+        changeTracker.MarkRprimDirty(GetPath(),
+                                     HdChangeTracker::DirtyPoints
+                                     | HdChangeTracker::DirtyExtent
+                                     | HdChangeTracker::DirtyTopology
+                                     | HdChangeTracker::DirtyPrimvar
+                                     | HdChangeTracker::DirtyNormals
+                                     | HdChangeTracker::DirtyRepr);
+    }
+
+    _SetMaterial(manager);
+    changeTracker.MarkRprimDirty(GetPath(), HdChangeTracker::DirtyMaterialId);
+    return true;
+}
+
+const TfToken& HdNukeGeoBatchAdapter::GetPrimType() const
+{
+    return HdPrimTypeTokens->mesh;
+}
+
+bool
+HdNukeGeoBatchAdapter::_Rebuild(HdNukeAdapterManager* manager,
+                                const GeoInfoVector& members)
+{
+    _geoInfo = members.front();
+
+    // Members are identified by their paths and changes by their op hash
+    // and matrix, the same as for adapters of single GeoInfos.
+    HdNukeSceneDelegate* sceneDelegate = manager->GetSceneDelegate();
+    HdNukeContentHash membersHash = HdNukeHashContent(nullptr, 0, members.size());
+    for (const GeoInfo* geo : members) {
+        const uint64_t hashes[] = {
+            sceneDelegate->GetGeoInfoPath(*geo).GetHash(),
+            geo->final_geo->Op::hash().value()
+        };
+        membersHash = HdNukeHashContent(hashes, sizeof(hashes), membersHash);
+        membersHash = HdNukeHashContent(geo->matrix.array(), 16 * sizeof(float),
+                                        membersHash);
+    }
+    if (membersHash == _membersHash && !_points.empty()) {
+        return false;
+    }
+    _membersHash = membersHash;
+
+    std::vector<MemberGeometry> geometry(members.size());
+    tbb::parallel_for(size_t(0), members.size(), [&](size_t memberIndex) {
+        ConvertMember(*members[memberIndex], geometry[memberIndex]);
+    });
+
+    size_t numFaces = 0;
+    size_t numFaceVertices = 0;
+    size_t numPoints = 0;
+    bool haveUvs = false;
+    bool haveNormals = true;
+    bool haveColors = false;
+    for (const auto& member : geometry) {
+        if (member.faceVertexIndices.empty()) {
+            continue;
+        }
+        numFaces += member.faceVertexCounts.size();
+        numFaceVertices += member.faceVertexIndices.size();
+        numPoints += member.points.size();
+        haveUvs |= !member.uvs.empty();
+        haveNormals &= !member.normals.empty();
+        haveColors |= !member.colors.empty();
+    }
+
+    VtIntArray faceVertexCounts(numFaces);
+    VtIntArray faceVertexIndices(numFaceVertices);
+    VtIntArray memberIds(numFaces);
+    VtStringArray memberPaths(members.size());
+    _points = VtVec3fArray(numPoints);
+    VtVec2fArray uvs = haveUvs ? VtVec2fArray(numFaceVertices) : VtVec2fArray();
+    VtVec3fArray normals = haveNormals ? VtVec3fArray(numFaceVertices)
+                                       : VtVec3fArray();
+    VtVec3fArray colors = haveColors ? VtVec3fArray(numFaceVertices)
+                                     : VtVec3fArray();
+    _displayColor = GetSharedState()->defaultDisplayColor;
+
+    size_t faceOffset = 0;
+    size_t faceVertexOffset = 0;
+    size_t pointOffset = 0;
+    for (size_t memberIndex = 0; memberIndex < members.size(); memberIndex++) {
+        const MemberGeometry& member = geometry[memberIndex];
+        const GeoInfo& geo = *members[memberIndex];
+
+        memberPaths[memberIndex] = sceneDelegate->GetGeoInfoPath(geo).GetString();
+        if (member.faceVertexIndices.empty()) {
+            continue;
+        }
+
+        std::copy(member.faceVertexCounts.cbegin(), member.faceVertexCounts.cend(),
+                  faceVertexCounts.data() + faceOffset);
+        std::fill_n(memberIds.data() + faceOffset, member.faceVertexCounts.size(),
+                    static_cast<int>(memberIndex));
+        for (size_t i = 0; i < member.faceVertexIndices.size(); i++) {
+            faceVertexIndices[faceVertexOffset + i] =
+                member.faceVertexIndices[i] + static_cast<int>(pointOffset);
+        }
+        std::copy(member.points.begin(), member.points.end(),
+                  _points.data() + pointOffset);
+        if (!member.uvs.empty()) {
+            std::copy(member.uvs.begin(), member.uvs.end(),
+                      uvs.data() + faceVertexOffset);
+        }
+        else if (haveUvs) {
+            std::fill_n(uvs.data() + faceVertexOffset,
+                        member.faceVertexIndices.size(), GfVec2f(0.0f));
+        }
+        if (haveNormals) {
+            std::copy(member.normals.begin(), member.normals.end(),
+                      normals.data() + faceVertexOffset);
+        }
+        // Members without colours show the default colour, as they would on
+        // their own.
+        if (!member.colors.empty()) {
+            std::copy(member.colors.begin(), member.colors.end(),
+                      colors.data() + faceVertexOffset);
+        }
+        else if (haveColors) {
+            std::fill_n(colors.data() + faceVertexOffset,
+                        member.faceVertexIndices.size(), _displayColor);
+        }
+
+        faceOffset += member.faceVertexCounts.size();
+        faceVertexOffset += member.faceVertexIndices.size();
+        pointOffset += member.points.size();
+    }
+
+    // The subdivision scheme is part of what members are batched by, so
+    // they all share it.
+    _subdivScheme = GetSubdivSchemeForGeo(*_geoInfo);
+    _topology = HdMeshTopology(_subdivScheme,
+                               UsdGeomTokens->rightHanded, faceVertexCounts,
+                               faceVertexIndices);
+    const int refineLevel = _subdivScheme == PxOsdOpenSubdivTokens->none
+                            ? 0 : GetSharedState()->subdivRefineLevel;
+    _displayStyle = HdDisplayStyle(refineLevel);
+
+    _extent = GfRange3d();
+    for (const GfVec3f& point : _points) {
+        _extent.UnionWith(GfVec3d(point));
+    }
+    _transform.SetIdentity();
+    _reprSelector = GetReprSelectorForGeo(*_geoInfo);
+    _wireframeColor = GetWireframeColor(*_geoInfo);
+
+    _primvars.Clear();
+    _primvars.Add(HdNukeTokens->overrideWireframeColor, HdInterpolationConstant,
+                  HdNukeTokens->overrideWireframeColor);
+    if (haveColors) {
+        _primvars.Add(HdTokens->displayColor, HdInterpolationFaceVarying,
+                      HdPrimvarRoleTokens->color, VtValue::Take(colors));
+    }
+    else {
+        _primvars.Add(HdTokens->displayColor, HdInterpolationConstant,
+                      HdPrimvarRoleTokens->color);
+    }
+    _primvars.Add(HdNukeTokens->batchMemberPaths, HdInterpolationConstant,
+                  TfToken(), VtValue::Take(memberPaths));
+    _primvars.Add(HdNukeTokens->batchMemberId, HdInterpolationUniform,
+                  TfToken(), VtValue::Take(memberIds));
+    _primvars.Add(HdTokens->points, HdInterpolationVertex,
+                  HdPrimvarRoleTokens->point);
+    if (haveUvs) {
+        _primvars.Add(HdNukeTokens->st, HdInterpolationFaceVarying,
+                      HdPrimvarRoleTokens->textureCoordinate, VtValue::Take(uvs));
+    }
+    if (haveNormals) {
+        _primvars.Add(HdTokens->normals, HdInterpolationFaceVarying,
+                      HdPrimvarRoleTokens->normal, VtValue::Take(normals));
+    }
+    return true;
+}
+
+class GeoBatchAdapterCreator : public HdNukeAdapterFactory::AdapterCreator {
+public:
+    HdNukeAdapterPtr Create(AdapterSharedState *sharedState) override
+    {
+        return std::make_shared<HdNukeGeoBatchAdapter>(sharedState);
+    }
+};
+
+static const AdapterRegister<GeoBatchAdapterCreator> sRegisterGeoBatchCreator(HdNukeAdapterManagerPrimTypes->GeoBatch);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
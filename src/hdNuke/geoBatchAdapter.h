@@ -0,0 +1,64 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_GEOBATCHADAPTER_H
+#define HDNUKE_GEOBATCHADAPTER_H
+
+#include <pxr/pxr.h>
+
+#include "contentHash.h"
+#include "geoAdapter.h"
+#include "types.h"
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Shows a set of small, static meshes as a single merged mesh.
+///
+/// Set up and updated with a GeoInfoVector of the members, which should all
+/// use the same material and display mode. Points and normals are moved into
+/// world space and the topologies offset, so the batch itself has an
+/// identity transform. The batch is only rebuilt when the set of members or
+/// one of their hashes changes.
+///
+/// Besides points, normals, texture coordinates and colours, the batch
+/// carries a uniform batchMemberId primvar with the index of the member each
+/// face came from and a constant batchMemberPaths primvar with the paths the
+/// members would have had as rprims of their own, for picking and
+/// debugging. Other attributes of the members aren't carried over, and
+/// members without points are left out.
+class HdNukeGeoBatchAdapter : public HdNukeGeoAdapter
+{
+public:
+    HdNukeGeoBatchAdapter(AdapterSharedState* statePtr)
+        : HdNukeGeoAdapter(statePtr) { }
+    ~HdNukeGeoBatchAdapter() override { }
+
+    bool SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    bool Update(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    const TfToken& GetPrimType() const override;
+
+private:
+    // Rebuilds the merged mesh if the members changed, returning whether it
+    // did.
+    bool _Rebuild(HdNukeAdapterManager* manager, const GeoInfoVector& members);
+
+    HdNukeContentHash _membersHash;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_GEOBATCHADAPTER_H
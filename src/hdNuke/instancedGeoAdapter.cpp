@@ -80,4 +80,58 @@ public:
 
 static const AdapterRegister<InstancedGeoAdapterCreator> sRegisterInstancedGeoCreator(HdNukeAdapterManagerPrimTypes->InstancedGeo);
 
+bool HdNukeDuplicateGeoAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!HdNukeInstancedGeoAdapter::SetUp(manager, nukeData)) {
+        return false;
+    }
+    _fingerprint = manager->GetSceneDelegate()->GetContentFingerprint(*_geoInfo);
+    _SetMaterial(manager);
+    return true;
+}
+
+bool HdNukeDuplicateGeoAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!HdNukeInstancedGeoAdapter::Update(manager, nukeData)) {
+        return false;
+    }
+    auto sceneDelegate = manager->GetSceneDelegate();
+    auto& changeTracker = sceneDelegate->GetRenderIndex().GetChangeTracker();
+
+    // The copies keep this prototype while their content changes together,
+    // which can happen downstream of the source geometry, so follow the
+    // content of the first copy.
+    const HdNukeContentHash fingerprint = sceneDelegate->GetContentFingerprint(*_geoInfo);
+    if (fingerprint != _fingerprint) {
+        _fingerprint = fingerprint;
+        const HdDirtyBits dirtyBits = HdChangeTracker::DirtyPoints
+                                      | HdChangeTracker::DirtyExtent
+                                      | HdChangeTracker::DirtyTopology
+                                      | HdChangeTracker::DirtyNormals
+                                      | HdChangeTracker::DirtyWidths
+                                      | HdChangeTracker::DirtyPrimvar;
+        HdNukeGeoAdapter::Update(*_geoInfo, dirtyBits, true);
+        changeTracker.MarkRprimDirty(GetPath(), dirtyBits);
+    }
+
+    _SetMaterial(manager);
+    changeTracker.MarkRprimDirty(GetPath(), HdChangeTracker::DirtyMaterialId);
+    return true;
+}
+
+const TfToken& HdNukeDuplicateGeoAdapter::GetPrimType() const
+{
+    return HdNukeGeoAdapter::GetPrimType();
+}
+
+class DuplicateGeoAdapterCreator : public HdNukeAdapterFactory::AdapterCreator {
+public:
+    HdNukeAdapterPtr Create(AdapterSharedState *sharedState) override
+    {
+        return std::make_shared<HdNukeDuplicateGeoAdapter>(sharedState);
+    }
+};
+
+static const AdapterRegister<DuplicateGeoAdapterCreator> sRegisterDuplicateGeoCreator(HdNukeAdapterManagerPrimTypes->DuplicateGeo);
+
 PXR_NAMESPACE_CLOSE_SCOPE
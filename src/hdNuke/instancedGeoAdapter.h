@@ -31,6 +31,24 @@ private:
     DD::Image::Hash _hash;
 };
 
+/// The prototype of a set of GeoInfos from any ops that have the same
+/// content fingerprint. Unlike GeoInfos sharing a source id, these are drawn
+/// with their own prim type and material rather than as points.
+class HdNukeDuplicateGeoAdapter : public HdNukeInstancedGeoAdapter
+{
+public:
+    HdNukeDuplicateGeoAdapter(AdapterSharedState* statePtr)
+        : HdNukeInstancedGeoAdapter(statePtr) { }
+    ~HdNukeDuplicateGeoAdapter() override { }
+
+    bool SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    bool Update(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    const TfToken& GetPrimType() const override;
+
+private:
+    HdNukeContentHash _fingerprint;
+};
+
 PXR_NAMESPACE_CLOSE_SCOPE
 
 #endif  // HDNUKE_INSTANCEDGEOADAPTER_H
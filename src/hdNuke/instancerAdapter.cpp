@@ -16,6 +16,7 @@
 #include <pxr/base/gf/rotation.h>
 
 #include "instancerAdapter.h"
+#include "conversionKernels.h"
 #include "adapterFactory.h"
 #include "adapterManager.h"
 #include "sceneDelegate.h"
@@ -143,15 +144,23 @@ HdNukeInstancerAdapter::UpdateParticles(const DD::Image::GeoInfo& geoInfo)
             );
 
             _instanceXforms[i] = billboardMatrix;
+        }
 
-            if (cf != nullptr ) {
-                const DD::Image::Vector4& color = cf[i];
-                _colors[i] = GfVec3f(color.x, color.y, color.z);
-            }
+        if (cf != nullptr ) {
+            HdNukeConversionKernels::Get().vec4fToVec3f(
+                reinterpret_cast<const float*>(cf),
+                reinterpret_cast<float*>(_colors.data()), count);
         }
     }
 }
 
+void
+HdNukeInstancerAdapter::Update(const HdNukeInstanceData& instanceData)
+{
+    _instanceXforms = instanceData.transforms;
+    _colors = instanceData.colors;
+}
+
 VtValue
 HdNukeInstancerAdapter::Get(const TfToken& key) const
 {
@@ -182,6 +191,9 @@ bool HdNukeInstancerAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue&
         auto geoInfoVector = nukeData.UncheckedGet<GeoInfoVector>();
         Update(geoInfoVector);
     }
+    else if (nukeData.IsHolding<HdNukeInstanceData>()) {
+        Update(nukeData.UncheckedGet<HdNukeInstanceData>());
+    }
 
     renderIndex.InsertInstancer(sceneDelegate, GetPath());
     return true;
@@ -195,42 +207,44 @@ bool HdNukeInstancerAdapter::Update(HdNukeAdapterManager* manager, const VtValue
 
     if (nukeData.IsHolding<DD::Image::GeoInfo*>()) {
         auto geoInfo = nukeData.UncheckedGet<DD::Image::GeoInfo*>();
-        // Work round an hdStorm bug causing a crash if the number of instances changes.
-        // Destroy the existing instancer and create a new one.
         const DD::Image::PointList* pointList = geoInfo->point_list();
         if (pointList != nullptr) {
-            const auto count = pointList->size();
-            if (InstanceCount() != count) {
-                SdfPath parentPath = GetPath().GetParentPath();
-                renderIndex.RemoveRprim(parentPath);
-                renderIndex.RemoveInstancer(GetPath());
-                renderIndex.InsertInstancer(sceneDelegate, GetPath());
-                renderIndex.InsertRprim(HdPrimTypeTokens->mesh, sceneDelegate, parentPath, GetPath());
-            }
+            _RecreateIfCountChanged(manager, pointList->size());
         }
 
         UpdateParticles(*geoInfo);
     }
     else if (nukeData.IsHolding<GeoInfoVector>()) {
         auto geoInfoVector = nukeData.UncheckedGet<GeoInfoVector>();
-        // Work round an hdStorm bug causing a crash if the number of instances changes.
-        // Destroy the existing instancer and create a new one.
-        const auto count = geoInfoVector.size();
-        if (InstanceCount() != count) {
-            SdfPath parentPath = GetPath().GetParentPath();
-            renderIndex.RemoveRprim(parentPath);
-            renderIndex.RemoveInstancer(GetPath());
-            renderIndex.InsertInstancer(sceneDelegate, GetPath());
-            renderIndex.InsertRprim(HdPrimTypeTokens->mesh, sceneDelegate, parentPath, GetPath());
-        }
+        _RecreateIfCountChanged(manager, geoInfoVector.size());
 
         Update(geoInfoVector);
     }
+    else if (nukeData.IsHolding<HdNukeInstanceData>()) {
+        const auto& instanceData = nukeData.UncheckedGet<HdNukeInstanceData>();
+        _RecreateIfCountChanged(manager, instanceData.transforms.size());
+
+        Update(instanceData);
+    }
 
     changeTracker.MarkInstancerDirty(GetPath());
     return true;
 }
 
+void HdNukeInstancerAdapter::_RecreateIfCountChanged(HdNukeAdapterManager* manager, size_t count)
+{
+    if (InstanceCount() == count) {
+        return;
+    }
+    auto sceneDelegate = manager->GetSceneDelegate();
+    auto& renderIndex = sceneDelegate->GetRenderIndex();
+    SdfPath parentPath = GetPath().GetParentPath();
+    renderIndex.RemoveRprim(parentPath);
+    renderIndex.RemoveInstancer(GetPath());
+    renderIndex.InsertInstancer(sceneDelegate, GetPath());
+    renderIndex.InsertRprim(HdPrimTypeTokens->mesh, sceneDelegate, parentPath, GetPath());
+}
+
 void HdNukeInstancerAdapter::TearDown(HdNukeAdapterManager* manager)
 {
     auto sceneDelegate = manager->GetSceneDelegate();
@@ -28,6 +28,19 @@
 PXR_NAMESPACE_OPEN_SCOPE
 
 
+/// Instance transforms and colours worked out by the prototype's adapter,
+/// for instancers whose instances aren't GeoInfos or particles.
+struct HdNukeInstanceData
+{
+    VtMatrix4dArray transforms;
+    VtVec3fArray colors;
+
+    bool operator==(const HdNukeInstanceData& other) const
+    {
+        return transforms == other.transforms && colors == other.colors;
+    }
+};
+
 class HdNukeInstancerAdapter : public HdNukeAdapter
 {
 public:
@@ -37,6 +50,7 @@ public:
 
     void Update(const GeoInfoVector& geoInfoPtrs);
     void UpdateParticles(const DD::Image::GeoInfo& geoInfo);
+    void Update(const HdNukeInstanceData& instanceData);
 
     VtValue Get(const TfToken& key) const override;
 
@@ -48,6 +62,11 @@ public:
     bool Update(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
     void TearDown(HdNukeAdapterManager* manager) override;
 private:
+    // Works round an hdStorm bug causing a crash if the number of instances
+    // changes, by destroying the instancer and its prototype and creating
+    // them again.
+    void _RecreateIfCountChanged(HdNukeAdapterManager* manager, size_t count);
+
     VtMatrix4dArray _instanceXforms;
     VtVec3fArray _colors;
 };
@@ -0,0 +1,139 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "meshChunkAdapter.h"
+
+#include "adapterFactory.h"
+#include "adapterManager.h"
+#include "sceneDelegate.h"
+
+#include <pxr/imaging/hd/tokens.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+HdNukeMeshChunkAdapter::HdNukeMeshChunkAdapter(AdapterSharedState* statePtr)
+    : HdNukeGeoAdapter(statePtr)
+{
+    _geoInfo = nullptr;
+}
+
+bool HdNukeMeshChunkAdapter::SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!TF_VERIFY(nukeData.IsHolding<HdNukeMeshChunkSource>(),
+          "HdNukeMeshChunkAdapter expects a HdNukeMeshChunkSource")) {
+        return false;
+    }
+
+    auto sceneDelegate = manager->GetSceneDelegate();
+    auto& renderIndex = sceneDelegate->GetRenderIndex();
+
+    _Sync(nukeData.UncheckedGet<HdNukeMeshChunkSource>());
+    renderIndex.InsertRprim(GetPrimType(), sceneDelegate, GetPath());
+    renderIndex.GetChangeTracker().MarkRprimDirty(GetPath());
+    return true;
+}
+
+bool HdNukeMeshChunkAdapter::Update(HdNukeAdapterManager* manager, const VtValue& nukeData)
+{
+    if (!TF_VERIFY(nukeData.IsHolding<HdNukeMeshChunkSource>(),
+          "HdNukeMeshChunkAdapter expects a HdNukeMeshChunkSource")) {
+        return false;
+    }
+
+    const HdDirtyBits dirtyBits =
+        _Sync(nukeData.UncheckedGet<HdNukeMeshChunkSource>());
+    if (dirtyBits != HdChangeTracker::Clean) {
+        auto& changeTracker =
+            manager->GetSceneDelegate()->GetRenderIndex().GetChangeTracker();
+        changeTracker.MarkRprimDirty(GetPath(), dirtyBits);
+    }
+    return true;
+}
+
+const TfToken& HdNukeMeshChunkAdapter::GetPrimType() const
+{
+    return HdPrimTypeTokens->mesh;
+}
+
+HdDirtyBits
+HdNukeMeshChunkAdapter::_Sync(const HdNukeMeshChunkSource& source)
+{
+    HdDirtyBits dirtyBits = HdChangeTracker::Clean;
+    bool primvarLayoutChanged = false;
+    if (source.data != _data && source.data) {
+        dirtyBits |= source.data->dirtyBits;
+        _data = source.data;
+        _topology = _data->topology;
+        _points = _data->points;
+        _extent = _data->extent;
+        // The descriptors come along with the data, so note whether they
+        // differ from the ones in use.
+        primvarLayoutChanged = !_primvars.HasSameLayout(_data->primvars);
+        _primvars = _data->primvars;
+    }
+
+    const HdNukeGeoAdapter& mesh = *source.mesh;
+    if (mesh._visible != _visible) {
+        _visible = mesh._visible;
+        dirtyBits |= HdChangeTracker::DirtyVisibility;
+    }
+    if (mesh._transform != _transform) {
+        _transform = mesh._transform;
+        dirtyBits |= HdChangeTracker::DirtyTransform;
+    }
+    if (!(mesh._reprSelector == _reprSelector)) {
+        _reprSelector = mesh._reprSelector;
+        dirtyBits |= HdChangeTracker::DirtyRepr;
+    }
+    if (!(mesh._displayStyle == _displayStyle)) {
+        _displayStyle = mesh._displayStyle;
+        dirtyBits |= HdChangeTracker::DirtyDisplayStyle;
+    }
+    if (mesh._materialId != _materialId) {
+        _materialId = mesh._materialId;
+        dirtyBits |= HdChangeTracker::DirtyMaterialId;
+    }
+    if (mesh._wireframeColor != _wireframeColor
+            || mesh._displayColor != _displayColor) {
+        _wireframeColor = mesh._wireframeColor;
+        _displayColor = mesh._displayColor;
+        dirtyBits |= HdChangeTracker::DirtyPrimvar;
+    }
+
+    // hdStorm needs DirtyPoints to regenerate its shaders when the set of
+    // primvars changes, the same as for whole meshes.
+    if (!_primvars.HasSameLayout(mesh._primvars)) {
+        _primvars.SetLayout(mesh._primvars);
+        primvarLayoutChanged = true;
+    }
+    if (primvarLayoutChanged) {
+        dirtyBits |= HdChangeTracker::DirtyPrimvar | HdChangeTracker::DirtyPoints;
+    }
+    return dirtyBits;
+}
+
+class MeshChunkAdapterCreator : public HdNukeAdapterFactory::AdapterCreator {
+public:
+    HdNukeAdapterPtr Create(AdapterSharedState *sharedState) override
+    {
+        return std::make_shared<HdNukeMeshChunkAdapter>(sharedState);
+    }
+};
+
+static const AdapterRegister<MeshChunkAdapterCreator> sRegisterMeshChunkCreator(HdNukeAdapterManagerPrimTypes->MeshChunk);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
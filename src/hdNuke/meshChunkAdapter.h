@@ -0,0 +1,84 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_MESHCHUNKADAPTER_H
+#define HDNUKE_MESHCHUNKADAPTER_H
+
+#include <pxr/pxr.h>
+
+#include <pxr/base/gf/range3d.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/imaging/hd/changeTracker.h>
+#include <pxr/imaging/hd/meshTopology.h>
+
+#include "geoAdapter.h"
+
+#include <memory>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// The converted data of one chunk of a mesh, sliced out of the data of the
+/// whole mesh by its HdNukeGeoAdapter.
+struct HdNukeMeshChunkData
+{
+    HdMeshTopology topology;
+    VtVec3fArray points;
+    GfRange3d extent;
+    HdNukePrimvarTable primvars;
+
+    // What changed since the previous data of the same chunk.
+    HdDirtyBits dirtyBits = HdChangeTracker::AllDirty;
+};
+
+using HdNukeMeshChunkDataPtr = std::shared_ptr<const HdNukeMeshChunkData>;
+
+/// What a HdNukeMeshChunkAdapter is set up and updated with.
+struct HdNukeMeshChunkSource
+{
+    const HdNukeGeoAdapter* mesh = nullptr;
+    HdNukeMeshChunkDataPtr data;
+
+    bool operator==(const HdNukeMeshChunkSource& other) const
+    {
+        return mesh == other.mesh && data == other.data;
+    }
+};
+
+/// Shows one chunk of a mesh that was split up by its HdNukeGeoAdapter.
+///
+/// The chunk takes its geometry from the data it is given and everything
+/// else, such as the transform and material, from the adapter of the whole
+/// mesh. Only the parts that changed are dirtied.
+class HdNukeMeshChunkAdapter : public HdNukeGeoAdapter
+{
+public:
+    HdNukeMeshChunkAdapter(AdapterSharedState* statePtr);
+    ~HdNukeMeshChunkAdapter() override { }
+
+    bool SetUp(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    bool Update(HdNukeAdapterManager* manager, const VtValue& nukeData) override;
+    const TfToken& GetPrimType() const override;
+
+private:
+    HdDirtyBits _Sync(const HdNukeMeshChunkSource& source);
+
+    HdNukeMeshChunkDataPtr _data;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_MESHCHUNKADAPTER_H
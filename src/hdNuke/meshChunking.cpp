@@ -0,0 +1,197 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "meshChunking.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    constexpr size_t kGrainSize = 4096;
+
+    // Bits of each axis in a Morton code, leaving the low 32 bits of the sort
+    // key for the face index.
+    constexpr int kMortonBits = 10;
+
+    struct Bounds
+    {
+        float min[3] = {std::numeric_limits<float>::max(),
+                        std::numeric_limits<float>::max(),
+                        std::numeric_limits<float>::max()};
+        float max[3] = {std::numeric_limits<float>::lowest(),
+                        std::numeric_limits<float>::lowest(),
+                        std::numeric_limits<float>::lowest()};
+
+        void Extend(const float* point)
+        {
+            for (int axis = 0; axis < 3; axis++) {
+                min[axis] = std::min(min[axis], point[axis]);
+                max[axis] = std::max(max[axis], point[axis]);
+            }
+        }
+
+        void Extend(const Bounds& other)
+        {
+            Extend(other.min);
+            Extend(other.max);
+        }
+    };
+
+    // Spreads the low 10 bits of value out to every third bit.
+    uint32_t SpreadBits(uint32_t value)
+    {
+        value &= 0x3ff;
+        value = (value | (value << 16)) & 0x030000ff;
+        value = (value | (value << 8)) & 0x0300f00f;
+        value = (value | (value << 4)) & 0x030c30c3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+
+    uint32_t Quantize(float value, float min, float scale)
+    {
+        const float cell = (value - min) * scale;
+        const float maxCell = static_cast<float>((1 << kMortonBits) - 1);
+        return static_cast<uint32_t>(std::min(std::max(cell, 0.0f), maxCell));
+    }
+}
+
+std::vector<HdNukeMeshChunk>
+HdNukeBuildMeshChunks(const float* points, size_t numPoints,
+                      const int* faceVertexCounts, size_t numFaces,
+                      const int* faceVertexIndices, size_t numFaceVertices,
+                      size_t faceBudget)
+{
+    std::vector<HdNukeMeshChunk> chunks;
+    if (faceBudget == 0 || numFaces <= faceBudget
+            || numFaces > std::numeric_limits<uint32_t>::max()) {
+        return chunks;
+    }
+
+    std::vector<size_t> faceOffsets(numFaces + 1);
+    for (size_t face = 0; face < numFaces; face++) {
+        if (faceVertexCounts[face] < 0) {
+            return chunks;
+        }
+        faceOffsets[face + 1] = faceOffsets[face] + faceVertexCounts[face];
+    }
+    if (faceOffsets[numFaces] != numFaceVertices) {
+        return chunks;
+    }
+    for (size_t i = 0; i < numFaceVertices; i++) {
+        if (faceVertexIndices[i] < 0
+                || static_cast<size_t>(faceVertexIndices[i]) >= numPoints) {
+            return chunks;
+        }
+    }
+
+    const Bounds bounds = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, numPoints, kGrainSize), Bounds(),
+        [points](const tbb::blocked_range<size_t>& range, Bounds bounds) {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                bounds.Extend(points + i * 3);
+            }
+            return bounds;
+        },
+        [](Bounds bounds, const Bounds& other) {
+            bounds.Extend(other);
+            return bounds;
+        });
+
+    float scale[3];
+    for (int axis = 0; axis < 3; axis++) {
+        const float size = bounds.max[axis] - bounds.min[axis];
+        scale[axis] = size > 0.0f ? (1 << kMortonBits) / size : 0.0f;
+    }
+
+    // Sort the faces by the Morton code of their centroid, with the face
+    // index in the low bits to keep the order deterministic.
+    std::vector<uint64_t> keys(numFaces);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numFaces, kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t face = range.begin(); face != range.end(); face++) {
+                float centroid[3] = {0.0f, 0.0f, 0.0f};
+                const size_t begin = faceOffsets[face];
+                const size_t end = faceOffsets[face + 1];
+                for (size_t i = begin; i < end; i++) {
+                    const float* point = points + faceVertexIndices[i] * 3;
+                    centroid[0] += point[0];
+                    centroid[1] += point[1];
+                    centroid[2] += point[2];
+                }
+                uint32_t code = 0;
+                if (end > begin) {
+                    const float weight = 1.0f / static_cast<float>(end - begin);
+                    for (int axis = 0; axis < 3; axis++) {
+                        code |= SpreadBits(Quantize(centroid[axis] * weight,
+                                                    bounds.min[axis],
+                                                    scale[axis])) << axis;
+                    }
+                }
+                keys[face] = (static_cast<uint64_t>(code) << 32) | face;
+            }
+        });
+    tbb::parallel_sort(keys.begin(), keys.end());
+
+    const size_t numChunks = (numFaces + faceBudget - 1) / faceBudget;
+    chunks.resize(numChunks);
+    tbb::parallel_for(size_t(0), numChunks, [&](size_t chunkIndex) {
+        HdNukeMeshChunk& chunk = chunks[chunkIndex];
+        const size_t begin = chunkIndex * numFaces / numChunks;
+        const size_t end = (chunkIndex + 1) * numFaces / numChunks;
+
+        chunk.faces.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            chunk.faces.push_back(static_cast<int>(keys[i] & 0xffffffff));
+        }
+        std::sort(chunk.faces.begin(), chunk.faces.end());
+
+        chunk.faceVertexCounts.reserve(chunk.faces.size());
+        for (int face : chunk.faces) {
+            chunk.faceVertexCounts.push_back(faceVertexCounts[face]);
+            for (size_t i = faceOffsets[face]; i < faceOffsets[face + 1]; i++) {
+                chunk.faceVertices.push_back(static_cast<int>(i));
+                chunk.points.push_back(faceVertexIndices[i]);
+            }
+        }
+        std::sort(chunk.points.begin(), chunk.points.end());
+        chunk.points.erase(std::unique(chunk.points.begin(), chunk.points.end()),
+                           chunk.points.end());
+
+        chunk.faceVertexIndices.reserve(chunk.faceVertices.size());
+        for (int faceVertex : chunk.faceVertices) {
+            const auto point = std::lower_bound(
+                chunk.points.begin(), chunk.points.end(),
+                faceVertexIndices[faceVertex]);
+            chunk.faceVertexIndices.push_back(
+                static_cast<int>(point - chunk.points.begin()));
+        }
+    });
+
+    return chunks;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,62 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_MESHCHUNKING_H
+#define HDNUKE_MESHCHUNKING_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A spatially coherent part of a mesh that is shown as an rprim of its own.
+struct HdNukeMeshChunk
+{
+    /// The faces of the mesh in the chunk, in their original order.
+    std::vector<int> faces;
+
+    /// The points used by those faces, ascending. Point i of the chunk is
+    /// point points[i] of the mesh.
+    std::vector<int> points;
+
+    /// The face vertex of the mesh each face vertex of the chunk comes from.
+    std::vector<int> faceVertices;
+
+    /// The topology of the chunk, indexing its own points.
+    std::vector<int> faceVertexCounts;
+    std::vector<int> faceVertexIndices;
+};
+
+/// Splits a mesh into chunks of at most \p faceBudget faces each.
+///
+/// Faces are ordered along a Morton curve through the bounding box of the
+/// \p numPoints points at \p points, given as three floats each, and cut
+/// into equally sized runs, so each chunk covers a compact region of space.
+///
+/// Returns no chunks if the mesh fits the budget or its topology refers to
+/// points that don't exist, in which case it should be shown whole.
+std::vector<HdNukeMeshChunk>
+HdNukeBuildMeshChunks(const float* points, size_t numPoints,
+                      const int* faceVertexCounts, size_t numFaces,
+                      const int* faceVertexIndices, size_t numFaceVertices,
+                      size_t faceBudget);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_MESHCHUNKING_H
@@ -0,0 +1,533 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "meshDecimation.h"
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    // How much more the planes through open boundaries count than the faces
+    // next to them.
+    constexpr double kBoundaryWeight = 100.0;
+
+    struct Vec3
+    {
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+
+        Vec3() = default;
+        Vec3(double x_, double y_, double z_) : x(x_), y(y_), z(z_) { }
+
+        Vec3 operator+(const Vec3& o) const { return Vec3(x + o.x, y + o.y, z + o.z); }
+        Vec3 operator-(const Vec3& o) const { return Vec3(x - o.x, y - o.y, z - o.z); }
+        Vec3 operator*(double s) const { return Vec3(x * s, y * s, z * s); }
+        double Dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+        Vec3 Cross(const Vec3& o) const
+        {
+            return Vec3(y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x);
+        }
+        double Length() const { return std::sqrt(Dot(*this)); }
+    };
+
+    // The symmetric 4x4 matrix summing the squared distances to a set of
+    // planes, stored as its upper triangle.
+    struct Quadric
+    {
+        double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+        double yy = 0.0, yz = 0.0, yw = 0.0;
+        double zz = 0.0, zw = 0.0;
+        double ww = 0.0;
+
+        // The plane through point with the unit normal, weighted.
+        static Quadric FromPlane(const Vec3& normal, const Vec3& point, double weight)
+        {
+            const double d = -normal.Dot(point);
+            Quadric q;
+            q.xx = weight * normal.x * normal.x;
+            q.xy = weight * normal.x * normal.y;
+            q.xz = weight * normal.x * normal.z;
+            q.xw = weight * normal.x * d;
+            q.yy = weight * normal.y * normal.y;
+            q.yz = weight * normal.y * normal.z;
+            q.yw = weight * normal.y * d;
+            q.zz = weight * normal.z * normal.z;
+            q.zw = weight * normal.z * d;
+            q.ww = weight * d * d;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& o)
+        {
+            xx += o.xx; xy += o.xy; xz += o.xz; xw += o.xw;
+            yy += o.yy; yz += o.yz; yw += o.yw;
+            zz += o.zz; zw += o.zw;
+            ww += o.ww;
+            return *this;
+        }
+
+        Quadric operator+(const Quadric& o) const
+        {
+            Quadric q = *this;
+            q += o;
+            return q;
+        }
+
+        double Error(const Vec3& p) const
+        {
+            const double error =
+                xx * p.x * p.x + 2.0 * xy * p.x * p.y + 2.0 * xz * p.x * p.z
+                + 2.0 * xw * p.x + yy * p.y * p.y + 2.0 * yz * p.y * p.z
+                + 2.0 * yw * p.y + zz * p.z * p.z + 2.0 * zw * p.z + ww;
+            return std::max(error, 0.0);
+        }
+
+        // The point with the least error, if it is well defined.
+        bool Minimum(Vec3& p) const
+        {
+            const double det = xx * (yy * zz - yz * yz)
+                               - xy * (xy * zz - yz * xz)
+                               + xz * (xy * yz - yy * xz);
+            const double scale = std::max({std::abs(xx), std::abs(yy), std::abs(zz)});
+            if (std::abs(det) <= 1e-10 * scale * scale * scale || scale == 0.0) {
+                return false;
+            }
+            const double inv = 1.0 / det;
+            p.x = -inv * (xw * (yy * zz - yz * yz) - xy * (yw * zz - yz * zw)
+                          + xz * (yw * yz - yy * zw));
+            p.y = -inv * (xx * (yw * zz - zw * yz) - xw * (xy * zz - yz * xz)
+                          + xz * (xy * zw - yw * xz));
+            p.z = -inv * (xx * (yy * zw - yz * yw) - xy * (xy * zw - yw * xz)
+                          + xw * (xy * yz - yy * xz));
+            return true;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        int keep;
+        int remove;
+        uint32_t keepStamp;
+        uint32_t removeStamp;
+
+        bool operator>(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    class Decimator
+    {
+    public:
+        Decimator(const float* points, size_t numPoints,
+                  const int* faceVertexCounts, size_t numFaces,
+                  const int* faceVertexIndices, size_t numFaceVertices)
+            : _numPoints(numPoints)
+        {
+            _valid = _Triangulate(faceVertexCounts, numFaces,
+                                  faceVertexIndices, numFaceVertices, numPoints);
+            if (!_valid) {
+                return;
+            }
+            _positions.resize(numPoints);
+            tbb::parallel_for(size_t(0), numPoints, [&](size_t i) {
+                _positions[i] = Vec3(points[i * 3], points[i * 3 + 1], points[i * 3 + 2]);
+            });
+            _BuildAdjacency();
+            _BuildQuadrics();
+        }
+
+        bool IsValid() const { return _valid; }
+
+        HdNukeMeshLod Run(size_t targetFaces)
+        {
+            size_t liveTriangles = _triangleFaces.size();
+            std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue(
+                std::greater<Collapse>(), _InitialCollapses());
+
+            while (liveTriangles > targetFaces && !queue.empty()) {
+                const Collapse collapse = queue.top();
+                queue.pop();
+                if (_removed[collapse.keep] || _removed[collapse.remove]
+                        || _stamps[collapse.keep] != collapse.keepStamp
+                        || _stamps[collapse.remove] != collapse.removeStamp) {
+                    continue;
+                }
+                const Vec3 target = _Target(collapse.keep, collapse.remove);
+                if (_Flips(collapse.keep, collapse.remove, target)
+                        || _Flips(collapse.remove, collapse.keep, target)) {
+                    continue;
+                }
+                liveTriangles -= _Collapse(collapse.keep, collapse.remove, target);
+                _PushCollapses(collapse.keep, queue);
+            }
+            return _Compact();
+        }
+
+    private:
+        bool _Triangulate(const int* faceVertexCounts, size_t numFaces,
+                          const int* faceVertexIndices, size_t numFaceVertices,
+                          size_t numPoints)
+        {
+            // Faces are fanned into triangles, which keep the face and face
+            // vertices they came from.
+            std::vector<size_t> triangleOffsets(numFaces + 1, 0);
+            std::vector<size_t> faceVertexOffsets(numFaces + 1, 0);
+            for (size_t face = 0; face < numFaces; face++) {
+                const int count = faceVertexCounts[face];
+                if (count < 0) {
+                    return false;
+                }
+                triangleOffsets[face + 1] = triangleOffsets[face] + std::max(count - 2, 0);
+                faceVertexOffsets[face + 1] = faceVertexOffsets[face] + count;
+            }
+            if (faceVertexOffsets.back() != numFaceVertices) {
+                return false;
+            }
+            for (size_t i = 0; i < numFaceVertices; i++) {
+                if (faceVertexIndices[i] < 0
+                        || static_cast<size_t>(faceVertexIndices[i]) >= numPoints) {
+                    return false;
+                }
+            }
+
+            const size_t numTriangles = triangleOffsets.back();
+            _corners.resize(numTriangles * 3);
+            _cornerSources.resize(numTriangles * 3);
+            _triangleFaces.resize(numTriangles);
+            tbb::parallel_for(size_t(0), numFaces, [&](size_t face) {
+                const size_t first = faceVertexOffsets[face];
+                const size_t count = faceVertexOffsets[face + 1] - first;
+                size_t triangle = triangleOffsets[face];
+                for (size_t j = 1; j + 1 < count; j++, triangle++) {
+                    const size_t sources[3] = {first, first + j, first + j + 1};
+                    for (int k = 0; k < 3; k++) {
+                        _corners[triangle * 3 + k] = faceVertexIndices[sources[k]];
+                        _cornerSources[triangle * 3 + k] = static_cast<int>(sources[k]);
+                    }
+                    _triangleFaces[triangle] = static_cast<int>(face);
+                }
+            });
+            return true;
+        }
+
+        void _BuildAdjacency()
+        {
+            std::vector<size_t> counts(_numPoints, 0);
+            for (int point : _corners) {
+                counts[point]++;
+            }
+            _pointTriangles.resize(_numPoints);
+            for (size_t i = 0; i < _numPoints; i++) {
+                _pointTriangles[i].reserve(counts[i]);
+            }
+            for (size_t corner = 0; corner < _corners.size(); corner++) {
+                _pointTriangles[_corners[corner]].push_back(static_cast<int>(corner / 3));
+            }
+            _triangleRemoved.assign(_triangleFaces.size(), 0);
+            _removed.assign(_numPoints, 0);
+            _stamps.assign(_numPoints, 0);
+        }
+
+        Vec3 _Normal(int triangle) const
+        {
+            const Vec3& a = _positions[_corners[triangle * 3]];
+            const Vec3& b = _positions[_corners[triangle * 3 + 1]];
+            const Vec3& c = _positions[_corners[triangle * 3 + 2]];
+            return (b - a).Cross(c - a);
+        }
+
+        void _BuildQuadrics()
+        {
+            const size_t numTriangles = _triangleFaces.size();
+
+            // The quadric of each triangle is its plane weighted by its area.
+            std::vector<Quadric> triangleQuadrics(numTriangles);
+            tbb::parallel_for(size_t(0), numTriangles, [&](size_t triangle) {
+                const Vec3 normal = _Normal(static_cast<int>(triangle));
+                const double length = normal.Length();
+                if (length > 0.0) {
+                    triangleQuadrics[triangle] = Quadric::FromPlane(
+                        normal * (1.0 / length), _positions[_corners[triangle * 3]],
+                        0.5 * length);
+                }
+            });
+
+            // Edges used by a single triangle are open boundaries, which get
+            // a plane through them at right angles to the triangle.
+            std::vector<std::pair<uint64_t, int>> edges(numTriangles * 3);
+            tbb::parallel_for(size_t(0), numTriangles, [&](size_t triangle) {
+                for (int k = 0; k < 3; k++) {
+                    edges[triangle * 3 + k] = std::make_pair(
+                        _EdgeKey(_corners[triangle * 3 + k],
+                                 _corners[triangle * 3 + (k + 1) % 3]),
+                        static_cast<int>(triangle * 3 + k));
+                }
+            });
+            tbb::parallel_sort(edges.begin(), edges.end());
+
+            std::vector<Quadric> boundaryQuadrics;
+            std::vector<int> boundaryPoints;
+            for (size_t i = 0; i < edges.size();) {
+                size_t end = i + 1;
+                while (end < edges.size() && edges[end].first == edges[i].first) {
+                    end++;
+                }
+                const int a = static_cast<int>(edges[i].first >> 32);
+                const int b = static_cast<int>(edges[i].first & 0xffffffffu);
+                if (a != b) {
+                    _edges.emplace_back(a, b);
+                }
+                if (end - i == 1 && a != b) {
+                    const int corner = edges[i].second;
+                    const Vec3 normal = _Normal(corner / 3);
+                    const Vec3 edge = _positions[b] - _positions[a];
+                    Vec3 side = edge.Cross(normal);
+                    const double length = side.Length();
+                    if (length > 0.0) {
+                        side = side * (1.0 / length);
+                        const Quadric q = Quadric::FromPlane(
+                            side, _positions[a], kBoundaryWeight * edge.Dot(edge));
+                        boundaryQuadrics.push_back(q);
+                        boundaryPoints.push_back(a);
+                        boundaryQuadrics.push_back(q);
+                        boundaryPoints.push_back(b);
+                    }
+                }
+                i = end;
+            }
+
+            _quadrics.resize(_numPoints);
+            tbb::parallel_for(size_t(0), _numPoints, [&](size_t point) {
+                Quadric q;
+                for (int triangle : _pointTriangles[point]) {
+                    q += triangleQuadrics[triangle];
+                }
+                _quadrics[point] = q;
+            });
+            for (size_t i = 0; i < boundaryPoints.size(); i++) {
+                _quadrics[boundaryPoints[i]] += boundaryQuadrics[i];
+            }
+        }
+
+        static uint64_t _EdgeKey(int a, int b)
+        {
+            if (a > b) {
+                std::swap(a, b);
+            }
+            return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+        }
+
+        // Where the merged point of an edge goes: the minimum of the summed
+        // quadrics, or the best of the ends and middle if that's ill defined.
+        Vec3 _Target(int keep, int remove) const
+        {
+            const Quadric q = _quadrics[keep] + _quadrics[remove];
+            Vec3 target;
+            if (q.Minimum(target)) {
+                return target;
+            }
+            const Vec3& a = _positions[keep];
+            const Vec3& b = _positions[remove];
+            const Vec3 candidates[3] = {a, b, (a + b) * 0.5};
+            size_t best = 0;
+            double bestError = q.Error(candidates[0]);
+            for (size_t i = 1; i < 3; i++) {
+                const double error = q.Error(candidates[i]);
+                if (error < bestError) {
+                    best = i;
+                    bestError = error;
+                }
+            }
+            return candidates[best];
+        }
+
+        Collapse _MakeCollapse(int keep, int remove) const
+        {
+            const Vec3 target = _Target(keep, remove);
+            const double cost = (_quadrics[keep] + _quadrics[remove]).Error(target);
+            return Collapse{cost, keep, remove, _stamps[keep], _stamps[remove]};
+        }
+
+        std::vector<Collapse> _InitialCollapses() const
+        {
+            std::vector<Collapse> collapses(_edges.size());
+            tbb::parallel_for(size_t(0), _edges.size(), [&](size_t i) {
+                collapses[i] = _MakeCollapse(_edges[i].first, _edges[i].second);
+            });
+            return collapses;
+        }
+
+        // Whether moving point to target turns over any of its triangles
+        // that don't also use other.
+        bool _Flips(int point, int other, const Vec3& target) const
+        {
+            for (int triangle : _pointTriangles[point]) {
+                if (_triangleRemoved[triangle]) {
+                    continue;
+                }
+                const int* corners = &_corners[triangle * 3];
+                if (corners[0] == other || corners[1] == other || corners[2] == other) {
+                    continue;
+                }
+                Vec3 moved[3];
+                for (int k = 0; k < 3; k++) {
+                    moved[k] = corners[k] == point ? target : _positions[corners[k]];
+                }
+                const Vec3 before = _Normal(triangle);
+                const Vec3 after = (moved[1] - moved[0]).Cross(moved[2] - moved[0]);
+                if (before.Dot(after) <= 0.0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Merges remove into keep, returning the number of triangles that
+        // collapsed with the edge.
+        size_t _Collapse(int keep, int remove, const Vec3& target)
+        {
+            size_t collapsed = 0;
+            _positions[keep] = target;
+            _quadrics[keep] += _quadrics[remove];
+            _removed[remove] = 1;
+            _stamps[keep]++;
+
+            std::vector<int>& keepTriangles = _pointTriangles[keep];
+            for (int triangle : _pointTriangles[remove]) {
+                if (_triangleRemoved[triangle]) {
+                    continue;
+                }
+                int* corners = &_corners[triangle * 3];
+                if (corners[0] == keep || corners[1] == keep || corners[2] == keep) {
+                    _triangleRemoved[triangle] = 1;
+                    collapsed++;
+                    continue;
+                }
+                for (int k = 0; k < 3; k++) {
+                    if (corners[k] == remove) {
+                        corners[k] = keep;
+                    }
+                }
+                keepTriangles.push_back(triangle);
+            }
+            std::vector<int>().swap(_pointTriangles[remove]);
+
+            keepTriangles.erase(
+                std::remove_if(keepTriangles.begin(), keepTriangles.end(),
+                               [&](int triangle) { return _triangleRemoved[triangle] != 0; }),
+                keepTriangles.end());
+            return collapsed;
+        }
+
+        template <typename Queue>
+        void _PushCollapses(int point, Queue& queue) const
+        {
+            for (int triangle : _pointTriangles[point]) {
+                for (int k = 0; k < 3; k++) {
+                    const int other = _corners[triangle * 3 + k];
+                    if (other != point) {
+                        queue.push(_MakeCollapse(point, other));
+                    }
+                }
+            }
+        }
+
+        HdNukeMeshLod _Compact() const
+        {
+            HdNukeMeshLod lod;
+            std::vector<int> remap(_numPoints, -1);
+            for (size_t triangle = 0; triangle < _triangleFaces.size(); triangle++) {
+                if (_triangleRemoved[triangle]) {
+                    continue;
+                }
+                lod.faceSources.push_back(_triangleFaces[triangle]);
+                for (int k = 0; k < 3; k++) {
+                    const int point = _corners[triangle * 3 + k];
+                    if (remap[point] < 0) {
+                        remap[point] = static_cast<int>(lod.pointSources.size());
+                        lod.pointSources.push_back(point);
+                        const Vec3& position = _positions[point];
+                        lod.points.push_back(static_cast<float>(position.x));
+                        lod.points.push_back(static_cast<float>(position.y));
+                        lod.points.push_back(static_cast<float>(position.z));
+                    }
+                    lod.faceVertexIndices.push_back(remap[point]);
+                    lod.faceVertexSources.push_back(_cornerSources[triangle * 3 + k]);
+                }
+            }
+            return lod;
+        }
+
+        size_t _numPoints;
+        bool _valid = false;
+
+        std::vector<Vec3> _positions;
+        std::vector<Quadric> _quadrics;
+        std::vector<uint8_t> _removed;
+        // Bumped whenever a point moves, to tell stale collapses apart.
+        std::vector<uint32_t> _stamps;
+        std::vector<std::vector<int>> _pointTriangles;
+
+        // Three points per triangle, and the face vertex each came from.
+        std::vector<int> _corners;
+        std::vector<int> _cornerSources;
+        std::vector<int> _triangleFaces;
+        std::vector<uint8_t> _triangleRemoved;
+
+        std::vector<std::pair<int, int>> _edges;
+    };
+}
+
+HdNukeMeshLod
+HdNukeDecimateMesh(const float* points, size_t numPoints,
+                   const int* faceVertexCounts, size_t numFaces,
+                   const int* faceVertexIndices, size_t numFaceVertices,
+                   size_t targetFaces)
+{
+    Decimator decimator(points, numPoints, faceVertexCounts, numFaces,
+                        faceVertexIndices, numFaceVertices);
+    if (!decimator.IsValid()) {
+        return HdNukeMeshLod();
+    }
+    return decimator.Run(targetFaces);
+}
+
+std::vector<HdNukeMeshLod>
+HdNukeBuildMeshLods(const float* points, size_t numPoints,
+                    const int* faceVertexCounts, size_t numFaces,
+                    const int* faceVertexIndices, size_t numFaceVertices,
+                    const std::vector<size_t>& targetFaces)
+{
+    std::vector<HdNukeMeshLod> lods(targetFaces.size());
+    tbb::parallel_for(size_t(0), targetFaces.size(), [&](size_t level) {
+        lods[level] = HdNukeDecimateMesh(points, numPoints, faceVertexCounts,
+                                         numFaces, faceVertexIndices,
+                                         numFaceVertices, targetFaces[level]);
+    }, tbb::simple_partitioner());
+    return lods;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,79 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_MESHDECIMATION_H
+#define HDNUKE_MESHDECIMATION_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// A simplified version of a mesh, made of triangles.
+///
+/// Every element of the LOD records the element of the mesh it takes its
+/// attributes from, so primvars of any interpolation can be carried over by
+/// gathering them.
+struct HdNukeMeshLod
+{
+    /// The points of the LOD, three floats each.
+    std::vector<float> points;
+
+    /// The mesh point each point of the LOD comes from.
+    std::vector<int> pointSources;
+
+    /// The triangles of the LOD, three indices into its points each.
+    std::vector<int> faceVertexIndices;
+
+    /// The mesh face each triangle of the LOD comes from.
+    std::vector<int> faceSources;
+
+    /// The mesh face vertex each face vertex of the LOD comes from.
+    std::vector<int> faceVertexSources;
+
+    inline size_t GetFaceCount() const { return faceSources.size(); }
+};
+
+/// Simplifies a mesh to about \p targetFaces triangles.
+///
+/// Faces are triangulated, and edges collapsed in order of the quadric error
+/// metric of Garland and Heckbert, so flat regions lose detail first. Open
+/// boundaries, including the seams of unwelded meshes, are weighted to keep
+/// their shape, and collapses that would flip a triangle are skipped. The
+/// quadrics and edges are worked out in parallel; the collapses themselves
+/// are sequential.
+///
+/// The \p numPoints points at \p points are given as three floats each.
+/// Returns an empty LOD if the topology refers to points that don't exist.
+HdNukeMeshLod
+HdNukeDecimateMesh(const float* points, size_t numPoints,
+                   const int* faceVertexCounts, size_t numFaces,
+                   const int* faceVertexIndices, size_t numFaceVertices,
+                   size_t targetFaces);
+
+/// Builds an LOD of a mesh for each of \p targetFaces, in parallel.
+std::vector<HdNukeMeshLod>
+HdNukeBuildMeshLods(const float* points, size_t numPoints,
+                    const int* faceVertexCounts, size_t numFaces,
+                    const int* faceVertexIndices, size_t numFaceVertices,
+                    const std::vector<size_t>& targetFaces);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_MESHDECIMATION_H
@@ -0,0 +1,335 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "meshTopology.h"
+
+#include <DDImage/GeoInfo.h>
+#include <DDImage/Mesh.h>
+#include <DDImage/PolyMesh.h>
+#include <DDImage/Polygon.h>
+#include <DDImage/Primitive.h>
+#include <DDImage/Triangle.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+
+using namespace DD::Image;
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    // Primitives are cheap to visit individually, so hand them out to the
+    // worker threads in batches.
+    constexpr size_t kPrimitiveGrainSize = 256;
+
+    // Same for the faces of a single large primitive.
+    constexpr size_t kFaceGrainSize = 4096;
+
+    // Below this many faces a single primitive isn't worth splitting.
+    constexpr size_t kLargePrimitiveFaceCount = 16 * kFaceGrainSize;
+
+    inline bool HasFaces(PrimitiveType primType)
+    {
+        return primType != ePoint and primType != eParticles
+               and primType != eParticlesSprite;
+    }
+
+    // Reads the faces of a primitive of class PrimT. The calls are qualified
+    // with the concrete class so they are bound at compile time rather than
+    // going through the Primitive vtable, so PrimT must be the final class of
+    // the primitive.
+    template <class PrimT>
+    struct FaceExtractor
+    {
+        static size_t CountFaceVertices(const Primitive* prim)
+        {
+            const PrimT* p = static_cast<const PrimT*>(prim);
+            size_t numFaceVertices = 0;
+            const uint32_t numFaces = p->PrimT::faces();
+            for (uint32_t faceIndex = 0; faceIndex < numFaces; faceIndex++)
+            {
+                numFaceVertices += p->PrimT::face_vertices(faceIndex);
+            }
+            return numFaceVertices;
+        }
+
+        // Writes the face vertex counts of faces [begin, end) to \p counts and
+        // their point indices to \p indices.
+        static void Fill(const Primitive* prim, uint32_t begin, uint32_t end,
+                         int* counts, int* indices)
+        {
+            const PrimT* p = static_cast<const PrimT*>(prim);
+            const unsigned* vertexArray = p->vertex_array();
+            for (uint32_t faceIndex = begin; faceIndex < end; faceIndex++)
+            {
+                const uint32_t numFaceVertices = p->PrimT::face_vertices(faceIndex);
+                *counts++ = numFaceVertices;
+
+                // Fetch the primitive-local vertex indices straight into the
+                // output and map them to point indices in place.
+                unsigned* faceVertices = reinterpret_cast<unsigned*>(indices);
+                p->PrimT::get_face_vertices(faceIndex, faceVertices);
+                for (uint32_t i = 0; i < numFaceVertices; i++)
+                {
+                    indices[i] = vertexArray[faceVertices[i]];
+                }
+                indices += numFaceVertices;
+            }
+        }
+    };
+
+    // The fallback for any other primitive type, which may be a subclass
+    // overriding the Primitive interface, so it goes through the vtable.
+    template <>
+    struct FaceExtractor<Primitive>
+    {
+        static size_t CountFaceVertices(const Primitive* prim)
+        {
+            size_t numFaceVertices = 0;
+            const uint32_t numFaces = prim->faces();
+            for (uint32_t faceIndex = 0; faceIndex < numFaces; faceIndex++)
+            {
+                numFaceVertices += prim->face_vertices(faceIndex);
+            }
+            return numFaceVertices;
+        }
+
+        static void Fill(const Primitive* prim, uint32_t begin, uint32_t end,
+                         int* counts, int* indices)
+        {
+            const unsigned* vertexArray = prim->vertex_array();
+            for (uint32_t faceIndex = begin; faceIndex < end; faceIndex++)
+            {
+                const uint32_t numFaceVertices = prim->face_vertices(faceIndex);
+                *counts++ = numFaceVertices;
+
+                unsigned* faceVertices = reinterpret_cast<unsigned*>(indices);
+                prim->get_face_vertices(faceIndex, faceVertices);
+                for (uint32_t i = 0; i < numFaceVertices; i++)
+                {
+                    indices[i] = vertexArray[faceVertices[i]];
+                }
+                indices += numFaceVertices;
+            }
+        }
+    };
+
+    // A triangle is a single face over its three vertices.
+    template <>
+    struct FaceExtractor<Triangle>
+    {
+        static size_t CountFaceVertices(const Primitive*) { return 3; }
+
+        static void Fill(const Primitive* prim, uint32_t, uint32_t,
+                         int* counts, int* indices)
+        {
+            const unsigned* vertexArray = prim->vertex_array();
+            counts[0] = 3;
+            indices[0] = vertexArray[0];
+            indices[1] = vertexArray[1];
+            indices[2] = vertexArray[2];
+        }
+    };
+
+    // A polygon is a single face over all of its vertices, in order.
+    template <>
+    struct FaceExtractor<Polygon>
+    {
+        static size_t CountFaceVertices(const Primitive* prim)
+        {
+            return prim->vertices();
+        }
+
+        static void Fill(const Primitive* prim, uint32_t, uint32_t,
+                         int* counts, int* indices)
+        {
+            const unsigned numVertices = prim->vertices();
+            const unsigned* vertexArray = prim->vertex_array();
+            counts[0] = numVertices;
+            std::copy(vertexArray, vertexArray + numVertices, indices);
+        }
+    };
+
+    size_t CountFaceVertices(PrimitiveType primType, const Primitive* prim)
+    {
+        switch (primType) {
+            case eTriangle:
+                return FaceExtractor<Triangle>::CountFaceVertices(prim);
+            case ePolygon:
+                return FaceExtractor<Polygon>::CountFaceVertices(prim);
+            case eMesh:
+                return FaceExtractor<Mesh>::CountFaceVertices(prim);
+            case ePolyMesh:
+                return FaceExtractor<PolyMesh>::CountFaceVertices(prim);
+            default:
+                return FaceExtractor<Primitive>::CountFaceVertices(prim);
+        }
+    }
+
+    void Fill(PrimitiveType primType, const Primitive* prim, uint32_t numFaces,
+              int* counts, int* indices)
+    {
+        switch (primType) {
+            case eTriangle:
+                FaceExtractor<Triangle>::Fill(prim, 0, numFaces, counts, indices);
+                break;
+            case ePolygon:
+                FaceExtractor<Polygon>::Fill(prim, 0, numFaces, counts, indices);
+                break;
+            case eMesh:
+                FaceExtractor<Mesh>::Fill(prim, 0, numFaces, counts, indices);
+                break;
+            case ePolyMesh:
+                FaceExtractor<PolyMesh>::Fill(prim, 0, numFaces, counts, indices);
+                break;
+            default:
+                FaceExtractor<Primitive>::Fill(prim, 0, numFaces, counts, indices);
+                break;
+        }
+    }
+}
+
+HdNukeMeshTopologyBuilder::HdNukeMeshTopologyBuilder(const GeoInfo& geo)
+    : _geo(geo)
+{
+    const size_t numPrimitives = geo.primitives();
+    const Primitive** primArray = geo.primitive_array();
+
+    _primitiveTypes.resize(numPrimitives);
+    _faceOffsets.resize(numPrimitives + 1, 0);
+    _faceVertexOffsets.resize(numPrimitives + 1, 0);
+
+    // First pass: count the faces and face vertices of every primitive. The
+    // counts are stored one slot ahead so the prefix sum below can be done in
+    // place.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numPrimitives, kPrimitiveGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t primIndex = range.begin(); primIndex != range.end(); primIndex++)
+            {
+                const Primitive* prim = primArray[primIndex];
+                const PrimitiveType primType = prim->getPrimitiveType();
+                _primitiveTypes[primIndex] = primType;
+                if (not HasFaces(primType)) {
+                    continue;
+                }
+
+                _faceOffsets[primIndex + 1] = prim->faces();
+                _faceVertexOffsets[primIndex + 1] = CountFaceVertices(primType, prim);
+            }
+        });
+
+    for (size_t primIndex = 0; primIndex < numPrimitives; primIndex++)
+    {
+        _faceOffsets[primIndex + 1] += _faceOffsets[primIndex];
+        _faceVertexOffsets[primIndex + 1] += _faceVertexOffsets[primIndex];
+    }
+}
+
+template <class PrimT>
+void
+HdNukeMeshTopologyBuilder::_BuildLargePrimitive(const Primitive* prim,
+                                                int* counts, int* indices) const
+{
+    const PrimT* p = static_cast<const PrimT*>(prim);
+    const uint32_t numFaces = p->PrimT::faces();
+
+    // The per-face counts give each face its offset into the index array.
+    std::vector<size_t> faceVertexOffsets(numFaces + 1, 0);
+    for (uint32_t faceIndex = 0; faceIndex < numFaces; faceIndex++)
+    {
+        const uint32_t numFaceVertices = p->PrimT::face_vertices(faceIndex);
+        counts[faceIndex] = numFaceVertices;
+        faceVertexOffsets[faceIndex + 1] = faceVertexOffsets[faceIndex] + numFaceVertices;
+    }
+
+    // Copy the primitive-local indices of each face straight into the output.
+    tbb::parallel_for(
+        tbb::blocked_range<uint32_t>(0, numFaces, kFaceGrainSize),
+        [&](const tbb::blocked_range<uint32_t>& range) {
+            for (uint32_t faceIndex = range.begin(); faceIndex != range.end(); faceIndex++)
+            {
+                p->PrimT::get_face_vertices(
+                    faceIndex,
+                    reinterpret_cast<unsigned*>(indices + faceVertexOffsets[faceIndex]));
+            }
+        });
+
+    // Then map the whole array to point indices in one go.
+    const size_t numFaceVertices = faceVertexOffsets.back();
+    const unsigned* vertexArray = p->vertex_array();
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numFaceVertices, kFaceGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); i++)
+            {
+                indices[i] = vertexArray[indices[i]];
+            }
+        });
+}
+
+void
+HdNukeMeshTopologyBuilder::Build(VtIntArray& faceVertexCounts,
+                                 VtIntArray& faceVertexIndices) const
+{
+    faceVertexCounts.resize(GetFaceCount());
+    faceVertexIndices.resize(GetFaceVertexCount());
+
+    // Grab the raw pointers up front: the non-const VtArray accessors may
+    // detach the array, which must not happen from the worker threads.
+    int* countsPtr = faceVertexCounts.data();
+    int* indicesPtr = faceVertexIndices.data();
+
+    const size_t numPrimitives = _geo.primitives();
+    const Primitive** primArray = _geo.primitive_array();
+
+    // A single large mesh primitive would leave all but one thread idle, so
+    // split it by faces instead.
+    if (numPrimitives == 1 and GetFaceCount() >= kLargePrimitiveFaceCount) {
+        switch (_primitiveTypes[0]) {
+            case ePolyMesh:
+                _BuildLargePrimitive<PolyMesh>(primArray[0], countsPtr, indicesPtr);
+                return;
+            case eMesh:
+                _BuildLargePrimitive<Mesh>(primArray[0], countsPtr, indicesPtr);
+                return;
+            default:
+                break;
+        }
+    }
+
+    // Second pass: every primitive writes to its own slice of the arrays.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numPrimitives, kPrimitiveGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t primIndex = range.begin(); primIndex != range.end(); primIndex++)
+            {
+                const size_t numFaces = _faceOffsets[primIndex + 1] - _faceOffsets[primIndex];
+                if (numFaces == 0) {
+                    continue;
+                }
+
+                Fill(_primitiveTypes[primIndex], primArray[primIndex],
+                     static_cast<uint32_t>(numFaces),
+                     countsPtr + _faceOffsets[primIndex],
+                     indicesPtr + _faceVertexOffsets[primIndex]);
+            }
+        });
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
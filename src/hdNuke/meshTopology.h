@@ -0,0 +1,88 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_MESHTOPOLOGY_H
+#define HDNUKE_MESHTOPOLOGY_H
+
+#include <pxr/pxr.h>
+
+#include <pxr/base/vt/array.h>
+
+#include <DDImage/Primitive.h>
+
+#include <vector>
+
+namespace DD
+{
+    namespace Image
+    {
+        class GeoInfo;
+    }
+}
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Builds the flattened face vertex counts and indices of a GeoInfo.
+///
+/// The topology is built in two parallel passes over the primitives of the
+/// GeoInfo. The first pass counts the faces and face vertices of each
+/// primitive, which after a prefix sum gives every primitive the offset it
+/// writes to. The second pass fills the pre-sized arrays in place, so no
+/// synchronisation is needed between primitives.
+///
+/// Triangle, Polygon, Mesh and PolyMesh primitives are read through
+/// extractors specialised on the concrete primitive class, which avoids the
+/// virtual calls per face vertex of the generic Primitive interface. A GeoInfo
+/// made of a single large mesh primitive is split across faces instead of
+/// primitives, and its vertex array is copied in bulk.
+///
+/// Point and particle primitives are skipped, as they have no faces.
+class HdNukeMeshTopologyBuilder
+{
+public:
+    /// Runs the counting pass over the primitives of \p geo.
+    explicit HdNukeMeshTopologyBuilder(const DD::Image::GeoInfo& geo);
+
+    /// Returns the total number of faces.
+    inline size_t GetFaceCount() const { return _faceOffsets.back(); }
+
+    /// Returns the total number of face vertices.
+    inline size_t GetFaceVertexCount() const { return _faceVertexOffsets.back(); }
+
+    /// Runs the filling pass, resizing \p faceVertexCounts and
+    /// \p faceVertexIndices to hold the whole topology.
+    void Build(VtIntArray& faceVertexCounts, VtIntArray& faceVertexIndices) const;
+
+private:
+    template <class PrimT>
+    void _BuildLargePrimitive(const DD::Image::Primitive* prim, int* counts,
+                              int* indices) const;
+
+    const DD::Image::GeoInfo& _geo;
+
+    // The primitive types found by the counting pass, so the filling pass
+    // doesn't need to query them again.
+    std::vector<DD::Image::PrimitiveType> _primitiveTypes;
+
+    // Exclusive prefix sums of the per-primitive counts, with one extra
+    // trailing element holding the totals.
+    std::vector<size_t> _faceOffsets;
+    std::vector<size_t> _faceVertexOffsets;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_MESHTOPOLOGY_H
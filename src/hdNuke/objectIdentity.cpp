@@ -0,0 +1,138 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "objectIdentity.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    // Returns id, or id with the lowest numbered suffix that isn't in use,
+    // and marks it in use.
+    std::string ClaimId(const std::string& id,
+                        std::unordered_set<std::string>& usedIds)
+    {
+        std::string claimed = id;
+        for (size_t suffix = 1; usedIds.count(claimed) != 0; suffix++) {
+            claimed = id + '_' + std::to_string(suffix);
+        }
+        usedIds.insert(claimed);
+        return claimed;
+    }
+
+    bool SameTypes(const HdNukeObjectKey& a, const HdNukeObjectKey& b)
+    {
+        return a.primType == b.primType && a.adapterType == b.adapterType;
+    }
+
+    std::string TypesKey(const HdNukeObjectKey& object)
+    {
+        return object.primType + '\n' + object.adapterType;
+    }
+}
+
+std::vector<std::string>
+HdNukeObjectIdentities::Match(const std::vector<HdNukeObjectKey>& objects) const
+{
+    std::vector<std::string> ids(objects.size());
+    std::unordered_set<std::string> usedIds;
+
+    // Named objects don't depend on the last sync at all.
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!objects[i].name.empty()) {
+            ids[i] = ClaimId(objects[i].primType + '_' + objects[i].name, usedIds);
+        }
+    }
+
+    // The unnamed objects of the last sync that are free to be matched, by
+    // source id, and by prim type in object order.
+    std::unordered_map<uint64_t, std::vector<size_t>> previousBySrcId;
+    for (size_t i = 0; i < _objects.size(); i++) {
+        if (_objects[i].name.empty() && usedIds.count(_ids[i]) == 0) {
+            previousBySrcId[_objects[i].srcId].push_back(i);
+        }
+    }
+    std::vector<bool> previousMatched(_objects.size(), false);
+
+    std::vector<size_t> unmatched;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!objects[i].name.empty()) {
+            continue;
+        }
+        bool matched = false;
+        auto previous = previousBySrcId.find(objects[i].srcId);
+        if (previous != previousBySrcId.end()) {
+            for (size_t previousIndex : previous->second) {
+                if (!previousMatched[previousIndex]
+                        && SameTypes(_objects[previousIndex], objects[i])) {
+                    previousMatched[previousIndex] = true;
+                    ids[i] = _ids[previousIndex];
+                    usedIds.insert(ids[i]);
+                    matched = true;
+                    break;
+                }
+            }
+        }
+        if (!matched) {
+            unmatched.push_back(i);
+        }
+    }
+
+    // Objects whose source id changed take over the ids that went away.
+    std::unordered_map<std::string, std::vector<size_t>> freeByTypes;
+    for (size_t i = 0; i < _objects.size(); i++) {
+        if (_objects[i].name.empty() && !previousMatched[i]
+                && usedIds.count(_ids[i]) == 0) {
+            freeByTypes[TypesKey(_objects[i])].push_back(i);
+        }
+    }
+    std::unordered_map<std::string, size_t> nextFree;
+    std::vector<size_t> leftOver;
+    for (size_t i : unmatched) {
+        const std::string typesKey = TypesKey(objects[i]);
+        auto free = freeByTypes.find(typesKey);
+        size_t& next = nextFree[typesKey];
+        if (free != freeByTypes.end() && next < free->second.size()) {
+            ids[i] = _ids[free->second[next++]];
+            usedIds.insert(ids[i]);
+        }
+        else {
+            leftOver.push_back(i);
+        }
+    }
+
+    // New ids also stay clear of the ones that went away, whose prims are
+    // still in the index until the end of the sync.
+    usedIds.insert(_ids.begin(), _ids.end());
+    for (size_t i : leftOver) {
+        ids[i] = ClaimId(objects[i].primType + '_' + std::to_string(i), usedIds);
+    }
+    return ids;
+}
+
+std::vector<std::string>
+HdNukeObjectIdentities::Update(const std::vector<HdNukeObjectKey>& objects)
+{
+    std::vector<std::string> ids = Match(objects);
+    _objects = objects;
+    _ids = ids;
+    return ids;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,73 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_OBJECTIDENTITY_H
+#define HDNUKE_OBJECTIDENTITY_H
+
+#include <pxr/pxr.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// What an object in the output of a geometry op is recognised by.
+struct HdNukeObjectKey
+{
+    /// Nuke's source id of the object, which upstream edits may change.
+    uint64_t srcId = 0;
+    /// The prim type the object is converted to.
+    std::string primType;
+    /// The type of adapter the object is converted with. Objects only take
+    /// over the ids of objects converted the same way.
+    std::string adapterType;
+    /// The object's name attribute, made safe for use in a path, or empty
+    /// if it has none.
+    std::string name;
+};
+
+/// Gives the objects in the output of a geometry op ids that stay the same
+/// between syncs, so the prims converted from them are updated rather than
+/// replaced.
+///
+/// Named objects are identified by their prim type and name. Each unnamed
+/// object first looks for an object of the same source id and types in the
+/// last sync and keeps its id, so objects keep their ids when others are
+/// added or removed. The rest then take over the ids of objects of the same
+/// types that went away, in object order, so an upstream edit that
+/// changes the source ids doesn't replace the prims. Objects still without
+/// an id get a new one made from their prim type and index.
+class HdNukeObjectIdentities
+{
+public:
+    /// Returns the ids of \p objects, matched against the objects of the last
+    /// call to Update.
+    std::vector<std::string> Match(const std::vector<HdNukeObjectKey>& objects) const;
+
+    /// Returns the ids of \p objects like Match, and keeps them to match the
+    /// objects of the next sync against.
+    std::vector<std::string> Update(const std::vector<HdNukeObjectKey>& objects);
+
+private:
+    std::vector<HdNukeObjectKey> _objects;
+    std::vector<std::string> _ids;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_OBJECTIDENTITY_H
@@ -79,10 +79,11 @@ HdNukeParticleSpriteAdapter::MakeParticleSprite()
     _points.push_back(pxr::GfVec3f( 0.5f,  0.5f, 0.0f));
     _points.push_back(pxr::GfVec3f( 0.5f, -0.5f, 0.0f));
 
-    _uvs.push_back(pxr::GfVec2f(0, 0));
-    _uvs.push_back(pxr::GfVec2f(0, 1));
-    _uvs.push_back(pxr::GfVec2f(1, 1));
-    _uvs.push_back(pxr::GfVec2f(1, 0));
+    VtVec2fArray uvs;
+    uvs.push_back(pxr::GfVec2f(0, 0));
+    uvs.push_back(pxr::GfVec2f(0, 1));
+    uvs.push_back(pxr::GfVec2f(1, 1));
+    uvs.push_back(pxr::GfVec2f(1, 0));
 
     VtIntArray faceVertexCounts;
     faceVertexCounts.push_back(4);
@@ -104,21 +105,11 @@ HdNukeParticleSpriteAdapter::MakeParticleSprite()
 
     _transform.SetIdentity();
 
-    static HdPrimvarDescriptor pointsDescriptor(
-            HdTokens->points, HdInterpolationVertex,
-            HdPrimvarRoleTokens->point);
-    static HdPrimvarDescriptor uvsDescriptor(
-            HdNukeTokens->st, HdInterpolationVertex,
-            HdPrimvarRoleTokens->textureCoordinate);
-    static HdPrimvarDescriptor displayColorDescriptor(
-            HdTokens->displayColor, HdInterpolationConstant,
-            HdPrimvarRoleTokens->color);
-
-    _constantPrimvarDescriptors.clear();
-
-    _vertexPrimvarDescriptors.clear();
-    _vertexPrimvarDescriptors.push_back(pointsDescriptor);
-    _vertexPrimvarDescriptors.push_back(uvsDescriptor);
+    _primvars.Clear();
+    _primvars.Add(HdTokens->points, HdInterpolationVertex,
+                  HdPrimvarRoleTokens->point);
+    _primvars.Add(HdNukeTokens->st, HdInterpolationVertex,
+                  HdPrimvarRoleTokens->textureCoordinate, VtValue::Take(uvs));
 
     _displayColor = GfVec3f(1, 1, 1);
 }
@@ -206,11 +197,13 @@ void HdNukeParticleSpriteAdapter::_SetMaterial(HdNukeAdapterManager* manager)
 
         auto promise = manager->Request(materialContext);
         _materialId = promise->path;
+        _materialHandle = promise->handle;
     }
     else {
         auto sceneDelegate = manager->GetSceneDelegate();
         auto promise = manager->Request(TfToken{"defaultParticleMaterialId"}, sceneDelegate->DefaultParticleMaterialId());
         _materialId = promise->path;
+        _materialHandle = promise->handle;
     }
 }
 
@@ -0,0 +1,120 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "primvarPromotion.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    constexpr size_t kGrainSize = 4096;
+}
+
+bool
+HdNukeFindUniformPointValues(const void* data, size_t elementSize,
+                             const int* faceVertexIndices,
+                             size_t numFaceVertices, size_t numPoints,
+                             std::vector<int>& pointFaceVertices)
+{
+    const char* bytes = static_cast<const char*>(data);
+
+    // Pick any one of the face vertices of each point to compare the others
+    // against. Which one wins doesn't matter, if the values are uniform they
+    // are all the same.
+    std::unique_ptr<std::atomic<int>[]> representatives(
+        new std::atomic<int>[numPoints]);
+    for (size_t i = 0; i < numPoints; i++) {
+        representatives[i].store(-1, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> valid(true);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numFaceVertices, kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                const int point = faceVertexIndices[i];
+                if (point < 0 || static_cast<size_t>(point) >= numPoints) {
+                    valid.store(false, std::memory_order_relaxed);
+                    return;
+                }
+                representatives[point].store(static_cast<int>(i),
+                                             std::memory_order_relaxed);
+            }
+        });
+    if (!valid) {
+        return false;
+    }
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numFaceVertices, kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            if (!valid.load(std::memory_order_relaxed)) {
+                return;
+            }
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                const int representative =
+                    representatives[faceVertexIndices[i]].load(std::memory_order_relaxed);
+                if (std::memcmp(bytes + i * elementSize,
+                                bytes + representative * elementSize,
+                                elementSize) != 0) {
+                    valid.store(false, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        });
+    if (!valid) {
+        return false;
+    }
+
+    pointFaceVertices.resize(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+        pointFaceVertices[i] = representatives[i].load(std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void
+HdNukeGatherPointValues(const void* data, size_t elementSize,
+                        const std::vector<int>& pointFaceVertices,
+                        void* pointData)
+{
+    const char* src = static_cast<const char*>(data);
+    char* dst = static_cast<char*>(pointData);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, pointFaceVertices.size(), kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                const int faceVertex = pointFaceVertices[i];
+                if (faceVertex < 0) {
+                    std::memset(dst + i * elementSize, 0, elementSize);
+                }
+                else {
+                    std::memcpy(dst + i * elementSize,
+                                src + faceVertex * elementSize, elementSize);
+                }
+            }
+        });
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,51 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_PRIMVARPROMOTION_H
+#define HDNUKE_PRIMVARPROMOTION_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Checks whether a face-varying primvar can be stored per point instead.
+///
+/// \p data holds one element of \p elementSize bytes for each of the
+/// \p numFaceVertices entries of \p faceVertexIndices. The primvar can be
+/// promoted to vertex interpolation if every face vertex referring to the
+/// same point holds the same bytes.
+///
+/// On success \p pointFaceVertices is filled with one face vertex for each of
+/// the \p numPoints points, or -1 for points no face uses, ready for
+/// HdNukeGatherPointValues.
+bool HdNukeFindUniformPointValues(const void* data, size_t elementSize,
+                                  const int* faceVertexIndices,
+                                  size_t numFaceVertices, size_t numPoints,
+                                  std::vector<int>& pointFaceVertices);
+
+/// Copies the element of face vertex \p pointFaceVertices[i] in \p data to
+/// element i of \p pointData, zero filling the points without one.
+void HdNukeGatherPointValues(const void* data, size_t elementSize,
+                             const std::vector<int>& pointFaceVertices,
+                             void* pointData);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_PRIMVARPROMOTION_H
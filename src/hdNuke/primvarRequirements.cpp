@@ -0,0 +1,153 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "primvarRequirements.h"
+
+#include "tokens.h"
+
+#include <pxr/base/tf/staticTokens.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/imaging/hd/tokens.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+TF_DEFINE_PRIVATE_TOKENS(
+    HdNukePrimvarRequirementsTokens,
+
+    (varname)
+    (UsdUVTexture)
+);
+
+namespace {
+    const char kPrimvarReaderPrefix[] = "UsdPrimvarReader";
+}
+
+HdNukePrimvarRequirements::HdNukePrimvarRequirements()
+{
+    _names.insert(HdTokens->points);
+    _names.insert(HdTokens->normals);
+    _names.insert(HdTokens->widths);
+    _names.insert(HdTokens->displayColor);
+    _names.insert(HdTokens->displayOpacity);
+}
+
+void
+HdNukePrimvarRequirements::AddMaterial(const HdMaterialNetworkMap& material)
+{
+    for (const auto& terminal : material.map) {
+        const HdMaterialNetwork& network = terminal.second;
+        _names.insert(network.primvars.begin(), network.primvars.end());
+
+        for (const HdMaterialNode& node : network.nodes) {
+            if (node.identifier == HdNukePrimvarRequirementsTokens->UsdUVTexture) {
+                _names.insert(HdNukeTokens->st);
+                continue;
+            }
+            if (!TfStringStartsWith(node.identifier.GetString(),
+                                    kPrimvarReaderPrefix)) {
+                continue;
+            }
+            auto varname = node.parameters.find(
+                HdNukePrimvarRequirementsTokens->varname);
+            if (varname == node.parameters.end()) {
+                continue;
+            }
+            // Older networks give the name as a token, newer ones as a
+            // string.
+            if (varname->second.IsHolding<TfToken>()) {
+                _names.insert(varname->second.UncheckedGet<TfToken>());
+            }
+            else if (varname->second.IsHolding<std::string>()) {
+                _names.insert(TfToken(varname->second.UncheckedGet<std::string>()));
+            }
+        }
+    }
+}
+
+void
+HdNukePrimvarRequirements::AddPrimvar(const TfToken& name)
+{
+    _names.insert(name);
+}
+
+void
+HdNukePrimvarRequirements::AddPatterns(const std::string& patterns)
+{
+    for (const std::string& pattern : TfStringTokenize(patterns, " \t\n,")) {
+        // Plain names are looked up rather than matched.
+        if (pattern.find_first_of("*?") == std::string::npos) {
+            _names.insert(TfToken(pattern));
+        }
+        else {
+            _patterns.push_back(pattern);
+        }
+    }
+}
+
+bool
+HdNukePrimvarRequirements::IsRequired(const TfToken& name) const
+{
+    if (_names.count(name) != 0) {
+        return true;
+    }
+    for (const std::string& pattern : _patterns) {
+        if (HdNukeMatchNamePattern(pattern, name.GetString())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+HdNukePrimvarRequirements::operator==(const HdNukePrimvarRequirements& other) const
+{
+    return _names == other._names && _patterns == other._patterns;
+}
+
+bool
+HdNukeMatchNamePattern(const std::string& pattern, const std::string& name)
+{
+    // Match greedily, and when that fails go back to the last `*` and let
+    // it take one more character.
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = std::string::npos;
+    size_t starMatch = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        }
+        else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            starMatch = n;
+        }
+        else if (star != std::string::npos) {
+            p = star + 1;
+            n = ++starMatch;
+        }
+        else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,76 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_PRIMVARREQUIREMENTS_H
+#define HDNUKE_PRIMVARREQUIREMENTS_H
+
+#include <pxr/pxr.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/imaging/hd/material.h>
+
+#include <string>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// The names of the primvars a prim needs, so attributes nobody reads can be
+/// left unconverted.
+///
+/// A prim needs the primvars renderers read without being asked to, the ones
+/// its material reads, and any the user asks to keep by name.
+class HdNukePrimvarRequirements
+{
+public:
+    /// Starts out with the primvars renderers read on their own: points,
+    /// normals, widths, displayColor and displayOpacity.
+    HdNukePrimvarRequirements();
+
+    /// Adds the primvars read by \p material. Those are the varname of its
+    /// primvar readers and the primvars its networks list, along with st
+    /// for texture nodes, which read it when their coordinates aren't
+    /// connected.
+    void AddMaterial(const HdMaterialNetworkMap& material);
+
+    /// Adds a single primvar.
+    void AddPrimvar(const TfToken& name);
+
+    /// Adds the name patterns in \p patterns, separated by spaces or commas.
+    /// A `*` in a pattern matches any run of characters and a `?` any single
+    /// one.
+    void AddPatterns(const std::string& patterns);
+
+    /// Returns whether the primvar called \p name is needed.
+    bool IsRequired(const TfToken& name) const;
+
+    bool operator==(const HdNukePrimvarRequirements& other) const;
+    bool operator!=(const HdNukePrimvarRequirements& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    TfToken::HashSet _names;
+    std::vector<std::string> _patterns;
+};
+
+/// Returns whether \p name matches \p pattern, where a `*` matches any run
+/// of characters and a `?` any single one.
+bool HdNukeMatchNamePattern(const std::string& pattern, const std::string& name);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_PRIMVARREQUIREMENTS_H
@@ -0,0 +1,152 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "primvarTable.h"
+
+#include <utility>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+void
+HdNukePrimvarTable::Add(const TfToken& name, HdInterpolation interpolation,
+                        const TfToken& role, VtValue value)
+{
+    if (Entry* entry = _Find(name)) {
+        entry->interpolation = interpolation;
+        entry->role = role;
+        entry->value = std::move(value);
+        return;
+    }
+    _entries.push_back(Entry{name, role, interpolation, std::move(value)});
+}
+
+bool
+HdNukePrimvarTable::SetValue(const TfToken& name, VtValue value)
+{
+    Entry* entry = _Find(name);
+    if (entry == nullptr) {
+        return false;
+    }
+    entry->value = std::move(value);
+    return true;
+}
+
+bool
+HdNukePrimvarTable::SetInterpolation(const TfToken& name,
+                                     HdInterpolation interpolation)
+{
+    Entry* entry = _Find(name);
+    if (entry == nullptr) {
+        return false;
+    }
+    entry->interpolation = interpolation;
+    return true;
+}
+
+const HdNukePrimvarTable::Entry*
+HdNukePrimvarTable::Find(const TfToken& name) const
+{
+    for (const Entry& entry : _entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const VtValue&
+HdNukePrimvarTable::GetValue(const TfToken& name) const
+{
+    static const VtValue empty;
+    const Entry* entry = Find(name);
+    return entry != nullptr ? entry->value : empty;
+}
+
+VtValue
+HdNukePrimvarTable::TakeValue(const TfToken& name)
+{
+    Entry* entry = _Find(name);
+    if (entry == nullptr) {
+        return VtValue();
+    }
+    VtValue value = std::move(entry->value);
+    entry->value = VtValue();
+    return value;
+}
+
+HdPrimvarDescriptorVector
+HdNukePrimvarTable::GetDescriptors(HdInterpolation interpolation) const
+{
+    HdPrimvarDescriptorVector descriptors;
+    for (const Entry& entry : _entries) {
+        if (entry.interpolation == interpolation) {
+            descriptors.emplace_back(entry.name, entry.interpolation, entry.role);
+        }
+    }
+    return descriptors;
+}
+
+bool
+HdNukePrimvarTable::HasSameLayout(const HdNukePrimvarTable& other) const
+{
+    if (_entries.size() != other._entries.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < _entries.size(); i++) {
+        const Entry& a = _entries[i];
+        const Entry& b = other._entries[i];
+        if (a.name != b.name || a.interpolation != b.interpolation
+                || a.role != b.role) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+HdNukePrimvarTable::SetLayout(const HdNukePrimvarTable& other)
+{
+    Entries entries;
+    for (const Entry& entry : other._entries) {
+        entries.push_back(Entry{entry.name, entry.role, entry.interpolation,
+                                TakeValue(entry.name)});
+    }
+    _entries.swap(entries);
+}
+
+size_t
+HdNukePrimvarTable::GetMemoryUsage() const
+{
+    size_t usage = sizeof(*this);
+    if (_entries.capacity() > Entries::internal_capacity) {
+        usage += _entries.capacity() * sizeof(Entry);
+    }
+    return usage;
+}
+
+HdNukePrimvarTable::Entry*
+HdNukePrimvarTable::_Find(const TfToken& name)
+{
+    for (Entry& entry : _entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,117 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_PRIMVARTABLE_H
+#define HDNUKE_PRIMVARTABLE_H
+
+#include <pxr/pxr.h>
+
+#include <pxr/base/tf/smallVector.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/imaging/hd/sceneDelegate.h>
+
+#include <cstddef>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// The primvars of a prim, with their descriptors and data together.
+///
+/// Each primvar has one entry, whatever its interpolation, holding its
+/// converted data or an empty value when the adapter works it out when it's
+/// asked for, as for points. The entries of a simple prim, such as the
+/// points, wireframe and display colours and UVs of a mesh, fit in the table
+/// itself, so it doesn't allocate any memory for them. Prims with more
+/// primvars keep all their entries in one allocation. Looking one up is a
+/// short scan comparing tokens.
+class HdNukePrimvarTable
+{
+public:
+    struct Entry
+    {
+        TfToken name;
+        TfToken role;
+        HdInterpolation interpolation;
+        VtValue value;
+    };
+
+    /// The number of primvars held without allocating.
+    static constexpr unsigned InlineCapacity = 4;
+
+    using Entries = TfSmallVector<Entry, InlineCapacity>;
+    using const_iterator = Entries::const_iterator;
+    using iterator = Entries::iterator;
+
+    /// Adds a primvar after the others, or replaces the descriptor and value
+    /// of the one already called \p name, leaving it where it is.
+    void Add(const TfToken& name, HdInterpolation interpolation,
+             const TfToken& role, VtValue value = VtValue());
+
+    /// Sets the value of the primvar called \p name. Returns false if there
+    /// is no such primvar.
+    bool SetValue(const TfToken& name, VtValue value);
+
+    /// Changes the interpolation of the primvar called \p name. Returns false
+    /// if there is no such primvar.
+    bool SetInterpolation(const TfToken& name, HdInterpolation interpolation);
+
+    /// Returns the primvar called \p name, or nullptr if there is none.
+    const Entry* Find(const TfToken& name) const;
+
+    /// Returns the value of the primvar called \p name, which is empty if
+    /// there is no such primvar.
+    const VtValue& GetValue(const TfToken& name) const;
+
+    /// Moves the value of the primvar called \p name out of the table, or
+    /// returns an empty value if there is no such primvar.
+    VtValue TakeValue(const TfToken& name);
+
+    /// Returns the descriptors of the primvars with \p interpolation, in the
+    /// order they were added.
+    HdPrimvarDescriptorVector GetDescriptors(HdInterpolation interpolation) const;
+
+    /// Returns whether \p other has the same descriptors in the same order,
+    /// whatever their values.
+    bool HasSameLayout(const HdNukePrimvarTable& other) const;
+
+    /// Takes the descriptors of \p other, keeping the values of the primvars
+    /// that are in both.
+    void SetLayout(const HdNukePrimvarTable& other);
+
+    void Clear() { _entries.clear(); }
+
+    bool IsEmpty() const { return _entries.empty(); }
+    size_t GetSize() const { return _entries.size(); }
+
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+    iterator begin() { return _entries.begin(); }
+    iterator end() { return _entries.end(); }
+
+    /// Returns the bytes the table takes up, including any entries that
+    /// didn't fit inline but not the data the values share with others.
+    size_t GetMemoryUsage() const;
+
+private:
+    Entry* _Find(const TfToken& name);
+
+    Entries _entries;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_PRIMVARTABLE_H
@@ -15,11 +15,13 @@
 
 #include <GL/glew.h>
 
+#include <pxr/base/gf/bbox3d.h>
 #include <pxr/base/gf/vec3f.h>
 
 #include <pxr/imaging/hd/renderIndex.h>
 #include <pxr/usdImaging/usdImaging/version.h>
 #include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/stringUtils.h>
 #include <pxr/imaging/hd/light.h>
 #include "DDImage/Iop.h"
 #if PXR_METAL_SUPPORT_ENABLED
@@ -43,16 +45,23 @@
 
 #include "hydraOpManager.h"
 #include "lightOp.h"
+#include "cardInstancesAdapter.h"
+#include "contentHash.h"
+#include "frustumCulling.h"
 #include "materialAdapter.h"
 #include "sceneDelegate.h"
 #include "tokens.h"
 #include "utils.h"
 #include "nukeTexturePlugin.h"
 
+#include <map>
 #include <numeric>
+#include <sstream>
 #include <cstring>
 #include <algorithm>
 
+#include <tbb/parallel_for.h>
+
 using namespace DD::Image;
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -117,11 +126,95 @@ HdNukeSceneDelegate::GetTransform(const SdfPath& id)
     return GfMatrix4d(1);
 }
 
+size_t
+HdNukeSceneDelegate::SampleTransform(const SdfPath& id, size_t maxSampleCount,
+                                     float* sampleTimes,
+                                     GfMatrix4d* sampleValues)
+{
+    std::vector<const _MotionSample*> samples;
+    if (!_GetMotionSamples(id, samples)) {
+        return HdSceneDelegate::SampleTransform(id, maxSampleCount,
+                                                sampleTimes, sampleValues);
+    }
+    const size_t count = std::min(maxSampleCount, samples.size());
+    for (size_t i = 0; i < count; i++) {
+        sampleTimes[i] = _motionFrames[i].time;
+        sampleValues[i] = samples[i]->transform;
+    }
+    return samples.size();
+}
+
+size_t
+HdNukeSceneDelegate::SamplePrimvar(const SdfPath& id, const TfToken& key,
+                                   size_t maxSampleCount, float* sampleTimes,
+                                   VtValue* sampleValues)
+{
+    if (key != HdTokens->points || sharedState.motionBlur == HdNukeMotionBlur::Off) {
+        return HdSceneDelegate::SamplePrimvar(id, key, maxSampleCount,
+                                              sampleTimes, sampleValues);
+    }
+    auto adapter = std::dynamic_pointer_cast<HdNukeGeoAdapter>(_adapterManager.GetAdapter(id));
+
+    // Work the samples out in full first, so a prim that can't be sampled
+    // at some time falls back to a single sample rather than fewer.
+    std::vector<float> times;
+    std::vector<VtValue> values;
+    std::vector<const _MotionSample*> samples;
+    if (adapter && sharedState.motionBlur == HdNukeMotionBlur::Velocity) {
+        times = sharedState.motionSampleTimes;
+        for (float time : times) {
+            values.push_back(adapter->GetVelocityPoints(time));
+        }
+    }
+    else if (adapter && _GetMotionSamples(id, samples)) {
+        for (size_t i = 0; i < samples.size(); i++) {
+            times.push_back(_motionFrames[i].time);
+            values.push_back(adapter->GetMotionPoints(samples[i]->points));
+        }
+    }
+    const bool sampled = !values.empty()
+        && std::none_of(values.begin(), values.end(),
+                        [](const VtValue& value) { return value.IsEmpty(); });
+    if (!sampled) {
+        return HdSceneDelegate::SamplePrimvar(id, key, maxSampleCount,
+                                              sampleTimes, sampleValues);
+    }
+
+    const size_t count = std::min(maxSampleCount, values.size());
+    for (size_t i = 0; i < count; i++) {
+        sampleTimes[i] = times[i];
+        sampleValues[i] = std::move(values[i]);
+    }
+    return values.size();
+}
+
+bool
+HdNukeSceneDelegate::_GetMotionSamples(const SdfPath& id,
+                                       std::vector<const _MotionSample*>& samples)
+{
+    // Only prims converted from a single GeoInfo have samples of their own.
+    if (sharedState.motionBlur != HdNukeMotionBlur::Evaluate
+            || _motionFrames.empty()
+            || _adapterManager.GetPrimType(id) != HdNukeAdapterManagerPrimTypes->GenericGeoInfo) {
+        return false;
+    }
+    samples.clear();
+    samples.reserve(_motionFrames.size());
+    for (const _MotionFrame& frame : _motionFrames) {
+        auto sample = frame.samples->find(id);
+        if (sample == frame.samples->end()) {
+            return false;
+        }
+        samples.push_back(&sample->second);
+    }
+    return true;
+}
+
 bool
 HdNukeSceneDelegate::GetVisible(const SdfPath& id)
 {
     if (auto adapter = _adapterManager.GetAdapter(id)) {
-        adapter->Get(HdNukeTokens->visible).UncheckedGet<bool>();
+        return adapter->Get(HdNukeTokens->visible).GetWithDefault<bool>(true);
     }
     return true;
 }
@@ -130,11 +223,23 @@ bool
 HdNukeSceneDelegate::GetDoubleSided(const SdfPath& id)
 {
     if (auto adapter = _adapterManager.GetAdapter(id)) {
-        adapter->Get(HdNukeTokens->doubleSided).UncheckedGet<bool>();
+        return adapter->Get(HdNukeTokens->doubleSided).GetWithDefault<bool>(true);
     }
     return true;
 }
 
+HdDisplayStyle
+HdNukeSceneDelegate::GetDisplayStyle(const SdfPath& id)
+{
+    if (auto adapter = _adapterManager.GetAdapter(id)) {
+        const VtValue displayStyle = adapter->Get(HdNukeTokens->displayStyle);
+        if (displayStyle.IsHolding<HdDisplayStyle>()) {
+            return displayStyle.UncheckedGet<HdDisplayStyle>();
+        }
+    }
+    return HdDisplayStyle();
+}
+
 VtValue
 HdNukeSceneDelegate::Get(const SdfPath& id, const TfToken& key)
 {
@@ -312,27 +417,415 @@ HdNukeSceneDelegate::SetDefaultDisplayColor(GfVec3f color)
     }
 }
 
+HdNukeContentHash
+HdNukeSceneDelegate::GetContentFingerprint(const GeoInfo& geoInfo) const
+{
+    auto it = _geoFingerprints.find(GetGeoInfoPath(geoInfo));
+    if (it != _geoFingerprints.end()) {
+        return it->second.fingerprint;
+    }
+    return HdNukeContentHash();
+}
+
+SdfPath
+HdNukeSceneDelegate::GetGeoInfoPath(const GeoInfo& geoInfo) const
+{
+    auto it = _geoInfoPaths.find(&geoInfo);
+    if (it != _geoInfoPaths.end()) {
+        return it->second;
+    }
+    GeoOp* sourceOp = op_cast<GeoOp*>(geoInfo.final_geo);
+    return GetConfig().GeoRoot().AppendPath(GetPathFromOp(sourceOp))
+               .AppendPath(GetRprimSubPath(geoInfo, GetRprimType(geoInfo)));
+}
+
+void
+HdNukeSceneDelegate::_AssignGeoInfoPaths(const std::vector<GeoInfo*>& geoList,
+                                         bool update,
+                                         std::unordered_map<const GeoInfo*, SdfPath>& paths)
+{
+    // The objects of each op in the order they're listed, where the GeoInfos
+    // sharing a source id are one object drawn as instances.
+    struct OpObjects
+    {
+        SdfPath opPath;
+        std::vector<HdNukeObjectKey> keys;
+        std::vector<GeoInfoVector> members;
+        std::unordered_map<Hash, size_t> objectsBySrcId;
+    };
+    std::vector<OpObjects> ops;
+    GeoOpPtrMap<size_t> opIndices;
+    for (GeoInfo* geoInfo : geoList) {
+        const TfToken primType = GetRprimType(*geoInfo);
+        if (primType.IsEmpty()) {
+            continue;
+        }
+        GeoOp* sourceOp = op_cast<GeoOp*>(geoInfo->final_geo);
+        auto opIndex = opIndices.emplace(sourceOp, ops.size());
+        if (opIndex.second) {
+            ops.emplace_back();
+            ops.back().opPath = GetConfig().GeoRoot().AppendPath(GetPathFromOp(sourceOp));
+        }
+        OpObjects& op = ops[opIndex.first->second];
+        auto object = op.objectsBySrcId.emplace(geoInfo->src_id(), op.keys.size());
+        if (object.second) {
+            HdNukeObjectKey key;
+            key.srcId = geoInfo->src_id().value();
+            key.primType = primType.GetString();
+            key.name = GetGeoInfoName(*geoInfo);
+            key.adapterType = geoInfo->primitive(0)->getPrimitiveType() == eParticlesSprite
+                ? HdNukeAdapterManagerPrimTypes->ParticleSprite.GetString()
+                : HdNukeAdapterManagerPrimTypes->GenericGeoInfo.GetString();
+            op.keys.push_back(std::move(key));
+            op.members.emplace_back();
+        }
+        GeoInfoVector& members = op.members[object.first->second];
+        members.push_back(geoInfo);
+        if (members.size() == 2) {
+            op.keys[object.first->second].adapterType =
+                HdNukeAdapterManagerPrimTypes->InstancedGeo.GetString();
+        }
+    }
+
+    SdfPathMap<HdNukeObjectIdentities> objectIdentities;
+    for (const OpObjects& op : ops) {
+        std::vector<std::string> ids;
+        auto previous = _objectIdentities.find(op.opPath);
+        if (update) {
+            HdNukeObjectIdentities& identities = objectIdentities[op.opPath];
+            if (previous != _objectIdentities.end()) {
+                identities = std::move(previous->second);
+            }
+            ids = identities.Update(op.keys);
+        }
+        else if (previous != _objectIdentities.end()) {
+            ids = previous->second.Match(op.keys);
+        }
+        else {
+            ids = HdNukeObjectIdentities().Match(op.keys);
+        }
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            const SdfPath path = op.opPath.AppendPath(SdfPath(ids[i]));
+            for (const GeoInfo* geoInfo : op.members[i]) {
+                paths[geoInfo] = path;
+            }
+        }
+    }
+    if (update) {
+        _objectIdentities.swap(objectIdentities);
+    }
+}
+
 void
 HdNukeSceneDelegate::SyncNukeGeometry(DD::Image::ViewerContext* context, const std::vector<GeoInfo*>& geoList)
 {
     sharedState._viewerContext = context;
 
+    std::unordered_map<const GeoInfo*, SdfPath> geoInfoPaths;
+    _AssignGeoInfoPaths(geoList, true, geoInfoPaths);
+    _geoInfoPaths.swap(geoInfoPaths);
+
     GeoOpPtrMap<std::unordered_map<Hash, GeoInfoVector>> geoSourceMap;
     for (GeoInfo* geoInfo : geoList) {
         GeoOp* sourceOp = op_cast<GeoOp*>(geoInfo->final_geo);
         geoSourceMap[sourceOp][geoInfo->src_id()].push_back(geoInfo);
     }
 
+    GeoInfoVector singleGeoInfos;
     for (auto e : geoSourceMap) {
         for (auto w : e.second) {
             if (w.second.size() == 1) {
-                _adapterManager.Request(w.second.front());
+                singleGeoInfos.push_back(w.second.front());
             }
             else {
                 _adapterManager.Request(w.second);
             }
         }
     }
+
+    // Instanced groups keep all their members, so a group partly in view
+    // doesn't change its instance count from frame to frame.
+    if (sharedState.cullToFrustum) {
+        _CullToFrustum(singleGeoInfos);
+    }
+    if (sharedState.instanceCards) {
+        _InstanceCards(singleGeoInfos);
+    }
+    if (sharedState.instanceDuplicates) {
+        _InstanceDuplicates(singleGeoInfos);
+    }
+
+    // Small static meshes that share a material, display mode and subdivision
+    // scheme are merged into batches, keyed so that the batch paths are
+    // stable between syncs.
+    std::map<std::string, GeoInfoVector> batches;
+    SdfPathMap<Hash> geoHashes;
+    for (GeoInfo* geoInfo : singleGeoInfos) {
+        if (sharedState.batchStaticGeometry
+                && _IsBatchable(*geoInfo, geoHashes)) {
+            batches[_GetBatchKey(*geoInfo)].push_back(geoInfo);
+            continue;
+        }
+        _adapterManager.Request(geoInfo);
+    }
+    _geoHashes.swap(geoHashes);
+
+    const SdfPath batchRoot = GetConfig().GeoRoot().AppendChild(HdNukePathTokens->Batches);
+    for (auto& batch : batches) {
+        GeoInfoVector& members = batch.second;
+        if (members.size() == 1) {
+            _adapterManager.Request(members.front());
+            continue;
+        }
+        std::sort(members.begin(), members.end(),
+                  [this](const GeoInfo* a, const GeoInfo* b) {
+                      return GetGeoInfoPath(*a) < GetGeoInfoPath(*b);
+                  });
+        const SdfPath batchPath = batchRoot.AppendChild(TfToken(TfStringPrintf(
+            "batch_%zx", std::hash<std::string>()(batch.first))));
+        _adapterManager.Request(HdNukeAdapterManagerPrimTypes->GeoBatch,
+                                batchPath, VtValue(members));
+    }
+}
+
+bool
+HdNukeSceneDelegate::_IsBatchable(const GeoInfo& geoInfo,
+                                  SdfPathMap<Hash>& geoHashes) const
+{
+    if (geoInfo.points() > sharedState.batchPointLimit
+            || GetRprimType(geoInfo) != HdPrimTypeTokens->mesh) {
+        return false;
+    }
+    if (!_IsVisible(geoInfo)) {
+        return false;
+    }
+    // Batches carry colours per face vertex, which per primitive colours
+    // can't be spread over without the faces of each primitive.
+    if (geoInfo.get_typed_group_attribcontext(
+            Group_Primitives, HdNukeTokens->Cf.GetText(), VECTOR4_ATTRIB) != nullptr) {
+        return false;
+    }
+
+    // Anything that changed since the last sync is taken to be animated, and
+    // is kept out of the batches so they don't have to be rebuilt every
+    // frame. Geometry seen for the first time is assumed to be static.
+    const SdfPath path = GetGeoInfoPath(geoInfo);
+    const Hash hash = geoInfo.final_geo->Op::hash();
+    geoHashes[path] = hash;
+    auto previous = _geoHashes.find(path);
+    return previous == _geoHashes.end() || previous->second == hash;
+}
+
+void
+HdNukeSceneDelegate::_CullToFrustum(GeoInfoVector& geoInfos) const
+{
+    if (!sharedState.haveCullCamera) {
+        return;
+    }
+
+    // Geometry that isn't requested is removed at the end of the sync, and
+    // set up again once it comes back into view.
+    const double* viewProjection = sharedState.cullViewProjection.data();
+    const GfVec3d margin(sharedState.cullMargin);
+    auto outOfView = [&](const GeoInfo* geoInfo) {
+        const Vector3& min = geoInfo->bbox().min();
+        const Vector3& max = geoInfo->bbox().max();
+        const GfRange3d bounds(GfVec3d(min.x, min.y, min.z),
+                               GfVec3d(max.x, max.y, max.z));
+        if (bounds.IsEmpty()) {
+            return false;
+        }
+        const GfRange3d worldBounds =
+            GfBBox3d(bounds, DDToGfMatrix4d(geoInfo->matrix)).ComputeAlignedRange();
+        const GfVec3d worldMin = worldBounds.GetMin() - margin;
+        const GfVec3d worldMax = worldBounds.GetMax() + margin;
+        return !HdNukeIsBoxInFrustum(worldMin.data(), worldMax.data(),
+                                     viewProjection);
+    };
+    geoInfos.erase(std::remove_if(geoInfos.begin(), geoInfos.end(), outOfView),
+                   geoInfos.end());
+}
+
+void
+HdNukeSceneDelegate::_InstanceCards(GeoInfoVector& geoInfos)
+{
+    GeoInfoVector candidates;
+    GeoInfoVector remaining;
+    for (GeoInfo* geoInfo : geoInfos) {
+        if (_IsVisible(*geoInfo)) {
+            candidates.push_back(geoInfo);
+        }
+        else {
+            remaining.push_back(geoInfo);
+        }
+    }
+
+    // Matching reads the whole of the geometry, so as with fingerprints the
+    // result is kept while the op hash stays the same.
+    std::vector<SdfPath> paths(candidates.size());
+    std::vector<_CardMatch> matches(candidates.size());
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const GeoInfo& geoInfo = *candidates[i];
+        paths[i] = GetGeoInfoPath(geoInfo);
+        const Hash opHash = geoInfo.final_geo->Op::hash();
+        auto previous = _cardMatches.find(paths[i]);
+        if (previous != _cardMatches.end() && previous->second.opHash == opHash) {
+            matches[i] = previous->second;
+        }
+        else {
+            matches[i].opHash = opHash;
+            changed.push_back(i);
+        }
+    }
+    tbb::parallel_for(size_t(0), changed.size(), [&](size_t i) {
+        _CardMatch& match = matches[changed[i]];
+        match.isCard = HdNukeCardInstancesAdapter::MatchCard(
+            *candidates[changed[i]], &match.cardTransform);
+    });
+    SdfPathMap<_CardMatch> cardMatches;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        cardMatches[paths[i]] = matches[i];
+    }
+    _cardMatches.swap(cardMatches);
+
+    std::map<std::string, std::vector<size_t>> cardSets;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (matches[i].isCard) {
+            cardSets[_GetBatchKey(*candidates[i])].push_back(i);
+        }
+        else {
+            remaining.push_back(candidates[i]);
+        }
+    }
+
+    const SdfPath cardRoot = GetConfig().GeoRoot().AppendChild(HdNukePathTokens->Cards);
+    for (auto& cardSet : cardSets) {
+        std::vector<size_t>& indices = cardSet.second;
+        if (indices.size() == 1) {
+            remaining.push_back(candidates[indices.front()]);
+            continue;
+        }
+        std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+            return paths[a] < paths[b];
+        });
+        HdNukeCardSet cards;
+        cards.geoInfos.reserve(indices.size());
+        cards.cardTransforms.reserve(indices.size());
+        for (size_t i : indices) {
+            cards.geoInfos.push_back(candidates[i]);
+            cards.cardTransforms.push_back(matches[i].cardTransform);
+        }
+        const SdfPath cardsPath = cardRoot.AppendChild(TfToken(TfStringPrintf(
+            "cards_%zx", std::hash<std::string>()(cardSet.first))));
+        _adapterManager.Request(HdNukeAdapterManagerPrimTypes->CardInstances,
+                                cardsPath, VtValue(cards));
+    }
+    geoInfos.swap(remaining);
+}
+
+void
+HdNukeSceneDelegate::_InstanceDuplicates(GeoInfoVector& geoInfos)
+{
+    // The instanced prototype doesn't follow changes to visibility or
+    // shadow casting, so only visible shadow casting meshes are considered.
+    GeoInfoVector candidates;
+    GeoInfoVector remaining;
+    for (GeoInfo* geoInfo : geoInfos) {
+        if (GetRprimType(*geoInfo) == HdPrimTypeTokens->mesh
+                && _IsVisible(*geoInfo) && geoInfo->renderState.castShadow) {
+            candidates.push_back(geoInfo);
+        }
+        else {
+            remaining.push_back(geoInfo);
+        }
+    }
+
+    // Fingerprinting reads all of the geometry, so fingerprints are kept for
+    // as long as the op hash doesn't change and only new or changed
+    // GeoInfos are fingerprinted again.
+    std::vector<SdfPath> paths(candidates.size());
+    std::vector<HdNukeContentHash> fingerprints(candidates.size());
+    std::vector<size_t> changed;
+    SdfPathMap<_GeoFingerprint> geoFingerprints;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const GeoInfo& geoInfo = *candidates[i];
+        paths[i] = GetGeoInfoPath(geoInfo);
+        const Hash opHash = geoInfo.final_geo->Op::hash();
+        auto previous = _geoFingerprints.find(paths[i]);
+        if (previous != _geoFingerprints.end() && previous->second.opHash == opHash) {
+            fingerprints[i] = previous->second.fingerprint;
+        }
+        else {
+            changed.push_back(i);
+        }
+    }
+    tbb::parallel_for(size_t(0), changed.size(), [&](size_t i) {
+        fingerprints[changed[i]] =
+            HdNukeGeoAdapter::GetContentFingerprint(*candidates[changed[i]]);
+    });
+    for (size_t i = 0; i < candidates.size(); i++) {
+        geoFingerprints[paths[i]] = _GeoFingerprint{
+            candidates[i]->final_geo->Op::hash(), fingerprints[i]};
+    }
+    _geoFingerprints.swap(geoFingerprints);
+
+    // Copies are only interchangeable if they also share a material and
+    // display mode, so those go into the key as well.
+    std::unordered_map<HdNukeContentHash, std::vector<size_t>, HdNukeContentHash::Hasher> duplicates;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const std::string batchKey = _GetBatchKey(*candidates[i]);
+        const HdNukeContentHash key =
+            HdNukeHashContent(batchKey.data(), batchKey.size(), fingerprints[i]);
+        duplicates[key].push_back(i);
+    }
+
+    const SdfPath duplicateRoot = GetConfig().GeoRoot().AppendChild(HdNukePathTokens->Duplicates);
+    for (auto& duplicate : duplicates) {
+        std::vector<size_t>& indices = duplicate.second;
+        if (indices.size() == 1) {
+            remaining.push_back(candidates[indices.front()]);
+            continue;
+        }
+        // The first copy by path is the prototype.
+        std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+            return paths[a] < paths[b];
+        });
+        GeoInfoVector copies;
+        copies.reserve(indices.size());
+        for (size_t i : indices) {
+            copies.push_back(candidates[i]);
+        }
+        // The prototype is named after its first copy rather than the
+        // content, so copies that change together keep their prototype and
+        // instancer, which pick up the changes on update.
+        const SdfPath prototypePath =
+            paths[indices.front()].ReplacePrefix(GetConfig().GeoRoot(), duplicateRoot);
+        _adapterManager.Request(HdNukeAdapterManagerPrimTypes->DuplicateGeo,
+                                prototypePath, VtValue(copies));
+    }
+    geoInfos.swap(remaining);
+}
+
+bool
+HdNukeSceneDelegate::_IsVisible(const GeoInfo& geoInfo) const
+{
+    return sharedState.interactive ? geoInfo.display3d != DISPLAY_OFF
+                                   : geoInfo.render_mode != RENDER_OFF;
+}
+
+std::string
+HdNukeSceneDelegate::_GetBatchKey(const GeoInfo& geoInfo) const
+{
+    std::ostringstream key;
+    if (geoInfo.material != nullptr) {
+        key << GetPathFromOp(geoInfo.material);
+    }
+    key << '_' << geoInfo.display3d << '_' << geoInfo.render_mode
+        << '_' << geoInfo.renderState.castShadow
+        << '_' << HdNukeGeoAdapter::GetSubdivScheme(geoInfo, sharedState.subdivScheme);
+    return key.str();
 }
 
 void
@@ -375,6 +868,9 @@ HdNukeSceneDelegate::SyncFromGeoOp(DD::Image::ViewerContext* context, GeoOp* geo
         return;
     }
 
+    _previousMotionFrames.swap(_motionFrames);
+    _motionFrames.clear();
+
     geoOp->build_scene(_scene);
 
     SyncNukeGeometry(context, _scene.object_list());
@@ -389,6 +885,81 @@ HdNukeSceneDelegate::SyncFromGeoOp(DD::Image::ViewerContext* context, GeoOp* geo
     }
 }
 
+void
+HdNukeSceneDelegate::SyncMotionSample(GeoOp* geoOp, float sampleTime)
+{
+    TF_VERIFY(geoOp);
+
+    if (not geoOp->valid()) {
+        TF_CODING_ERROR("SyncMotionSample called with unvalidated GeoOp");
+        return;
+    }
+
+    // Renders of neighbouring frames often sample the same times, so look
+    // for the geometry in the cache before building the scene.
+    const double frame = geoOp->outputContext().frame();
+    const uint64_t hash = geoOp->Op::hash().value();
+    std::shared_ptr<const _MotionSamples> samples = _motionSampleCache.Find(frame, hash);
+    if (!samples) {
+        auto newSamples = std::make_shared<_MotionSamples>();
+        Scene scene;
+        geoOp->build_scene(scene);
+        GeometryList& geoList = *scene.object_list();
+        std::vector<GeoInfo*> geoInfos;
+        geoInfos.reserve(geoList.size());
+        for (unsigned int i = 0; i < geoList.size(); i++) {
+            geoInfos.push_back(&geoList.object(i));
+        }
+        // The objects are matched to the prims of the current sync.
+        std::unordered_map<const GeoInfo*, SdfPath> paths;
+        _AssignGeoInfoPaths(geoInfos, false, paths);
+
+        // GeoInfos sharing a path are drawn as instances, whose transforms
+        // aren't sampled.
+        SdfPathSet instancedPaths;
+        for (const auto& geoInfoPath : paths) {
+            const GeoInfo& geoInfo = *geoInfoPath.first;
+            const SdfPath& path = geoInfoPath.second;
+
+            _MotionSample sample;
+            sample.transform = DDToGfMatrix4d(geoInfo.matrix);
+            if (const PointList* pointList = geoInfo.point_list()) {
+                const auto* rawPoints = reinterpret_cast<const GfVec3f*>(pointList->data());
+                sample.points.assign(rawPoints, rawPoints + pointList->size());
+            }
+            if (!newSamples->emplace(path, std::move(sample)).second) {
+                instancedPaths.insert(path);
+            }
+        }
+        for (const SdfPath& path : instancedPaths) {
+            newSamples->erase(path);
+        }
+
+        samples = newSamples;
+        _motionSampleCache.Insert(frame, hash, samples);
+    }
+
+    // Prims only ask for their samples again when they're dirtied, so dirty
+    // the ones sampled differently to the last sync.
+    const size_t index = _motionFrames.size();
+    _motionFrames.push_back({sampleTime, samples});
+    if (index < _previousMotionFrames.size()
+            && _previousMotionFrames[index].time == sampleTime
+            && _previousMotionFrames[index].samples == samples) {
+        return;
+    }
+    HdRenderIndex& renderIndex = GetRenderIndex();
+    HdChangeTracker& changeTracker = renderIndex.GetChangeTracker();
+    for (const auto& sample : *samples) {
+        if (_adapterManager.GetPrimType(sample.first) == HdNukeAdapterManagerPrimTypes->GenericGeoInfo
+                && renderIndex.GetRprim(sample.first) != nullptr) {
+            changeTracker.MarkRprimDirty(sample.first,
+                                         HdChangeTracker::DirtyTransform
+                                         | HdChangeTracker::DirtyPoints);
+        }
+    }
+}
+
 void
 HdNukeSceneDelegate::SyncHydraOp(HydraOp* hydraOp)
 {
@@ -398,8 +969,8 @@ HdNukeSceneDelegate::SyncHydraOp(HydraOp* hydraOp)
 
 void HdNukeSceneDelegate::BeginSync()
 {
-    _adapterManager.TryFulfillPromises();
     _adapterManager.SetAllUnused();
+    _adapterManager.TryFulfillPromises();
 }
 
 void HdNukeSceneDelegate::EndSync()
@@ -426,6 +997,14 @@ void
 HdNukeSceneDelegate::ClearNukeGeo()
 {
     _adapterManager.Clear();
+    _geoHashes.clear();
+    _motionFrames.clear();
+    _previousMotionFrames.clear();
+    _motionSampleCache.Clear();
+    _geoFingerprints.clear();
+    _cardMatches.clear();
+    _objectIdentities.clear();
+    _geoInfoPaths.clear();
     GetRenderIndex().RemoveSubtree(GetConfig().GeoRoot(), this);
 }
 
@@ -482,6 +1061,29 @@ HdNukeSceneDelegate::SetCameraMatrices(const DD::Image::Matrix4& modelMatrix, co
     sharedState.modelView = modelMatrix;
     sharedState.viewModel = sharedState.modelView.inverse();
     sharedState.projMatrix = projMatrix;
+    SetCullingCamera(DDToGfMatrix4d(modelMatrix) * DDToGfMatrix4d(projMatrix));
+}
+
+void
+HdNukeSceneDelegate::SetCullingCamera(const GfMatrix4d& viewProjection)
+{
+    sharedState.cullViewProjection = viewProjection;
+    sharedState.haveCullCamera = true;
+}
+
+void
+HdNukeSceneDelegate::SetMotionBlur(HdNukeMotionBlur motionBlur,
+                                   const std::vector<float>& sampleTimes)
+{
+    sharedState.motionBlur = motionBlur;
+    sharedState.motionSampleTimes = sampleTimes;
+    // Keep the times of the last render as well as the current one's.
+    _motionSampleCache.SetCapacity(motionBlur == HdNukeMotionBlur::Evaluate
+                                   ? 2 * sampleTimes.size() : 0);
+    if (motionBlur != HdNukeMotionBlur::Evaluate) {
+        _motionFrames.clear();
+        _previousMotionFrames.clear();
+    }
 }
 
 void
@@ -32,7 +32,9 @@
 #include "instancerAdapter.h"
 #include "lightAdapter.h"
 #include "materialAdapter.h"
+#include "objectIdentity.h"
 #include "sharedState.h"
+#include "timeSampleCache.h"
 #include "types.h"
 
 
@@ -59,8 +61,16 @@ public:
 
     GfMatrix4d GetTransform(const SdfPath& id) override;
 
+    size_t SampleTransform(const SdfPath& id, size_t maxSampleCount,
+                           float* sampleTimes,
+                           GfMatrix4d* sampleValues) override;
+    size_t SamplePrimvar(const SdfPath& id, const TfToken& key,
+                         size_t maxSampleCount, float* sampleTimes,
+                         VtValue* sampleValues) override;
+
     bool GetVisible(const SdfPath& id) override;
     bool GetDoubleSided(const SdfPath& id) override;
+    HdDisplayStyle GetDisplayStyle(const SdfPath& id) override;
 
     VtValue Get(const SdfPath& id, const TfToken& key) override;
 
@@ -83,6 +93,21 @@ public:
     SdfPath GetRprimSubPath(const DD::Image::GeoInfo& geoInfo,
                             const TfToken& primType) const;
 
+    /// Returns the path of the prim \p geoInfo is converted to in the current
+    /// sync. Objects keep their paths between syncs when upstream edits
+    /// change their source ids, so the prims are updated rather than replaced.
+    ///
+    /// Unlike source ids, which copies of a source through different ops
+    /// share, paths tell GeoInfos apart. The caches kept between syncs are
+    /// keyed by them, and batches, card sets and duplicates order their
+    /// GeoInfos by them so the result doesn't depend on the order Nuke lists
+    /// the GeoInfos in.
+    SdfPath GetGeoInfoPath(const DD::Image::GeoInfo& geoInfo) const;
+
+    /// Returns the content fingerprint worked out for \p geoInfo when looking
+    /// for duplicates in the current sync, or an empty hash if there wasn't one.
+    HdNukeContentHash GetContentFingerprint(const DD::Image::GeoInfo& geoInfo) const;
+
     inline const SdfPath& DefaultMaterialId() const { return _defaultMaterialId; }
     inline const SdfPath& DefaultParticleMaterialId() const { return _defaultParticleMaterialId; }
 
@@ -100,6 +125,10 @@ public:
     void EndSync();
 
     void SyncFromGeoOp(DD::Image::ViewerContext* context, DD::Image::GeoOp* geoOp);
+    /// Records the geometry of \p geoOp, the op synced from evaluated
+    /// \p sampleTime frames away from the current frame, as motion samples.
+    /// Call after SyncFromGeoOp, once for each motion sample time in order.
+    void SyncMotionSample(DD::Image::GeoOp* geoOp, float sampleTime);
     void SyncHydraOp(HydraOp* hydraOp);
 
     void ClearNukePrims();
@@ -107,6 +136,35 @@ public:
     void ClearAll();
 
     void SetUseEmissiveTextures(bool enable) { GetSharedState()->useEmissiveTextures = enable; }
+    void SetZeroCopyBuffers(bool enable) { GetSharedState()->zeroCopyBuffers = enable; }
+    void SetParallelPrimvars(bool enable) { GetSharedState()->parallelPrimvars = enable; }
+    void SetLazyPrimvars(bool enable) { GetSharedState()->lazyPrimvars = enable; }
+    void SetFilterPrimvars(bool enable) { GetSharedState()->filterPrimvars = enable; }
+    void SetPrimvarWhitelist(const std::string& patterns) { GetSharedState()->primvarWhitelist = patterns; }
+    void SetShareBuffers(bool enable) { GetSharedState()->shareBuffers = enable; }
+    void SetVerifyContentChanges(bool enable) { GetSharedState()->verifyContentChanges = enable; }
+    void SetPromoteFaceVarying(bool enable) { GetSharedState()->promoteFaceVarying = enable; }
+    void SetWeldVertices(bool enable) { GetSharedState()->weldVertices = enable; }
+    void SetWeldTolerance(float tolerance) { GetSharedState()->weldTolerance = tolerance; }
+    void SetSubdivScheme(const TfToken& scheme) { GetSharedState()->subdivScheme = scheme; }
+    void SetSubdivRefineLevel(int level) { GetSharedState()->subdivRefineLevel = level; }
+    void SetChunkMeshes(bool enable) { GetSharedState()->chunkMeshes = enable; }
+    void SetChunkFaceBudget(size_t faceBudget) { GetSharedState()->chunkFaceBudget = faceBudget; }
+    void SetBatchStaticGeometry(bool enable) { GetSharedState()->batchStaticGeometry = enable; }
+    void SetBatchPointLimit(size_t pointLimit) { GetSharedState()->batchPointLimit = pointLimit; }
+    void SetInstanceDuplicates(bool enable) { GetSharedState()->instanceDuplicates = enable; }
+    void SetInstanceCards(bool enable) { GetSharedState()->instanceCards = enable; }
+    void SetBuildLods(bool enable) { GetSharedState()->buildLods = enable; }
+    void SetLodFaceThreshold(size_t faceThreshold) { GetSharedState()->lodFaceThreshold = faceThreshold; }
+    void SetCullToFrustum(bool enable) { GetSharedState()->cullToFrustum = enable; }
+    void SetCullMargin(float margin) { GetSharedState()->cullMargin = margin; }
+    /// Sets the camera geometry is culled against, as the product of its
+    /// view and projection matrices.
+    void SetCullingCamera(const GfMatrix4d& viewProjection);
+    /// Sets how geometry is sampled for motion blur, and the times it is
+    /// sampled at, in frames relative to the current one.
+    void SetMotionBlur(HdNukeMotionBlur motionBlur,
+                       const std::vector<float>& sampleTimes);
     void SetSyncLights(bool sync) { _syncLights = sync; }
 
     /// Set interactive mode. This causes reprs to come from geo display mode instead of render mode.
@@ -132,6 +190,45 @@ protected:
     void ClearNukeMaterials();
 
 private:
+    bool _IsBatchable(const DD::Image::GeoInfo& geoInfo,
+                      SdfPathMap<DD::Image::Hash>& geoHashes) const;
+    std::string _GetBatchKey(const DD::Image::GeoInfo& geoInfo) const;
+    bool _IsVisible(const DD::Image::GeoInfo& geoInfo) const;
+    // Removes the GeoInfos that are out of view of the culling camera.
+    void _CullToFrustum(GeoInfoVector& geoInfos) const;
+    // Draws cards as instances of a unit card, and leaves the other GeoInfos
+    // in geoInfos.
+    void _InstanceCards(GeoInfoVector& geoInfos);
+    // Draws GeoInfos with the same content as instances of one prototype,
+    // and leaves the others in geoInfos.
+    void _InstanceDuplicates(GeoInfoVector& geoInfos);
+
+    // Works out the paths of the prims the GeoInfos in geoList are converted
+    // to. With update set, the objects of each op are matched against the
+    // last sync's and kept for the next, otherwise against the current
+    // sync's.
+    void _AssignGeoInfoPaths(const std::vector<DD::Image::GeoInfo*>& geoList,
+                             bool update,
+                             std::unordered_map<const DD::Image::GeoInfo*, SdfPath>& paths);
+
+    // The transform and Nuke's points of a GeoInfo at one time.
+    struct _MotionSample
+    {
+        GfMatrix4d transform;
+        VtVec3fArray points;
+    };
+    using _MotionSamples = SdfPathMap<_MotionSample>;
+    struct _MotionFrame
+    {
+        float time;
+        std::shared_ptr<const _MotionSamples> samples;
+    };
+
+    // Finds the motion samples of the prim at id in each of the motion
+    // frames of the current sync. Returns false if it's missing from any.
+    bool _GetMotionSamples(const SdfPath& id,
+                           std::vector<const _MotionSample*>& samples);
+
     friend class HydraOpManager;
 
     HdNukeDelegateConfig _config;
@@ -146,6 +243,42 @@ private:
     SdfPath _defaultMaterialId;
     SdfPath _defaultParticleMaterialId;
     bool _syncLights;
+
+    // The ids of the objects of each op, by op path, and the paths of the
+    // GeoInfos of the current sync.
+    SdfPathMap<HdNukeObjectIdentities> _objectIdentities;
+    std::unordered_map<const DD::Image::GeoInfo*, SdfPath> _geoInfoPaths;
+
+    // The op hash of each GeoInfo in the last sync, by path, used to keep
+    // animated geometry out of batches.
+    SdfPathMap<DD::Image::Hash> _geoHashes;
+
+    // The content fingerprint of each GeoInfo in the last sync and the op
+    // hash it was worked out for, by path.
+    struct _GeoFingerprint
+    {
+        DD::Image::Hash opHash;
+        HdNukeContentHash fingerprint;
+    };
+    SdfPathMap<_GeoFingerprint> _geoFingerprints;
+
+    // Whether each GeoInfo in the last sync was a card, and where the unit
+    // card goes if it was, by path.
+    struct _CardMatch
+    {
+        DD::Image::Hash opHash;
+        bool isCard = false;
+        GfMatrix4d cardTransform;
+    };
+    SdfPathMap<_CardMatch> _cardMatches;
+
+    // The geometry at each motion sample time of the current sync, and the
+    // last sync's, and the geometry converted for the last few sample
+    // times, so renders of neighbouring frames share the times they have in
+    // common.
+    std::vector<_MotionFrame> _motionFrames;
+    std::vector<_MotionFrame> _previousMotionFrames;
+    HdNukeTimeSampleCache<_MotionSamples> _motionSampleCache{0};
 };
 
 
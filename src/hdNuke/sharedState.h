@@ -16,11 +16,16 @@
 #define HDNUKE_SHAREDSTATE_H
 
 #include <pxr/pxr.h>
+#include <pxr/base/gf/matrix4d.h>
 #include <pxr/base/gf/vec3f.h>
 #include <pxr/imaging/hd/rprimCollection.h>
+#include <pxr/imaging/pxOsd/tokens.h>
 
 #include "DDImage/Matrix4.h"
 
+#include <string>
+#include <vector>
+
 namespace DD
 {
 namespace Image
@@ -32,6 +37,17 @@ class ViewerContext;
 PXR_NAMESPACE_OPEN_SCOPE
 
 
+// Where the motion samples of geometry come from.
+enum class HdNukeMotionBlur
+{
+    // Geometry is sampled once, at the current frame.
+    Off,
+    // The geometry ops are evaluated again at each sample time.
+    Evaluate,
+    // Points are moved along their vel attribute to each sample time.
+    Velocity
+};
+
 // Container for common parameters that adapters may need access to.
 struct AdapterSharedState
 {
@@ -50,6 +66,66 @@ struct AdapterSharedState
     int viewportWidth = 100;
     int viewportHeight = 100;
     bool useEmissiveTextures = false;
+    // Hand Hydra arrays that point at Nuke's geometry buffers when their
+    // memory layout allows it, instead of copying them. Nuke may rewrite those
+    // buffers in place, changing arrays a render delegate already holds, so
+    // this is off unless asked for.
+    bool zeroCopyBuffers = false;
+    // Convert the attributes of a GeoInfo to primvars concurrently.
+    bool parallelPrimvars = true;
+    // Only work out the primvar descriptors on update, and convert each
+    // attribute when the render delegate first asks for it.
+    bool lazyPrimvars = false;
+    // Only convert the attributes renderers read on their own, those read by
+    // the material and those whose names match the space separated patterns
+    // of primvarWhitelist.
+    bool filterPrimvars = false;
+    std::string primvarWhitelist;
+    // Share identical topology and primvar arrays between adapters through
+    // the process-wide buffer pool.
+    bool shareBuffers = true;
+    // Hash points and topology on rebuild so the dirty bits only report what
+    // actually changed.
+    bool verifyContentChanges = true;
+    // Store face-varying primvars per point when all the face vertices of
+    // each point agree on the value.
+    bool promoteFaceVarying = false;
+    // Merge mesh points that are closer than weldTolerance, for geometry
+    // that was split per face by its reader.
+    bool weldVertices = false;
+    float weldTolerance = 1e-5f;
+    // The subdivision scheme of meshes that don't specify one, and the
+    // refine level delegates should use for the ones that subdivide.
+    TfToken subdivScheme = PxOsdOpenSubdivTokens->none;
+    int subdivRefineLevel = 1;
+    // Split meshes with more than chunkFaceBudget faces into spatially
+    // coherent rprims of at most that many faces each.
+    bool chunkMeshes = false;
+    size_t chunkFaceBudget = 1000000;
+    // Merge static meshes with at most batchPointLimit points that share a
+    // material and display mode into combined rprims.
+    bool batchStaticGeometry = false;
+    size_t batchPointLimit = 1000;
+    // Draw meshes with identical topology and primvars as instances of a
+    // single prototype, even when they come from different ops.
+    bool instanceDuplicates = false;
+    // Draw flat cards sharing a material and display mode as instances of a
+    // single unit card.
+    bool instanceCards = false;
+    // In interactive mode, build decimated levels of meshes with more than
+    // lodFaceThreshold faces and show them when the mesh is small on screen.
+    bool buildLods = false;
+    size_t lodFaceThreshold = 100000;
+    // Leave out geometry whose bounds, padded by cullMargin in world units,
+    // are outside the view of the camera given by cullViewProjection.
+    bool cullToFrustum = false;
+    float cullMargin = 0.0f;
+    bool haveCullCamera = false;
+    GfMatrix4d cullViewProjection{1.0};
+    // How geometry is sampled for motion blur, and the times it is sampled
+    // at, in frames relative to the current one.
+    HdNukeMotionBlur motionBlur = HdNukeMotionBlur::Off;
+    std::vector<float> motionSampleTimes;
 
     DD::Image::ViewerContext* _viewerContext;
     HdRprimCollection _shadowCollection;
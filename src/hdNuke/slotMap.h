@@ -0,0 +1,179 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_SLOTMAP_H
+#define HDNUKE_SLOTMAP_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Refers to a value in an HdNukeSlotMap.
+///
+/// A handle finds its value until the value is erased. After that it finds
+/// nothing, even once its slot has been given to another value.
+struct HdNukeSlotHandle
+{
+    static constexpr uint32_t InvalidIndex = 0xffffffffu;
+
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != InvalidIndex; }
+
+    bool operator==(const HdNukeSlotHandle& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const HdNukeSlotHandle& other) const { return !(*this == other); }
+};
+
+/// Stores values in one contiguous array and hands out handles to them.
+///
+/// Looking a value up by handle is two array accesses. The handle holds the
+/// index of a slot, which holds the index of the value and a generation that
+/// is bumped whenever the value is erased, so handles to erased values are
+/// told apart from handles to the values that took their slots.
+///
+/// Erasing moves the last value into the gap, so the values stay dense but
+/// pointers and references to them, and their order, don't survive an erase
+/// or an insert. Hold on to handles instead.
+template <typename T>
+class HdNukeSlotMap
+{
+public:
+    using Handle = HdNukeSlotHandle;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    /// Adds \p value and returns the handle to it.
+    Handle Insert(T value)
+    {
+        uint32_t slotIndex;
+        if (_freeSlots != Handle::InvalidIndex) {
+            slotIndex = _freeSlots;
+            _freeSlots = _slots[slotIndex].valueIndex;
+        }
+        else {
+            slotIndex = static_cast<uint32_t>(_slots.size());
+            _slots.push_back(_Slot{0, 1});
+        }
+        _Slot& slot = _slots[slotIndex];
+        slot.valueIndex = static_cast<uint32_t>(_values.size());
+        _values.push_back(std::move(value));
+        _valueSlots.push_back(slotIndex);
+        return Handle{slotIndex, slot.generation};
+    }
+
+    /// Erases the value \p handle refers to.
+    /// @return Whether there was such a value.
+    bool Erase(Handle handle)
+    {
+        if (!Contains(handle)) {
+            return false;
+        }
+        _Slot& slot = _slots[handle.index];
+        const uint32_t last = static_cast<uint32_t>(_values.size() - 1);
+        if (slot.valueIndex != last) {
+            _values[slot.valueIndex] = std::move(_values[last]);
+            _valueSlots[slot.valueIndex] = _valueSlots[last];
+            _slots[_valueSlots[last]].valueIndex = slot.valueIndex;
+        }
+        _values.pop_back();
+        _valueSlots.pop_back();
+        _Free(handle.index);
+        return true;
+    }
+
+    /// Returns whether \p handle refers to a value.
+    bool Contains(Handle handle) const
+    {
+        return handle.index < _slots.size()
+            && _slots[handle.index].generation == handle.generation;
+    }
+
+    /// Returns the value \p handle refers to, or nullptr if it was erased.
+    T* Get(Handle handle)
+    {
+        return Contains(handle) ? &_values[_slots[handle.index].valueIndex] : nullptr;
+    }
+
+    const T* Get(Handle handle) const
+    {
+        return Contains(handle) ? &_values[_slots[handle.index].valueIndex] : nullptr;
+    }
+
+    /// Returns the handle to the value at \p position in the array.
+    Handle GetHandle(size_t position) const
+    {
+        const uint32_t slotIndex = _valueSlots[position];
+        return Handle{slotIndex, _slots[slotIndex].generation};
+    }
+
+    /// Erases all the values. Handles to them no longer find anything.
+    void Clear()
+    {
+        for (uint32_t slotIndex : _valueSlots) {
+            _Free(slotIndex);
+        }
+        _values.clear();
+        _valueSlots.clear();
+    }
+
+    size_t GetSize() const { return _values.size(); }
+    bool IsEmpty() const { return _values.empty(); }
+
+    iterator begin() { return _values.begin(); }
+    iterator end() { return _values.end(); }
+    const_iterator begin() const { return _values.begin(); }
+    const_iterator end() const { return _values.end(); }
+
+private:
+    struct _Slot
+    {
+        // The index of the value, or of the next free slot if this is free.
+        uint32_t valueIndex;
+        uint32_t generation;
+    };
+
+    void _Free(uint32_t slotIndex)
+    {
+        _Slot& slot = _slots[slotIndex];
+        // Generation 0 is never live so default constructed handles don't
+        // find anything.
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+        slot.valueIndex = _freeSlots;
+        _freeSlots = slotIndex;
+    }
+
+    std::vector<T> _values;
+    // The slot of each value.
+    std::vector<uint32_t> _valueSlots;
+    std::vector<_Slot> _slots;
+    uint32_t _freeSlots = Handle::InvalidIndex;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HDNUKE_SLOTMAP_H
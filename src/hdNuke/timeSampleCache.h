@@ -0,0 +1,117 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_TIMESAMPLECACHE_H
+#define HDNUKE_TIMESAMPLECACHE_H
+
+#include <pxr/pxr.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Keeps what was worked out for the scene at a few different times, so
+/// renders of neighbouring frames can reuse the samples they share.
+///
+/// Each entry is keyed by the time it is for and a hash of the inputs it was
+/// worked out from, so an entry is only found again while its inputs are
+/// unchanged. Times are compared to within a ten thousandth of a frame, so
+/// times that come out slightly different from sums of shutter offsets
+/// still match. When the cache is full the least recently used entry is
+/// dropped.
+template <typename T>
+class HdNukeTimeSampleCache
+{
+public:
+    using ValuePtr = std::shared_ptr<const T>;
+
+    explicit HdNukeTimeSampleCache(size_t capacity) : _capacity(capacity) { }
+
+    /// Returns the entry for \p time worked out from inputs with hash
+    /// \p hash, or nullptr if there isn't one.
+    ValuePtr Find(double time, uint64_t hash)
+    {
+        const int64_t tick = _ToTick(time);
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->tick == tick && it->hash == hash) {
+                _entries.splice(_entries.begin(), _entries, it);
+                return it->value;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Stores \p value as the entry for \p time, replacing any entry there
+    /// already is for that time.
+    void Insert(double time, uint64_t hash, ValuePtr value)
+    {
+        const int64_t tick = _ToTick(time);
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->tick == tick) {
+                _entries.erase(it);
+                break;
+            }
+        }
+        _entries.push_front(_Entry{tick, hash, std::move(value)});
+        _Trim();
+    }
+
+    /// Sets the number of times kept, dropping the least recently used
+    /// entries over it.
+    void SetCapacity(size_t capacity)
+    {
+        _capacity = capacity;
+        _Trim();
+    }
+
+    size_t GetCapacity() const { return _capacity; }
+    size_t GetSize() const { return _entries.size(); }
+
+    void Clear() { _entries.clear(); }
+
+private:
+    static int64_t _ToTick(double time)
+    {
+        return static_cast<int64_t>(std::llround(time * 10000.0));
+    }
+
+    void _Trim()
+    {
+        while (_entries.size() > _capacity) {
+            _entries.pop_back();
+        }
+    }
+
+    struct _Entry
+    {
+        int64_t tick;
+        uint64_t hash;
+        ValuePtr value;
+    };
+
+    // Most recently used first.
+    std::list<_Entry> _entries;
+    size_t _capacity;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_TIMESAMPLECACHE_H
@@ -44,6 +44,12 @@ PXR_NAMESPACE_OPEN_SCOPE
     (doubleSided)                           \
     (instanceCount)                         \
     (reprSelector)                          \
+    (displayStyle)                          \
+    (subdivScheme)                          \
+    (batchMemberId)                         \
+    (batchMemberPaths)                      \
+    /* Not made public anywhere in USD */   \
+    (overrideWireframeColor)                \
     (shadowCollection)
 
 #define HDNUKE_PATH_TOKENS                  \
@@ -54,6 +60,9 @@ PXR_NAMESPACE_OPEN_SCOPE
     (Hydra)                                 \
     (NoCastShadow)                          \
     (defaultParticleMaterial)               \
+    (Batches)                               \
+    (Duplicates)                            \
+    (Cards)                                 \
     ((defaultSurface, "__defaultSurface"))
 
 
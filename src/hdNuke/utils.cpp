@@ -91,6 +91,37 @@ TfToken GetRprimType(const GeoInfo& geoInfo)
     return TfToken();
 }
 
+std::string GetGeoInfoName(const GeoInfo& geoInfo)
+{
+    const auto* nameCtx = geoInfo.get_group_attribcontext(Group_Object, "name");
+    if (not nameCtx or nameCtx->empty()
+            or (nameCtx->type != STRING_ATTRIB
+                and nameCtx->type != STD_STRING_ATTRIB))
+    {
+        return std::string();
+    }
+
+    void* rawData = nameCtx->attribute->array();
+    std::string attrValue;
+    if (nameCtx->type == STD_STRING_ATTRIB) {
+        attrValue = static_cast<std::string*>(rawData)[0];
+    }
+    else {
+        attrValue = std::string(static_cast<char**>(rawData)[0]);
+    }
+
+    // Replace any characters that are meaningful in SdfPath
+    std::replace_if(attrValue.begin(), attrValue.end(),
+      [](char c) { return c == ' ' || c == '<' || c == '>' || c == '[' || c == ']' || c == ':' || c == '.'; },
+      '_');
+
+    SdfPath result(attrValue);
+    if (result.IsAbsolutePath()) {
+        return result.MakeRelativePath(SdfPath::AbsoluteRootPath()).GetString();
+    }
+    return result.GetString();
+}
+
 SdfPath GetRprimSubPath(const GeoInfo& geoInfo, const TfToken& primType)
 {
     if (primType.IsEmpty()) {
@@ -104,33 +135,7 @@ SdfPath GetRprimSubPath(const GeoInfo& geoInfo, const TfToken& primType)
 
     // Look for an object-level "name" attribute on the geo, and if one is
     // found, use that in conjunction with the Rprim type name and hash.
-    const auto* nameCtx = geoInfo.get_group_attribcontext(Group_Object, "name");
-    if (nameCtx and not nameCtx->empty()
-            and (nameCtx->type == STRING_ATTRIB
-                 or nameCtx->type == STD_STRING_ATTRIB))
-    {
-        void* rawData = nameCtx->attribute->array();
-        std::string attrValue;
-        if (nameCtx->type == STD_STRING_ATTRIB) {
-            attrValue = static_cast<std::string*>(rawData)[0];
-        }
-        else {
-            attrValue = std::string(static_cast<char**>(rawData)[0]);
-        }
-
-        // Replace any characters that are meaningful in SdfPath
-        std::replace_if(attrValue.begin(), attrValue.end(),
-          [](char c) { return c == ' ' || c == '<' || c == '>' || c == '[' || c == ']' || c == ':' || c == '.'; },
-          '_');
-
-        SdfPath result(attrValue);
-        if (result.IsAbsolutePath()) {
-            buf << result.MakeRelativePath(SdfPath::AbsoluteRootPath());
-        }
-        else {
-          buf << result;
-        }
-    }
+    buf << GetGeoInfoName(geoInfo);
 
     return SdfPath(buf.str());
 }
@@ -22,6 +22,7 @@
 
 #include <pxr/usd/sdf/path.h>
 
+#include <DDImage/Attribute.h>
 #include <DDImage/Matrix3.h>
 #include <DDImage/Matrix4.h>
 #include <DDImage/Op.h>
@@ -29,6 +30,8 @@
 #include <DDImage/Knobs.h>
 
 
+#include "foreignDataSource.h"
+
 #include <cctype>
 
 namespace DD
@@ -51,6 +54,9 @@ inline SdfPath GetPathFromOp(const DD::Image::Op* op);
 template <typename T>
 inline VtValue DDAttrToVtArrayValue(const DD::Image::Attribute& geoAttr);
 
+template <typename T>
+inline VtValue DDAttrToForeignVtArrayValue(const DD::Image::AttributePtr& geoAttr);
+
 template <typename T>
 inline void ConvertHdBufferData(void* src, float* dest, size_t numPixels,
                                 size_t numComponents, bool packed);
@@ -114,6 +120,17 @@ DDAttrToVtArrayValue(const DD::Image::Attribute& geoAttr)
     return VtValue::Take(array);
 }
 
+/// Same as DDAttrToVtArrayValue, but the returned array points at the memory
+/// of \p geoAttr instead of copying it. T must have the same memory layout as
+/// the attribute elements.
+template <typename T>
+inline VtValue
+DDAttrToForeignVtArrayValue(const DD::Image::AttributePtr& geoAttr)
+{
+    return VtValue::Take(HdNukeMakeForeignArray<T>(
+        geoAttr, geoAttr->array(), geoAttr->size()));
+}
+
 template <typename T>
 inline void
 ConvertHdBufferData(void* src, float* dest, size_t numPixels,
@@ -168,6 +185,11 @@ inline T GetKnobValue(const DD::Image::Op *op, const std::string &knobName, cons
 /// Returns the primType for the given \p geoInfo.
 TfToken GetRprimType(const DD::Image::GeoInfo& geoInfo);
 
+/// Returns the object-level name attribute of \p geoInfo, with the characters
+/// that are meaningful in a SdfPath replaced, or an empty string if it has
+/// none.
+std::string GetGeoInfoName(const DD::Image::GeoInfo& geoInfo);
+
 /// Computes the RPrim subpath for the \p geoInfo given its \p primType.
 SdfPath GetRprimSubPath(const DD::Image::GeoInfo& geoInfo, const TfToken& primType);
 
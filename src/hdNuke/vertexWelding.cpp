@@ -0,0 +1,174 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "vertexWelding.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+    constexpr size_t kGrainSize = 4096;
+
+    struct Cell
+    {
+        int64_t x, y, z;
+    };
+
+    inline uint64_t MixBits(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDULL;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Different cells may share a key, which only costs a few more distance
+    // checks.
+    inline uint64_t CellKey(const Cell& cell)
+    {
+        uint64_t key = MixBits(static_cast<uint64_t>(cell.x));
+        key = MixBits(key ^ static_cast<uint64_t>(cell.y));
+        return MixBits(key ^ static_cast<uint64_t>(cell.z));
+    }
+
+    inline Cell CellOf(const float* point, float tolerance)
+    {
+        if (tolerance > 0.0f) {
+            return {static_cast<int64_t>(std::floor(point[0] / tolerance)),
+                    static_cast<int64_t>(std::floor(point[1] / tolerance)),
+                    static_cast<int64_t>(std::floor(point[2] / tolerance))};
+        }
+        // Exact matches only, so the bits of the position make the cell.
+        uint32_t bits[3];
+        std::memcpy(bits, point, sizeof(bits));
+        return {bits[0], bits[1], bits[2]};
+    }
+
+    inline bool IsWithin(const float* a, const float* b, float tolerance)
+    {
+        if (tolerance > 0.0f) {
+            const float dx = a[0] - b[0];
+            const float dy = a[1] - b[1];
+            const float dz = a[2] - b[2];
+            return dx * dx + dy * dy + dz * dz <= tolerance * tolerance;
+        }
+        return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+    }
+}
+
+HdNukeWeldMap
+HdNukeBuildWeldMap(const float* points, size_t numPoints, float tolerance)
+{
+    HdNukeWeldMap weldMap;
+    if (numPoints == 0 || !(tolerance >= 0.0f)) {
+        return weldMap;
+    }
+
+    // Bucket the points by cell, sorted by point within each cell.
+    std::vector<std::pair<uint64_t, int>> buckets(numPoints);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numPoints, kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                buckets[i] = {CellKey(CellOf(points + i * 3, tolerance)),
+                              static_cast<int>(i)};
+            }
+        });
+    tbb::parallel_sort(buckets.begin(), buckets.end());
+
+    // Find the lowest numbered point close enough to each point in its own
+    // and the neighbouring cells.
+    const int searchRadius = tolerance > 0.0f ? 1 : 0;
+    std::vector<int> nearest(numPoints);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numPoints, kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                const float* point = points + i * 3;
+                const Cell cell = CellOf(point, tolerance);
+                int best = static_cast<int>(i);
+                for (int dx = -searchRadius; dx <= searchRadius; dx++)
+                for (int dy = -searchRadius; dy <= searchRadius; dy++)
+                for (int dz = -searchRadius; dz <= searchRadius; dz++) {
+                    const uint64_t key = CellKey({cell.x + dx, cell.y + dy, cell.z + dz});
+                    auto it = std::lower_bound(buckets.begin(), buckets.end(),
+                                               std::make_pair(key, 0));
+                    for (; it != buckets.end() && it->first == key
+                           && it->second < best; ++it) {
+                        if (IsWithin(point, points + it->second * 3, tolerance)) {
+                            best = it->second;
+                            break;
+                        }
+                    }
+                }
+                nearest[i] = best;
+            }
+        });
+
+    // Follow the chains to the first point of each group and number the
+    // groups in order. Every point only refers to lower numbered ones, so a
+    // single pass does it.
+    weldMap.pointRemap.resize(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+        if (nearest[i] == static_cast<int>(i)) {
+            weldMap.pointRemap[i] = static_cast<int>(weldMap.representatives.size());
+            weldMap.representatives.push_back(static_cast<int>(i));
+        }
+        else {
+            weldMap.pointRemap[i] = weldMap.pointRemap[nearest[i]];
+        }
+    }
+
+    if (weldMap.representatives.size() == numPoints) {
+        return HdNukeWeldMap();
+    }
+    return weldMap;
+}
+
+void
+HdNukeRemapPointIndices(const HdNukeWeldMap& weldMap, int* indices,
+                        size_t numIndices)
+{
+    if (weldMap.IsEmpty()) {
+        return;
+    }
+
+    const int numPoints = static_cast<int>(weldMap.pointRemap.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numIndices, kGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+                const int index = indices[i];
+                if (index >= 0 && index < numPoints) {
+                    indices[i] = weldMap.pointRemap[index];
+                }
+            }
+        });
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
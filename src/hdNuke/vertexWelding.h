@@ -0,0 +1,64 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HDNUKE_VERTEXWELDING_H
+#define HDNUKE_VERTEXWELDING_H
+
+#include <pxr/pxr.h>
+
+#include <cstddef>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Maps the points of a mesh to a smaller set with coincident points merged.
+struct HdNukeWeldMap
+{
+    /// The welded point each original point was merged into.
+    std::vector<int> pointRemap;
+
+    /// The original point each welded point takes its position and
+    /// attributes from.
+    std::vector<int> representatives;
+
+    /// Returns whether no points were merged, in which case the map is left
+    /// empty and the mesh can be used as it is.
+    bool IsEmpty() const { return representatives.empty(); }
+
+    size_t GetWeldedPointCount() const { return representatives.size(); }
+};
+
+/// Welds the \p numPoints points at \p points, given as three floats each.
+///
+/// Points closer than \p tolerance to each other are merged, chaining
+/// through any point in between. Points are bucketed in a spatial hash with
+/// cells the size of the tolerance, so only neighbouring cells are searched.
+/// A tolerance of zero only merges points in exactly the same place.
+///
+/// Welded points keep the order of the first original point merged into
+/// them, so the result doesn't depend on the number of threads.
+HdNukeWeldMap HdNukeBuildWeldMap(const float* points, size_t numPoints,
+                                 float tolerance);
+
+/// Replaces each of the \p numIndices point indices at \p indices with the
+/// welded point it maps to.
+void HdNukeRemapPointIndices(const HdNukeWeldMap& weldMap, int* indices,
+                             size_t numIndices);
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // HDNUKE_VERTEXWELDING_H
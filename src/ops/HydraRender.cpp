@@ -41,6 +41,8 @@
 #include <hdNuke/renderStack.h>
 #include <hdNuke/utils.h>
 
+#include <algorithm>
+
 
 using namespace DD::Image;
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -50,6 +52,29 @@ static const char* const CLASS = "HydraRender";
 static const char* const HELP =
     "Renders a Nuke 3D scene using a Hydra render delegate.";
 
+// In the order of HdNukeMotionBlur.
+static const char* const motionBlurNames[] = {
+    "off",
+    "evaluate geometry",
+    "velocity",
+    0
+};
+
+static const char* const shutterOffsetNames[] = {
+    "centred",
+    "start",
+    "end",
+    0
+};
+
+static const char* const subdivSchemeNames[] = {
+    "none",
+    "catmullClark",
+    "loop",
+    "bilinear",
+    0
+};
+
 
 class HydraRender : public PlanarIop, public HdNukeKnobFactory
 {
@@ -60,6 +85,9 @@ public:
     const char* input_label(int index, char*) const override;
     Op* default_input(int index) const override;
     bool test_input(int index, Op* op) const override;
+    int split_input(int index) const override;
+    const OutputContext& inputContext(int index, int split,
+                                      OutputContext& context) const override;
 
     void knobs(Knob_Callback f) override;
     int knob_changed(Knob* k) override;
@@ -101,6 +129,9 @@ protected:
 
     void initRenderer() { initRenderer(_rendererId); }
     void initRenderer(const std::string& delegateId);
+    // The times geometry is sampled at for motion blur, in frames relative
+    // to the current one.
+    std::vector<float> motionSampleTimes() const;
 
     void copyBufferToImagePlane(HdRenderBuffer* buffer, ImagePlane& plane);
 
@@ -120,6 +151,32 @@ private:
     std::string _rendererId;
     int _rendererIndex = 0;
     float _displayColor[3] = {0.18, 0.18, 0.18};
+    bool _zeroCopyBuffers = false;
+    bool _parallelPrimvars = true;
+    bool _shareBuffers = true;
+    bool _verifyContentChanges = true;
+    bool _promoteFaceVarying = false;
+    bool _lazyPrimvars = false;
+    bool _filterPrimvars = false;
+    std::string _primvarWhitelist;
+    bool _weldVertices = false;
+    float _weldTolerance = 1e-5f;
+    int _subdivScheme = 0;
+    int _subdivRefineLevel = 1;
+    bool _chunkMeshes = false;
+    int _chunkFaceBudget = 1000000;
+    bool _batchStaticGeometry = false;
+    int _batchPointLimit = 1000;
+    bool _instanceDuplicates = false;
+    bool _instanceCards = false;
+    bool _buildLods = false;
+    int _lodFaceThreshold = 100000;
+    bool _cullToFrustum = false;
+    float _cullMargin = 0.0f;
+    int _motionBlur = 0;
+    int _motionSamples = 3;
+    float _shutter = 0.5f;
+    int _shutterOffset = 0;
 
     // The index of the first dynamic render delegate knob.
     int _renderDelegateKnobStartIndex = -1;
@@ -232,6 +289,30 @@ HydraRender::test_input(int index, Op* op) const
     return false;
 }
 
+int
+HydraRender::split_input(int index) const
+{
+    // The scene input is split into the current frame and one for each
+    // motion sample time.
+    if (index == 0 && _motionBlur == static_cast<int>(HdNukeMotionBlur::Evaluate)) {
+        return 1 + static_cast<int>(motionSampleTimes().size());
+    }
+    return 1;
+}
+
+const OutputContext&
+HydraRender::inputContext(int index, int split, OutputContext& context) const
+{
+    context = outputContext();
+    if (index == 0 && split > 0) {
+        const std::vector<float> times = motionSampleTimes();
+        if (static_cast<size_t>(split) <= times.size()) {
+            context.setFrame(context.frame() + times[split - 1]);
+        }
+    }
+    return context;
+}
+
 void
 HydraRender::append(Hash& hash)
 {
@@ -241,6 +322,11 @@ HydraRender::append(Hash& hash)
     if (GeoOp* geoOp = op_cast<GeoOp*>(Op::input(0))) {
         geoOp->append(hash);
     }
+    for (int split = 1; split < split_input(0); split++) {
+        if (GeoOp* sampleOp = op_cast<GeoOp*>(Op::input(0, split))) {
+            sampleOp->append(hash);
+        }
+    }
     if (Op* hydraOp = Op::input(2)) {
         hydraOp->append(hash);
     }
@@ -263,6 +349,150 @@ HydraRender::knobs(Knob_Callback f)
 
     Color_knob(f, _displayColor, "default_display_color", "default display color");
 
+    Bool_knob(f, &_zeroCopyBuffers, "zero_copy_buffers", "share Nuke's geometry memory");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Hand the renderer points and attributes that point straight "
+               "at Nuke's geometry memory instead of copies of them. This "
+               "saves memory and time on large geometry, but Nuke may rewrite "
+               "that memory in place when the geometry changes, which "
+               "renderers that keep or compare buffers can miss.");
+
+    Bool_knob(f, &_parallelPrimvars, "parallel_primvars", "convert primvars in parallel");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Convert the attributes of each piece of geometry on several "
+               "threads at once.");
+
+    Bool_knob(f, &_shareBuffers, "share_buffers", "share identical buffers");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Keep a single copy of topology and attribute data that is "
+               "the same across several pieces of geometry.");
+
+    Bool_knob(f, &_verifyContentChanges, "verify_content_changes", "only update changed data");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Compare the points and topology of geometry that Nuke reports "
+               "as changed with their previous contents, and only send the "
+               "renderer the ones that really differ.");
+
+    Bool_knob(f, &_promoteFaceVarying, "promote_facevarying", "promote face-varying primvars");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Store face-varying attributes such as uv and N once per point "
+               "when every face sharing a point has the same value for it.");
+
+    Bool_knob(f, &_lazyPrimvars, "lazy_primvars", "convert primvars on demand");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Convert attributes when the renderer asks for them, on its "
+               "own threads, rather than all of them up front. Attributes "
+               "the renderer doesn't use are never converted.");
+
+    Bool_knob(f, &_filterPrimvars, "filter_primvars", "only convert primvars in use");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Only convert the attributes the material of the geometry "
+               "reads, those renderers read on their own, such as normals "
+               "and Cf, and those matching the whitelist.");
+    String_knob(f, &_primvarWhitelist, "primvar_whitelist", "whitelist");
+    ClearFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Names of further attributes to convert when only primvars in "
+               "use are, separated by spaces. A * matches any run of "
+               "characters and a ? any single one, as in \"vel user_*\".");
+
+    Bool_knob(f, &_weldVertices, "weld_vertices", "weld vertices");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Merge mesh points closer together than the weld tolerance, "
+               "for geometry that was imported with every face unshared.");
+    Float_knob(f, &_weldTolerance, "weld_tolerance", "tolerance");
+    ClearFlags(f, Knob::STARTLINE | Knob::SLIDER);
+    Tooltip(f, "Distance below which points are merged when welding.");
+
+    Enumeration_knob(f, &_subdivScheme, subdivSchemeNames, "subdiv_scheme",
+                     "subdivision scheme");
+    Tooltip(f, "Subdivision scheme of meshes that don't have their own. A "
+               "subdivScheme object attribute on the geometry or a "
+               "subdiv_scheme knob on the geometry's node takes precedence.");
+    Int_knob(f, &_subdivRefineLevel, "subdiv_refine_level", "refine level");
+    ClearFlags(f, Knob::STARTLINE);
+    SetRange(f, 0, 8);
+    Tooltip(f, "How many times delegates that support it refine meshes "
+               "with a subdivision scheme.");
+
+    Bool_knob(f, &_chunkMeshes, "chunk_meshes", "chunk large meshes");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Split meshes with more faces than the face budget into "
+               "several prims covering separate regions of space, so they "
+               "can be converted, culled and updated in parts.");
+    Int_knob(f, &_chunkFaceBudget, "chunk_face_budget", "face budget");
+    ClearFlags(f, Knob::STARTLINE);
+    SetRange(f, 10000, 10000000);
+    Tooltip(f, "Largest number of faces in each chunk of a mesh.");
+
+    Bool_knob(f, &_batchStaticGeometry, "batch_static_geometry", "batch small static meshes");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Merge meshes with no more points than the point limit that "
+               "share a material, display mode and subdivision scheme into "
+               "combined prims. "
+               "Geometry that changes between updates is left out of the "
+               "batches.");
+    Int_knob(f, &_batchPointLimit, "batch_point_limit", "point limit");
+    ClearFlags(f, Knob::STARTLINE);
+    SetRange(f, 4, 100000);
+    Tooltip(f, "Largest number of points of a mesh that is batched.");
+
+    Bool_knob(f, &_instanceDuplicates, "instance_duplicates", "instance duplicate geometry");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Find meshes with the same topology and attributes, even from "
+               "different nodes, and draw them as instances of one prim "
+               "rather than converting each copy separately.");
+
+    Bool_knob(f, &_instanceCards, "instance_cards", "instance cards");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Draw flat cards that share a material and display mode as "
+               "instances of a single card, so large numbers of cards don't "
+               "each need a prim of their own. Cards with attributes other "
+               "than uvs and normals are drawn as usual.");
+
+    Bool_knob(f, &_buildLods, "build_lods", "decimate heavy meshes");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "In the viewer, build simplified versions of meshes with more "
+               "faces than the threshold in the background, and draw them "
+               "instead of the mesh when it is small on screen. Renders "
+               "always use the full mesh.");
+    Int_knob(f, &_lodFaceThreshold, "lod_face_threshold", "face threshold");
+    ClearFlags(f, Knob::STARTLINE);
+    SetRange(f, 1000, 10000000);
+    Tooltip(f, "Smallest number of faces of a mesh that is simplified.");
+
+    Bool_knob(f, &_cullToFrustum, "cull_to_frustum", "cull to camera frustum");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "Leave out geometry whose bounding box is outside the view of "
+               "the camera, so it isn't converted or rendered until it comes "
+               "into view.");
+    Float_knob(f, &_cullMargin, "cull_margin", "margin");
+    ClearFlags(f, Knob::STARTLINE);
+    SetRange(f, 0, 100);
+    Tooltip(f, "How far outside the view, in world units, geometry is still "
+               "kept, for shadows and reflections cast into view by objects "
+               "just out of it.");
+
+    Enumeration_knob(f, &_motionBlur, motionBlurNames, "motion_blur", "motion blur");
+    SetFlags(f, Knob::STARTLINE);
+    Tooltip(f, "How delegates that support motion blur are given geometry at "
+               "more than one time. 'evaluate geometry' evaluates the scene "
+               "again at each sample time, keeping what it converted for the "
+               "last few renders so neighbouring frames can share samples. "
+               "'velocity' moves points along their vel attribute instead, "
+               "without evaluating the scene again.");
+    Int_knob(f, &_motionSamples, "motion_samples", "samples");
+    ClearFlags(f, Knob::STARTLINE);
+    SetRange(f, 2, 16);
+    Tooltip(f, "Number of times geometry is sampled at over the shutter.");
+    Float_knob(f, &_shutter, "shutter", "shutter");
+    SetRange(f, 0, 2);
+    Tooltip(f, "How long the shutter is open for, in frames.");
+    Enumeration_knob(f, &_shutterOffset, shutterOffsetNames, "shutter_offset",
+                     "shutter offset");
+    ClearFlags(f, Knob::STARTLINE);
+    Tooltip(f, "When the shutter is open relative to the current frame: "
+               "centred on it, starting at it or ending at it.");
+
     Button(f, "force_update", "force update");
     SetFlags(f, Knob::STARTLINE);
 
@@ -312,6 +542,98 @@ HydraRender::knob_changed(Knob* k)
         sceneDelegate()->SetDefaultDisplayColor(GfVec3f(_displayColor));
         return 1;
     }
+    if (k->is("zero_copy_buffers")) {
+        sceneDelegate()->SetZeroCopyBuffers(_zeroCopyBuffers);
+    sceneDelegate()->SetParallelPrimvars(_parallelPrimvars);
+    sceneDelegate()->SetShareBuffers(_shareBuffers);
+    sceneDelegate()->SetVerifyContentChanges(_verifyContentChanges);
+        // Arrays already handed over keep pointing where they did, so start
+        // over.
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("parallel_primvars")) {
+        sceneDelegate()->SetParallelPrimvars(_parallelPrimvars);
+        return 1;
+    }
+    if (k->is("share_buffers")) {
+        sceneDelegate()->SetShareBuffers(_shareBuffers);
+        return 1;
+    }
+    if (k->is("verify_content_changes")) {
+        sceneDelegate()->SetVerifyContentChanges(_verifyContentChanges);
+        return 1;
+    }
+    if (k->is("lazy_primvars")) {
+        sceneDelegate()->SetLazyPrimvars(_lazyPrimvars);
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("motion_blur") || k->is("motion_samples") || k->is("shutter")
+            || k->is("shutter_offset")) {
+        sceneDelegate()->SetMotionBlur(static_cast<HdNukeMotionBlur>(_motionBlur),
+                                       motionSampleTimes());
+        // Velocities may have been left out of the converted primvars.
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("filter_primvars") || k->is("primvar_whitelist")) {
+        sceneDelegate()->SetFilterPrimvars(_filterPrimvars);
+        sceneDelegate()->SetPrimvarWhitelist(_primvarWhitelist);
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("promote_facevarying")) {
+        sceneDelegate()->SetPromoteFaceVarying(_promoteFaceVarying);
+        // Primvars are only converted again when they change, so start over.
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("weld_vertices") || k->is("weld_tolerance")) {
+        sceneDelegate()->SetWeldVertices(_weldVertices);
+        sceneDelegate()->SetWeldTolerance(_weldTolerance);
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("subdiv_scheme") || k->is("subdiv_refine_level")) {
+        sceneDelegate()->SetSubdivScheme(TfToken(subdivSchemeNames[_subdivScheme]));
+        sceneDelegate()->SetSubdivRefineLevel(_subdivRefineLevel);
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("chunk_meshes") || k->is("chunk_face_budget")) {
+        sceneDelegate()->SetChunkMeshes(_chunkMeshes);
+        sceneDelegate()->SetChunkFaceBudget(std::max(_chunkFaceBudget, 1));
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("batch_static_geometry") || k->is("batch_point_limit")) {
+        sceneDelegate()->SetBatchStaticGeometry(_batchStaticGeometry);
+        sceneDelegate()->SetBatchPointLimit(std::max(_batchPointLimit, 0));
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("build_lods") || k->is("lod_face_threshold")) {
+        sceneDelegate()->SetBuildLods(_buildLods);
+        sceneDelegate()->SetLodFaceThreshold(std::max(_lodFaceThreshold, 0));
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("cull_to_frustum") || k->is("cull_margin")) {
+        sceneDelegate()->SetCullToFrustum(_cullToFrustum);
+        sceneDelegate()->SetCullMargin(std::max(_cullMargin, 0.0f));
+        return 1;
+    }
+    if (k->is("instance_cards")) {
+        sceneDelegate()->SetInstanceCards(_instanceCards);
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
+    if (k->is("instance_duplicates")) {
+        sceneDelegate()->SetInstanceDuplicates(_instanceDuplicates);
+        sceneDelegate()->ClearNukePrims();
+        return 1;
+    }
     if (k->is("force_update")) {
         sceneDelegate()->ClearAll();
         invalidate();
@@ -355,6 +677,11 @@ HydraRender::_validate(bool for_real)
     if (GeoOp* geoOp = op_cast<GeoOp*>(Op::input(0))) {
         geoOp->validate(for_real);
     }
+    for (int split = 1; split < split_input(0); split++) {
+        if (GeoOp* sampleOp = op_cast<GeoOp*>(Op::input(0, split))) {
+            sampleOp->validate(for_real);
+        }
+    }
     if (Op* hydraOp = Op::input(2)) {
         hydraOp->validate(for_real);
     }
@@ -379,6 +706,8 @@ HydraRender::_validate(bool for_real)
     GfFrustum frustum = gfCamera.GetFrustum();
     taskController()->SetFreeCameraMatrices(frustum.ComputeViewMatrix(),
                                             frustum.ComputeProjectionMatrix());
+    sceneDelegate()->SetCullingCamera(frustum.ComputeViewMatrix()
+                                      * frustum.ComputeProjectionMatrix());
 
     if (_needDelegateKnobSync and _renderDelegateKnobCount > 0
             and _renderDelegateKnobStartIndex > 0)
@@ -405,6 +734,16 @@ HydraRender::renderStripe(ImagePlane& plane)
     if (_needRender) {
         if (GeoOp* geoOp = op_cast<GeoOp*>(Op::input(0))) {
             sceneDelegate()->SyncFromGeoOp(nullptr, geoOp);
+
+            const int splits = split_input(0);
+            if (splits > 1) {
+                const std::vector<float> times = motionSampleTimes();
+                for (int split = 1; split < splits; split++) {
+                    if (GeoOp* sampleOp = op_cast<GeoOp*>(Op::input(0, split))) {
+                        sceneDelegate()->SyncMotionSample(sampleOp, times[split - 1]);
+                    }
+                }
+            }
         }
         else {
             sceneDelegate()->ClearNukePrims();
@@ -484,6 +823,27 @@ HydraRender::initRenderer(const std::string& delegateId)
     }
 
     sceneDelegate()->SetDefaultDisplayColor(GfVec3f(_displayColor));
+    sceneDelegate()->SetZeroCopyBuffers(_zeroCopyBuffers);
+    sceneDelegate()->SetPromoteFaceVarying(_promoteFaceVarying);
+    sceneDelegate()->SetLazyPrimvars(_lazyPrimvars);
+    sceneDelegate()->SetFilterPrimvars(_filterPrimvars);
+    sceneDelegate()->SetPrimvarWhitelist(_primvarWhitelist);
+    sceneDelegate()->SetWeldVertices(_weldVertices);
+    sceneDelegate()->SetWeldTolerance(_weldTolerance);
+    sceneDelegate()->SetSubdivScheme(TfToken(subdivSchemeNames[_subdivScheme]));
+    sceneDelegate()->SetSubdivRefineLevel(_subdivRefineLevel);
+    sceneDelegate()->SetChunkMeshes(_chunkMeshes);
+    sceneDelegate()->SetChunkFaceBudget(std::max(_chunkFaceBudget, 1));
+    sceneDelegate()->SetBatchStaticGeometry(_batchStaticGeometry);
+    sceneDelegate()->SetBatchPointLimit(std::max(_batchPointLimit, 0));
+    sceneDelegate()->SetInstanceDuplicates(_instanceDuplicates);
+    sceneDelegate()->SetInstanceCards(_instanceCards);
+    sceneDelegate()->SetBuildLods(_buildLods);
+    sceneDelegate()->SetLodFaceThreshold(std::max(_lodFaceThreshold, 0));
+    sceneDelegate()->SetCullToFrustum(_cullToFrustum);
+    sceneDelegate()->SetCullMargin(std::max(_cullMargin, 0.0f));
+    sceneDelegate()->SetMotionBlur(static_cast<HdNukeMotionBlur>(_motionBlur),
+                                   motionSampleTimes());
 
     taskController()->SetEnableSelection(false);
 
@@ -501,6 +861,30 @@ HydraRender::initRenderer(const std::string& delegateId)
     taskController()->SetRenderTags(renderTags);
 }
 
+std::vector<float>
+HydraRender::motionSampleTimes() const
+{
+    std::vector<float> times;
+    if (_motionBlur == static_cast<int>(HdNukeMotionBlur::Off)) {
+        return times;
+    }
+
+    const int count = std::max(_motionSamples, 2);
+    const float shutter = std::max(_shutter, 0.0f);
+    float open = -0.5f * shutter;
+    if (_shutterOffset == 1) {
+        open = 0.0f;
+    }
+    else if (_shutterOffset == 2) {
+        open = -shutter;
+    }
+    times.reserve(count);
+    for (int i = 0; i < count; i++) {
+        times.push_back(open + shutter * i / (count - 1));
+    }
+    return times;
+}
+
 void
 HydraRender::renderDelegateKnobCallback(Knob_Callback f)
 {
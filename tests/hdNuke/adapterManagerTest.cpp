@@ -143,6 +143,21 @@ TEST_CASE("A HdNukeAdapterManager") {
                 REQUIRE(manager.GetUnfulfilledPromise(promise->path) == nullptr);
             }
 
+            SECTION("Should keep the handle of a promise fulfilled in a sync") {
+                EXPECT_CALL(*mockAdapter, SetUp(Eq(&manager), _))
+                    .Times(Exactly(1))
+                    .WillOnce(Return(true));
+                manager.RemoveUnusedAdapters();
+
+                manager.SetAllUnused();
+                manager.TryFulfillPromises();
+                REQUIRE(manager.GetAdapter(promise->handle) == mockAdapter);
+                manager.RemoveUnusedAdapters();
+
+                REQUIRE(manager.GetAdapter(promise->handle) == mockAdapter);
+                REQUIRE(manager.GetAdapter(promise->path) == mockAdapter);
+            }
+
             SECTION("Should be able to keep promises in an unfulfilled state") {
                 EXPECT_CALL(*mockAdapter, SetUp(Eq(&manager), _))
                     .Times(Exactly(1))
@@ -333,6 +348,40 @@ TEST_CASE("A HdNukeAdapterManager") {
             REQUIRE(manager.GetAdapter(promise1->path) == nullptr);
             REQUIRE(manager.GetAdapter(promise2->path) == nullptr);
         }
+
+        SECTION("keeping the adapters requested again") {
+            EXPECT_CALL(*mockAdapter, Update(Eq(&manager), Eq(VtValue{})))
+                .Times(Exactly(1))
+                .WillOnce(Return(true));
+            EXPECT_CALL(*mockAdapter, TearDown(Eq(&manager)))
+                .Times(Exactly(0));
+            EXPECT_CALL(*mockAdapter2, TearDown(Eq(&manager)))
+                .Times(Exactly(1));
+
+            manager.RemoveUnusedAdapters();
+            manager.Request(adapterType, SdfPath{"Mock/Primitive1"}, {});
+            auto requestedPaths = manager.GetRequestedAdapters();
+            REQUIRE(requestedPaths.size() == 1);
+            REQUIRE(requestedPaths.find(promise1->path) != requestedPaths.end());
+
+            manager.RemoveUnusedAdapters();
+            REQUIRE(manager.GetAdapter(promise1->path) == mockAdapter);
+            REQUIRE(manager.GetAdapter(promise2->path) == nullptr);
+            REQUIRE(manager.GetPathsForPrimType(primType).size() == 1);
+        }
+
+        SECTION("after marking all adapters unused") {
+            EXPECT_CALL(*mockAdapter, TearDown(Eq(&manager)))
+                .Times(Exactly(1));
+            EXPECT_CALL(*mockAdapter2, TearDown(Eq(&manager)))
+                .Times(Exactly(1));
+
+            manager.SetAllUnused();
+            REQUIRE(manager.GetRequestedAdapters().size() == 0);
+            manager.RemoveUnusedAdapters();
+            REQUIRE(manager.GetAdapter(promise1->path) == nullptr);
+            REQUIRE(manager.GetAdapter(promise2->path) == nullptr);
+        }
     }
 
     SECTION("Should support requests for GeoInfos") {
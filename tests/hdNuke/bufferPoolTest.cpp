@@ -0,0 +1,213 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/bufferPool.h"
+#include "../../src/hdNuke/contentHash.h"
+#include "../../src/hdNuke/foreignDataSource.h"
+
+#include <pxr/pxr.h>
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/vt/types.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST_CASE("HdNukeHashContent") {
+    std::vector<unsigned char> data(3001);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<unsigned char>(i * 131 + 7);
+    }
+
+    // Sizes either side of the short input and block boundaries.
+    const size_t size = GENERATE(0, 1, 15, 16, 63, 64, 65, 1023, 1024, 1025, 3000);
+
+    SECTION("Should be deterministic") {
+        REQUIRE(HdNukeHashContent(data.data(), size)
+                == HdNukeHashContent(data.data(), size));
+    }
+
+    SECTION("Should depend on the seed") {
+        REQUIRE(HdNukeHashContent(data.data(), size, 1)
+                != HdNukeHashContent(data.data(), size, 2));
+    }
+
+    SECTION("Should depend on the size") {
+        REQUIRE(HdNukeHashContent(data.data(), size)
+                != HdNukeHashContent(data.data(), size + 1));
+    }
+
+    SECTION("Should depend on every byte") {
+        const HdNukeContentHash original = HdNukeHashContent(data.data(), size);
+        for (size_t i = 0; i < size; i += 7) {
+            std::vector<unsigned char> changed(data.begin(), data.begin() + size);
+            changed[i] ^= 1;
+            REQUIRE(HdNukeHashContent(changed.data(), size) != original);
+        }
+    }
+
+    SECTION("Should depend on the order of the data") {
+        if (size >= 128) {
+            std::vector<unsigned char> swapped(data.begin(), data.begin() + size);
+            std::swap_ranges(swapped.begin(), swapped.begin() + 64,
+                             swapped.begin() + 64);
+            REQUIRE(HdNukeHashContent(swapped.data(), size)
+                    != HdNukeHashContent(data.data(), size));
+        }
+    }
+}
+
+TEST_CASE("HdNukeHashContent SIMD levels") {
+    std::vector<unsigned char> data(5000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<unsigned char>((i * 131 + 7) ^ (i >> 5));
+    }
+
+    const size_t size = GENERATE(65, 127, 128, 1024, 1025, 4099);
+    // Unaligned on purpose, Nuke's buffers needn't be.
+    const unsigned char* input = data.data() + 1;
+    const HdNukeContentHash expected =
+        HdNukeHashContent(input, size, size, HdNukeSimdLevel::Scalar);
+
+    REQUIRE(HdNukeHashContent(input, size, size, HdNukeSimdLevel::SSE) == expected);
+    REQUIRE(HdNukeHashContent(input, size, size, HdNukeSimdLevel::AVX2) == expected);
+    REQUIRE(HdNukeHashContent(input, size, size) == expected);
+}
+
+TEST_CASE("HdNukeHashContent throughput", "[.][benchmark]") {
+    // About the size of the points of a 10M point mesh.
+    const std::vector<unsigned char> data(120000000, 3);
+
+    const HdNukeSimdLevel levels[] = {
+        HdNukeSimdLevel::Scalar, HdNukeSimdLevel::SSE, HdNukeSimdLevel::AVX2
+    };
+    const char* const names[] = {"scalar", "SSE", "AVX2"};
+    for (size_t level = 0; level < 3; level++) {
+        if (levels[level] > HdNukeConversionKernels::GetSupportedLevel()) {
+            continue;
+        }
+        BENCHMARK(std::string("120MB, ") + names[level]) {
+            return HdNukeHashContent(data.data(), data.size(), 0, levels[level]).low;
+        };
+    }
+}
+
+TEST_CASE("A HdNukeBufferPool") {
+    HdNukeBufferPool pool;
+
+    VtVec2fArray first(100, GfVec2f(1.0f, 2.0f));
+    VtVec2fArray second(100, GfVec2f(1.0f, 2.0f));
+    const HdNukeContentHash hash =
+        HdNukeHashContent(first.cdata(), first.size() * sizeof(GfVec2f));
+
+    SECTION("Should share values with the same hash and type") {
+        auto firstRef = pool.Share(hash, VtValue(first));
+        auto secondRef = pool.Share(hash, VtValue(second));
+
+        REQUIRE(pool.GetEntryCount() == 1);
+        const auto& firstArray = firstRef.Get().Get<VtVec2fArray>();
+        const auto& secondArray = secondRef.Get().Get<VtVec2fArray>();
+        REQUIRE(firstArray.cdata() == first.cdata());
+        REQUIRE(secondArray.cdata() == first.cdata());
+    }
+
+    SECTION("Should keep values of different types apart") {
+        VtFloatArray floats(200, 1.0f);
+        auto firstRef = pool.Share(hash, VtValue(first));
+        auto floatsRef = pool.Share(hash, VtValue(floats));
+
+        REQUIRE(pool.GetEntryCount() == 2);
+        REQUIRE(floatsRef.Get().IsHolding<VtFloatArray>());
+    }
+
+    SECTION("Should not share different values whose hashes collide") {
+        VtVec2fArray different(100, GfVec2f(3.0f, 4.0f));
+        auto firstRef = pool.Share(hash, VtValue(first));
+        VtValue differentValue(different);
+        auto differentRef = pool.Share(hash, std::move(differentValue));
+
+        REQUIRE_FALSE(differentRef);
+        REQUIRE(differentValue.Get<VtVec2fArray>() == different);
+        REQUIRE(pool.GetEntryCount() == 1);
+        REQUIRE(firstRef.Get().Get<VtVec2fArray>() == first);
+
+        REQUIRE_FALSE(pool.ShareCopy(hash, VtValue(different)));
+    }
+
+    SECTION("Should keep values alive while they are referenced") {
+        auto firstRef = pool.Share(hash, VtValue(first));
+        {
+            auto secondRef = pool.Share(hash, VtValue(second));
+        }
+        REQUIRE(pool.GetEntryCount() == 1);
+
+        firstRef.Reset();
+        REQUIRE(pool.GetEntryCount() == 0);
+        REQUIRE(firstRef.Get().IsEmpty());
+    }
+
+    SECTION("Should move references") {
+        HdNukeBufferPool::Reference moved;
+        {
+            auto firstRef = pool.Share(hash, VtValue(first));
+            moved = std::move(firstRef);
+            REQUIRE_FALSE(firstRef);
+        }
+        REQUIRE(moved);
+        REQUIRE(pool.GetEntryCount() == 1);
+
+        moved = HdNukeBufferPool::Reference();
+        REQUIRE(pool.GetEntryCount() == 0);
+    }
+
+    SECTION("Should pool a copy of arrays pointing at memory it doesn't own") {
+        // Stands in for the attribute memory zero-copy arrays point at.
+        auto buffer = std::make_shared<std::vector<GfVec2f>>(first.cbegin(), first.cend());
+        const VtVec2fArray foreign = HdNukeMakeForeignArray<GfVec2f>(
+            buffer, buffer->data(), buffer->size());
+        REQUIRE(foreign.cdata() == buffer->data());
+
+        auto firstRef = pool.ShareCopy(hash, VtValue(foreign));
+        REQUIRE(firstRef.Get().Get<VtVec2fArray>().cdata() != buffer->data());
+
+        // Nuke rewrites the memory in place when the geometry changes, which
+        // mustn't change what other adapters get for the old hash.
+        (*buffer)[0] = GfVec2f(3.0f, 4.0f);
+        auto secondRef = pool.Share(hash, VtValue(second));
+        REQUIRE(pool.GetEntryCount() == 1);
+        REQUIRE(secondRef.Get().Get<VtVec2fArray>() == first);
+    }
+
+    SECTION("Should not copy values that are already pooled") {
+        auto firstRef = pool.Share(hash, VtValue(first));
+        auto secondRef = pool.ShareCopy(hash, VtValue(second));
+
+        REQUIRE(pool.GetEntryCount() == 1);
+        REQUIRE(secondRef.Get().Get<VtVec2fArray>().cdata() == first.cdata());
+    }
+
+    SECTION("Should ignore empty values") {
+        auto emptyRef = pool.Share(hash, VtValue());
+        REQUIRE_FALSE(emptyRef);
+        REQUIRE(pool.GetEntryCount() == 0);
+    }
+}
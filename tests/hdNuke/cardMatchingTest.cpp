@@ -0,0 +1,181 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/cardMatching.h"
+
+#include <pxr/pxr.h>
+
+#include <algorithm>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    // A card made like Nuke's, with columns x rows quads covering
+    // width x height around center, and uvs and normals per point.
+    struct Card
+    {
+        Card(int columns, int rows, float width, float height,
+             float centerX = 0.0f, float centerY = 0.0f, float z = 0.0f)
+        {
+            for (int y = 0; y <= rows; y++) {
+                for (int x = 0; x <= columns; x++) {
+                    const float u = float(x) / columns;
+                    const float v = float(y) / rows;
+                    points.insert(points.end(),
+                                  {centerX + (u - 0.5f) * width,
+                                   centerY + (v - 0.5f) * height, z});
+                    uvs.insert(uvs.end(), {u, v, 0.0f, 1.0f});
+                    normals.insert(normals.end(), {0.0f, 0.0f, 1.0f});
+                }
+            }
+            for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < columns; x++) {
+                    const int corner = y * (columns + 1) + x;
+                    faceVertexCounts.push_back(4);
+                    faceVertexIndices.insert(
+                        faceVertexIndices.end(),
+                        {corner, corner + 1, corner + columns + 2, corner + columns + 1});
+                }
+            }
+        }
+
+        HdNukeCardAttribute Uvs() const
+        {
+            HdNukeCardAttribute attribute;
+            attribute.data = uvs.data();
+            attribute.stride = 4;
+            attribute.size = uvs.size() / 4;
+            return attribute;
+        }
+
+        HdNukeCardAttribute Normals() const
+        {
+            HdNukeCardAttribute attribute;
+            attribute.data = normals.data();
+            attribute.stride = 3;
+            attribute.size = normals.size() / 3;
+            return attribute;
+        }
+
+        bool Match(HdNukeCardFit* fit) const
+        {
+            return HdNukeMatchCard(points.data(), points.size() / 3,
+                                   faceVertexCounts.data(), faceVertexCounts.size(),
+                                   faceVertexIndices.data(), faceVertexIndices.size(),
+                                   Uvs(), Normals(), fit);
+        }
+
+        std::vector<float> points;
+        std::vector<float> uvs;
+        std::vector<float> normals;
+        std::vector<int> faceVertexCounts;
+        std::vector<int> faceVertexIndices;
+    };
+}
+
+TEST_CASE("HdNukeMatchCard") {
+    HdNukeCardFit fit;
+
+    SECTION("Should match a subdivided card and fit the unit card to it") {
+        Card card(4, 4, 2.0f, 1.5f, 1.0f, -2.0f, 3.0f);
+        REQUIRE(card.Match(&fit));
+        REQUIRE(fit.center[0] == Approx(1.0f));
+        REQUIRE(fit.center[1] == Approx(-2.0f));
+        REQUIRE(fit.center[2] == Approx(3.0f));
+        REQUIRE(fit.size[0] == Approx(2.0f));
+        REQUIRE(fit.size[1] == Approx(1.5f));
+    }
+
+    SECTION("Should match a card without uvs or normals") {
+        Card card(1, 1, 1.0f, 1.0f);
+        REQUIRE(HdNukeMatchCard(card.points.data(), 4,
+                                card.faceVertexCounts.data(), 1,
+                                card.faceVertexIndices.data(), 4,
+                                HdNukeCardAttribute(), HdNukeCardAttribute(),
+                                &fit));
+    }
+
+    SECTION("Should match per face vertex uvs") {
+        Card card(2, 3, 1.0f, 2.0f);
+        std::vector<float> faceVertexUvs;
+        for (int index : card.faceVertexIndices) {
+            faceVertexUvs.insert(faceVertexUvs.end(),
+                                 {card.uvs[index * 4], card.uvs[index * 4 + 1]});
+        }
+        HdNukeCardAttribute uvs;
+        uvs.data = faceVertexUvs.data();
+        uvs.stride = 2;
+        uvs.size = faceVertexUvs.size() / 2;
+        uvs.perFaceVertex = true;
+        REQUIRE(HdNukeMatchCard(card.points.data(), card.points.size() / 3,
+                                card.faceVertexCounts.data(), card.faceVertexCounts.size(),
+                                card.faceVertexIndices.data(), card.faceVertexIndices.size(),
+                                uvs, card.Normals(), &fit));
+
+        faceVertexUvs[5] += 0.1f;
+        REQUIRE_FALSE(HdNukeMatchCard(card.points.data(), card.points.size() / 3,
+                                      card.faceVertexCounts.data(), card.faceVertexCounts.size(),
+                                      card.faceVertexIndices.data(), card.faceVertexIndices.size(),
+                                      uvs, card.Normals(), &fit));
+    }
+
+    SECTION("Should not match a bent card") {
+        Card card(4, 4, 1.0f, 1.0f);
+        card.points[12 * 3 + 2] = 0.1f;
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+
+    SECTION("Should not match a card with a hole") {
+        Card card(4, 4, 1.0f, 1.0f);
+        card.faceVertexCounts.pop_back();
+        card.faceVertexIndices.resize(card.faceVertexIndices.size() - 4);
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+
+    SECTION("Should not match a card facing away") {
+        Card card(2, 2, 1.0f, 1.0f);
+        for (size_t i = 0; i < card.faceVertexIndices.size(); i += 4) {
+            std::swap(card.faceVertexIndices[i + 1], card.faceVertexIndices[i + 3]);
+        }
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+
+    SECTION("Should not match moved uvs") {
+        Card card(2, 2, 1.0f, 1.0f);
+        card.uvs[0] = 0.5f;
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+
+    SECTION("Should not match tilted normals") {
+        Card card(2, 2, 1.0f, 1.0f);
+        card.normals[3] = 0.5f;
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+
+    SECTION("Should not match topology referring to missing points") {
+        Card card(1, 1, 1.0f, 1.0f);
+        card.faceVertexIndices[2] = 10;
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+
+    SECTION("Should not match a line") {
+        Card card(2, 2, 1.0f, 0.0f);
+        REQUIRE_FALSE(card.Match(&fit));
+    }
+}
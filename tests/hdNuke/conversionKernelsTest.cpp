@@ -0,0 +1,106 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/conversionKernels.h"
+
+#include <pxr/pxr.h>
+
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    const HdNukeSimdLevel kLevels[] = {
+        HdNukeSimdLevel::Scalar,
+        HdNukeSimdLevel::SSE,
+        HdNukeSimdLevel::AVX2
+    };
+
+    const char* const kLevelNames[] = {"scalar", "SSE", "AVX2"};
+
+    std::vector<float> MakeVector4s(size_t count)
+    {
+        std::vector<float> values(count * 4);
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i] = static_cast<float>(i % 17) * 0.25f + 0.5f;
+        }
+        // Throw in some zero w to check they are copied as they are.
+        for (size_t i = 0; i < count; i += 7) {
+            values[i * 4 + 3] = 0.0f;
+        }
+        return values;
+    }
+}
+
+TEST_CASE("HdNukeConversionKernels") {
+    // Odd sizes exercise the scalar tails of the SIMD kernels.
+    const size_t count = GENERATE(0, 1, 3, 4, 5, 8, 13, 64, 1001);
+    const size_t level = GENERATE(0, 1, 2);
+    const std::vector<float> src = MakeVector4s(count);
+    const auto& kernels = HdNukeConversionKernels::Get(kLevels[level]);
+    INFO(kLevelNames[level] << " kernels with " << count << " values");
+
+    SECTION("Should divide homogeneous coordinates by w") {
+        // One extra element to catch writes past the end.
+        std::vector<float> dst(count * 2 + 1, -1.0f);
+        kernels.homogeneousToVec2f(src.data(), dst.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            const float w = src[i * 4 + 3] != 0.0f ? src[i * 4 + 3] : 1.0f;
+            REQUIRE(dst[i * 2] == Approx(src[i * 4] / w));
+            REQUIRE(dst[i * 2 + 1] == Approx(src[i * 4 + 1] / w));
+        }
+        REQUIRE(dst.back() == -1.0f);
+    }
+
+    SECTION("Should drop the fourth component") {
+        std::vector<float> dst(count * 3 + 1, -1.0f);
+        kernels.vec4fToVec3f(src.data(), dst.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            REQUIRE(dst[i * 3] == src[i * 4]);
+            REQUIRE(dst[i * 3 + 1] == src[i * 4 + 1]);
+            REQUIRE(dst[i * 3 + 2] == src[i * 4 + 2]);
+        }
+        REQUIRE(dst.back() == -1.0f);
+    }
+}
+
+TEST_CASE("HdNukeConversionKernels throughput", "[.][benchmark]") {
+    const size_t count = 4000000;
+    const std::vector<float> src = MakeVector4s(count);
+    std::vector<float> uvs(count * 2);
+    std::vector<float> colors(count * 3);
+
+    for (size_t level = 0; level < 3; level++) {
+        if (kLevels[level] > HdNukeConversionKernels::GetSupportedLevel()) {
+            continue;
+        }
+        const auto& kernels = HdNukeConversionKernels::Get(kLevels[level]);
+        const std::string name(kLevelNames[level]);
+
+        BENCHMARK("4M uv divide_w, " + name) {
+            kernels.homogeneousToVec2f(src.data(), uvs.data(), count);
+            return uvs[0];
+        };
+        BENCHMARK("4M Cf to Vec3f, " + name) {
+            kernels.vec4fToVec3f(src.data(), colors.data(), count);
+            return colors[0];
+        };
+    }
+}
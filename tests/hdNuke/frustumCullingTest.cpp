@@ -0,0 +1,115 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/frustumCulling.h"
+
+#include <pxr/pxr.h>
+
+#include <algorithm>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    // A camera at the origin looking down -Z with a 90 degree field of
+    // view, clipping at 1 and 100, as a row vector matrix like GfFrustum's.
+    struct Camera
+    {
+        Camera()
+        {
+            const double nearPlane = 1.0;
+            const double farPlane = 100.0;
+            const double projection[16] = {
+                1.0, 0.0, 0.0, 0.0,
+                0.0, 1.0, 0.0, 0.0,
+                0.0, 0.0, (farPlane + nearPlane) / (nearPlane - farPlane), -1.0,
+                0.0, 0.0, 2.0 * farPlane * nearPlane / (nearPlane - farPlane), 0.0
+            };
+            std::copy(projection, projection + 16, viewProjection);
+        }
+
+        // Moves the camera by offset.
+        void Move(double x, double y, double z)
+        {
+            const double view[16] = {
+                1.0, 0.0, 0.0, 0.0,
+                0.0, 1.0, 0.0, 0.0,
+                0.0, 0.0, 1.0, 0.0,
+                -x, -y, -z, 1.0
+            };
+            double product[16];
+            for (int row = 0; row < 4; row++) {
+                for (int column = 0; column < 4; column++) {
+                    product[row * 4 + column] = 0.0;
+                    for (int i = 0; i < 4; i++) {
+                        product[row * 4 + column] +=
+                            view[row * 4 + i] * viewProjection[i * 4 + column];
+                    }
+                }
+            }
+            std::copy(product, product + 16, viewProjection);
+        }
+
+        bool Sees(double minX, double minY, double minZ,
+                  double maxX, double maxY, double maxZ) const
+        {
+            const double min[3] = {minX, minY, minZ};
+            const double max[3] = {maxX, maxY, maxZ};
+            return HdNukeIsBoxInFrustum(min, max, viewProjection);
+        }
+
+        double viewProjection[16];
+    };
+}
+
+TEST_CASE("HdNukeIsBoxInFrustum") {
+    Camera camera;
+
+    SECTION("Should keep boxes in front of the camera") {
+        REQUIRE(camera.Sees(-1, -1, -11, 1, 1, -9));
+        REQUIRE(camera.Sees(-0.1, -0.1, -99, 0.1, 0.1, -98));
+    }
+
+    SECTION("Should keep boxes crossing the edge of the view") {
+        REQUIRE(camera.Sees(8, -1, -11, 20, 1, -9));
+        REQUIRE(camera.Sees(-1, -1, -110, 1, 1, -90));
+    }
+
+    SECTION("Should keep boxes around the camera") {
+        REQUIRE(camera.Sees(-5, -5, -5, 5, 5, 5));
+    }
+
+    SECTION("Should cull boxes to the side of the view") {
+        REQUIRE_FALSE(camera.Sees(12, -1, -11, 20, 1, -9));
+        REQUIRE_FALSE(camera.Sees(-1, -20, -11, 1, -12, -9));
+    }
+
+    SECTION("Should cull boxes behind the camera") {
+        REQUIRE_FALSE(camera.Sees(-1, -1, 5, 1, 1, 7));
+    }
+
+    SECTION("Should cull boxes outside the clipping range") {
+        REQUIRE_FALSE(camera.Sees(-1, -1, -200, 1, 1, -150));
+        REQUIRE_FALSE(camera.Sees(-0.1, -0.1, -0.9, 0.1, 0.1, -0.5));
+    }
+
+    SECTION("Should follow the camera") {
+        camera.Move(100, 0, 0);
+        REQUIRE_FALSE(camera.Sees(-1, -1, -11, 1, 1, -9));
+        REQUIRE(camera.Sees(99, -1, -11, 101, 1, -9));
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "mockObjects.h"
+
+#include "../../src/hdNuke/geoAdapter.h"
+#include "../../src/hdNuke/sceneDelegate.h"
+#include "../../src/hdNuke/tokens.h"
+
+#include <DDImage/Allocators.h>
+#include <DDImage/GeoInfo.h>
+#include <DDImage/Scene.h>
+
+#include <pxr/pxr.h>
+#include <pxr/imaging/hd/changeTracker.h>
+#include <pxr/imaging/hd/meshTopology.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+// Before its primvars moved into an HdNukePrimvarTable, HdNukeGeoAdapter
+// took up 608 bytes on 64-bit Linux apart from its topology, whose size is
+// USD's and changes between versions. The adapter must stay below that, so
+// the state of the optional features and of change tracking is kept out of
+// line.
+static constexpr size_t GeoAdapterSizeBudget = 600;
+static_assert(sizeof(HdNukeGeoAdapter) - sizeof(HdMeshTopology)
+                  <= GeoAdapterSizeBudget,
+              "HdNukeGeoAdapter is over its size budget");
+
+TEST_CASE("A HdNukeGeoAdapter") {
+    DD::Image::Allocators::createDefaultAllocators();
+
+    HdNukeSceneDelegate sceneDelegate{nullptr};
+    HdNukeGeoAdapter adapter{sceneDelegate.GetSharedState()};
+
+    MockGeoOp geoOp{nullptr};
+    DD::Image::Scene scene;
+    geoOp.build_scene(scene);
+    auto geo = scene.object(0);
+
+    SECTION("Should be visible when rendered") {
+        geo.render_mode = DD::Image::RENDER_SOLID;
+        adapter.Update(geo, HdChangeTracker::DirtyVisibility, false);
+        REQUIRE(adapter.Get(HdNukeTokens->visible).GetWithDefault<bool>(false));
+    }
+
+    SECTION("Should be hidden when its render mode is off") {
+        geo.render_mode = DD::Image::RENDER_OFF;
+        adapter.Update(geo, HdChangeTracker::DirtyVisibility, false);
+        REQUIRE_FALSE(adapter.GetVisible());
+        REQUIRE_FALSE(adapter.Get(HdNukeTokens->visible).GetWithDefault<bool>(true));
+    }
+
+    DD::Image::Allocators::destroyDefaultAllocators();
+}
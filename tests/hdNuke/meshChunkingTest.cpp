@@ -0,0 +1,124 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/meshChunking.h"
+
+#include <pxr/pxr.h>
+
+#include <algorithm>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    // A size x size grid of unit quads in the XY plane.
+    struct Grid
+    {
+        explicit Grid(int size)
+        {
+            for (int y = 0; y <= size; y++) {
+                for (int x = 0; x <= size; x++) {
+                    points.insert(points.end(), {float(x), float(y), 0.0f});
+                }
+            }
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    const int corner = y * (size + 1) + x;
+                    faceVertexCounts.push_back(4);
+                    faceVertexIndices.insert(
+                        faceVertexIndices.end(),
+                        {corner, corner + 1, corner + size + 2, corner + size + 1});
+                }
+            }
+        }
+
+        std::vector<HdNukeMeshChunk> Chunk(size_t faceBudget) const
+        {
+            return HdNukeBuildMeshChunks(
+                points.data(), points.size() / 3,
+                faceVertexCounts.data(), faceVertexCounts.size(),
+                faceVertexIndices.data(), faceVertexIndices.size(), faceBudget);
+        }
+
+        std::vector<float> points;
+        std::vector<int> faceVertexCounts;
+        std::vector<int> faceVertexIndices;
+    };
+}
+
+TEST_CASE("Mesh chunking") {
+    const Grid grid(4);
+
+    SECTION("Should leave meshes within the budget whole") {
+        REQUIRE(grid.Chunk(16).empty());
+        REQUIRE(grid.Chunk(0).empty());
+    }
+
+    SECTION("Should split meshes into spatially coherent chunks") {
+        const auto chunks = grid.Chunk(4);
+        REQUIRE(chunks.size() == 4);
+
+        std::vector<int> allFaces;
+        for (const auto& chunk : chunks) {
+            REQUIRE(chunk.faces.size() == 4);
+            REQUIRE(std::is_sorted(chunk.faces.begin(), chunk.faces.end()));
+            allFaces.insert(allFaces.end(), chunk.faces.begin(), chunk.faces.end());
+
+            // Each chunk is one 2x2 quadrant of the grid.
+            float min[2] = {100.0f, 100.0f};
+            float max[2] = {-100.0f, -100.0f};
+            for (int point : chunk.points) {
+                for (int axis = 0; axis < 2; axis++) {
+                    min[axis] = std::min(min[axis], grid.points[point * 3 + axis]);
+                    max[axis] = std::max(max[axis], grid.points[point * 3 + axis]);
+                }
+            }
+            REQUIRE(max[0] - min[0] == 2.0f);
+            REQUIRE(max[1] - min[1] == 2.0f);
+            REQUIRE(chunk.points.size() == 9);
+        }
+        std::sort(allFaces.begin(), allFaces.end());
+        for (int face = 0; face < 16; face++) {
+            REQUIRE(allFaces[face] == face);
+        }
+    }
+
+    SECTION("Should keep the topology of each face") {
+        for (const auto& chunk : grid.Chunk(5)) {
+            REQUIRE(chunk.faceVertexCounts.size() == chunk.faces.size());
+            REQUIRE(chunk.faceVertexIndices.size() == chunk.faceVertices.size());
+            size_t faceVertex = 0;
+            for (size_t i = 0; i < chunk.faces.size(); i++) {
+                const int face = chunk.faces[i];
+                REQUIRE(chunk.faceVertexCounts[i] == grid.faceVertexCounts[face]);
+                for (int corner = 0; corner < chunk.faceVertexCounts[i]; corner++) {
+                    const int original = face * 4 + corner;
+                    REQUIRE(chunk.faceVertices[faceVertex] == original);
+                    const int point = chunk.faceVertexIndices[faceVertex];
+                    REQUIRE(chunk.points[point] == grid.faceVertexIndices[original]);
+                    faceVertex++;
+                }
+            }
+        }
+    }
+
+    SECTION("Should leave meshes with invalid topology whole") {
+        Grid broken(4);
+        broken.faceVertexIndices[5] = 1000;
+        REQUIRE(broken.Chunk(4).empty());
+    }
+}
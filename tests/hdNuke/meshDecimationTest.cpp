@@ -0,0 +1,229 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/meshDecimation.h"
+
+#include <pxr/pxr.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    struct Mesh
+    {
+        HdNukeMeshLod Decimate(size_t targetFaces) const
+        {
+            return HdNukeDecimateMesh(
+                points.data(), points.size() / 3,
+                faceVertexCounts.data(), faceVertexCounts.size(),
+                faceVertexIndices.data(), faceVertexIndices.size(), targetFaces);
+        }
+
+        std::vector<float> points;
+        std::vector<int> faceVertexCounts;
+        std::vector<int> faceVertexIndices;
+    };
+
+    // A size x size grid of unit quads in the XY plane.
+    Mesh Grid(int size)
+    {
+        Mesh mesh;
+        for (int y = 0; y <= size; y++) {
+            for (int x = 0; x <= size; x++) {
+                mesh.points.insert(mesh.points.end(), {float(x), float(y), 0.0f});
+            }
+        }
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const int corner = y * (size + 1) + x;
+                mesh.faceVertexCounts.push_back(4);
+                mesh.faceVertexIndices.insert(
+                    mesh.faceVertexIndices.end(),
+                    {corner, corner + 1, corner + size + 2, corner + size + 1});
+            }
+        }
+        return mesh;
+    }
+
+    // A closed unit sphere of quads with triangle fans at the poles.
+    Mesh Sphere(int rings, int segments)
+    {
+        const double pi = 3.14159265358979323846;
+        Mesh mesh;
+        mesh.points.insert(mesh.points.end(), {0.0f, -1.0f, 0.0f});
+        for (int ring = 1; ring < rings; ring++) {
+            const double phi = pi * ring / rings;
+            for (int segment = 0; segment < segments; segment++) {
+                const double theta = 2.0 * pi * segment / segments;
+                mesh.points.insert(mesh.points.end(),
+                                   {float(std::sin(phi) * std::cos(theta)),
+                                    float(-std::cos(phi)),
+                                    float(-std::sin(phi) * std::sin(theta))});
+            }
+        }
+        mesh.points.insert(mesh.points.end(), {0.0f, 1.0f, 0.0f});
+        const int top = static_cast<int>(mesh.points.size() / 3) - 1;
+
+        auto ringPoint = [&](int ring, int segment) {
+            return 1 + (ring - 1) * segments + segment % segments;
+        };
+        for (int segment = 0; segment < segments; segment++) {
+            mesh.faceVertexCounts.push_back(3);
+            mesh.faceVertexIndices.insert(
+                mesh.faceVertexIndices.end(),
+                {0, ringPoint(1, segment), ringPoint(1, segment + 1)});
+        }
+        for (int ring = 1; ring + 1 < rings; ring++) {
+            for (int segment = 0; segment < segments; segment++) {
+                mesh.faceVertexCounts.push_back(4);
+                mesh.faceVertexIndices.insert(
+                    mesh.faceVertexIndices.end(),
+                    {ringPoint(ring, segment), ringPoint(ring + 1, segment),
+                     ringPoint(ring + 1, segment + 1), ringPoint(ring, segment + 1)});
+            }
+        }
+        for (int segment = 0; segment < segments; segment++) {
+            mesh.faceVertexCounts.push_back(3);
+            mesh.faceVertexIndices.insert(
+                mesh.faceVertexIndices.end(),
+                {ringPoint(rings - 1, segment), top, ringPoint(rings - 1, segment + 1)});
+        }
+        return mesh;
+    }
+
+    void RequireConsistent(const Mesh& mesh, const HdNukeMeshLod& lod)
+    {
+        const size_t numPoints = lod.points.size() / 3;
+        REQUIRE(lod.pointSources.size() == numPoints);
+        REQUIRE(lod.faceVertexIndices.size() == lod.GetFaceCount() * 3);
+        REQUIRE(lod.faceVertexSources.size() == lod.faceVertexIndices.size());
+        for (int index : lod.faceVertexIndices) {
+            REQUIRE(index >= 0);
+            REQUIRE(static_cast<size_t>(index) < numPoints);
+        }
+        for (int source : lod.pointSources) {
+            REQUIRE(static_cast<size_t>(source) < mesh.points.size() / 3);
+        }
+        for (int source : lod.faceSources) {
+            REQUIRE(static_cast<size_t>(source) < mesh.faceVertexCounts.size());
+        }
+        for (int source : lod.faceVertexSources) {
+            REQUIRE(static_cast<size_t>(source) < mesh.faceVertexIndices.size());
+        }
+    }
+}
+
+TEST_CASE("HdNukeDecimateMesh") {
+    SECTION("Should triangulate without decimating a mesh under the target") {
+        const Mesh grid = Grid(4);
+        const HdNukeMeshLod lod = grid.Decimate(1000);
+        RequireConsistent(grid, lod);
+        REQUIRE(lod.GetFaceCount() == 32);
+        REQUIRE(lod.pointSources.size() == 25);
+        // The first triangle of a face takes its first three face vertices.
+        REQUIRE(lod.faceSources[0] == 0);
+        REQUIRE(lod.faceVertexSources[0] == 0);
+        REQUIRE(lod.faceVertexSources[1] == 1);
+        REQUIRE(lod.faceVertexSources[2] == 2);
+    }
+
+    SECTION("Should reduce a flat grid to the target and keep its outline") {
+        const Mesh grid = Grid(40);
+        const HdNukeMeshLod lod = grid.Decimate(200);
+        RequireConsistent(grid, lod);
+        REQUIRE(lod.GetFaceCount() <= 200);
+        REQUIRE(lod.GetFaceCount() >= 100);
+
+        float min[3] = {1e9f, 1e9f, 1e9f};
+        float max[3] = {-1e9f, -1e9f, -1e9f};
+        for (size_t i = 0; i < lod.points.size(); i++) {
+            min[i % 3] = std::min(min[i % 3], lod.points[i]);
+            max[i % 3] = std::max(max[i % 3], lod.points[i]);
+        }
+        REQUIRE(min[0] == Approx(0.0f).margin(1e-4));
+        REQUIRE(min[1] == Approx(0.0f).margin(1e-4));
+        REQUIRE(max[0] == Approx(40.0f));
+        REQUIRE(max[1] == Approx(40.0f));
+        REQUIRE(min[2] == Approx(0.0f).margin(1e-4));
+        REQUIRE(max[2] == Approx(0.0f).margin(1e-4));
+
+        // The triangles still cover the grid once, facing the same way.
+        double area = 0.0;
+        for (size_t t = 0; t < lod.GetFaceCount(); t++) {
+            const float* a = &lod.points[lod.faceVertexIndices[t * 3] * 3];
+            const float* b = &lod.points[lod.faceVertexIndices[t * 3 + 1] * 3];
+            const float* c = &lod.points[lod.faceVertexIndices[t * 3 + 2] * 3];
+            const double twiceArea = (b[0] - a[0]) * (c[1] - a[1])
+                                     - (c[0] - a[0]) * (b[1] - a[1]);
+            REQUIRE(twiceArea > 0.0);
+            area += 0.5 * twiceArea;
+        }
+        REQUIRE(area == Approx(1600.0).epsilon(1e-3));
+    }
+
+    SECTION("Should keep the shape of a sphere") {
+        const Mesh sphere = Sphere(32, 64);
+        const HdNukeMeshLod lod = sphere.Decimate(400);
+        RequireConsistent(sphere, lod);
+        REQUIRE(lod.GetFaceCount() <= 400);
+        REQUIRE(lod.GetFaceCount() >= 200);
+        for (size_t i = 0; i < lod.points.size(); i += 3) {
+            const double radius = std::sqrt(lod.points[i] * lod.points[i]
+                                            + lod.points[i + 1] * lod.points[i + 1]
+                                            + lod.points[i + 2] * lod.points[i + 2]);
+            REQUIRE(radius == Approx(1.0).margin(0.1));
+        }
+    }
+
+    SECTION("Should return nothing for topology referring to missing points") {
+        Mesh grid = Grid(4);
+        grid.faceVertexIndices[5] = 100;
+        REQUIRE(grid.Decimate(10).GetFaceCount() == 0);
+    }
+
+    SECTION("Should return nothing for face counts not adding up") {
+        Mesh grid = Grid(4);
+        grid.faceVertexCounts[0] = 5;
+        REQUIRE(grid.Decimate(10).GetFaceCount() == 0);
+    }
+}
+
+TEST_CASE("HdNukeBuildMeshLods") {
+    const Mesh sphere = Sphere(16, 32);
+    const std::vector<size_t> targets = {600, 150};
+    const std::vector<HdNukeMeshLod> lods = HdNukeBuildMeshLods(
+        sphere.points.data(), sphere.points.size() / 3,
+        sphere.faceVertexCounts.data(), sphere.faceVertexCounts.size(),
+        sphere.faceVertexIndices.data(), sphere.faceVertexIndices.size(), targets);
+    REQUIRE(lods.size() == 2);
+    REQUIRE(lods[0].GetFaceCount() <= 600);
+    REQUIRE(lods[1].GetFaceCount() <= 150);
+    REQUIRE(lods[1].GetFaceCount() < lods[0].GetFaceCount());
+}
+
+TEST_CASE("HdNukeDecimateMesh performance", "[.][benchmark]") {
+    const Mesh sphere = Sphere(500, 1000);
+
+    BENCHMARK("500K faces to 50K") {
+        return sphere.Decimate(50000).GetFaceCount();
+    };
+}
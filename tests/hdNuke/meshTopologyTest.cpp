@@ -0,0 +1,217 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "mockObjects.h"
+
+#include "../../src/hdNuke/meshTopology.h"
+
+#include <DDImage/Scene.h>
+#include <DDImage/Allocators.h>
+#include <DDImage/GeoInfo.h>
+#include <DDImage/Mesh.h>
+#include <DDImage/PolyMesh.h>
+#include <DDImage/Polygon.h>
+
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    // Builds the topology one face at a time through the Primitive
+    // interface, for the parallel builder to be checked against.
+    void BuildSerialTopology(const DD::Image::GeoInfo& geo,
+                             VtIntArray& faceVertexCounts,
+                             VtIntArray& faceVertexIndices)
+    {
+        std::vector<unsigned> faceVertices;
+        for (unsigned primIndex = 0; primIndex < geo.primitives(); primIndex++) {
+            const DD::Image::Primitive* prim = geo.primitive(primIndex);
+            const DD::Image::PrimitiveType primType = prim->getPrimitiveType();
+            if (primType == DD::Image::ePoint || primType == DD::Image::eParticles
+                    || primType == DD::Image::eParticlesSprite) {
+                continue;
+            }
+            const unsigned* vertexArray = prim->vertex_array();
+            for (unsigned faceIndex = 0; faceIndex < prim->faces(); faceIndex++) {
+                const unsigned numFaceVertices = prim->face_vertices(faceIndex);
+                faceVertices.resize(numFaceVertices);
+                prim->get_face_vertices(faceIndex, faceVertices.data());
+                faceVertexCounts.push_back(static_cast<int>(numFaceVertices));
+                for (unsigned vertex : faceVertices) {
+                    faceVertexIndices.push_back(static_cast<int>(vertexArray[vertex]));
+                }
+            }
+        }
+    }
+
+    // A PolyMesh of numQuads quads in a row, starting at firstPoint.
+    DD::Image::PolyMesh* MakeQuadStrip(unsigned numQuads, unsigned firstPoint)
+    {
+        const unsigned numVertices = 2 * (numQuads + 1);
+        auto polyMesh = new DD::Image::PolyMesh(numVertices, numQuads);
+        for (unsigned i = 0; i < numVertices; i++) {
+            polyMesh->vertex(i) = firstPoint + i;
+        }
+        for (unsigned i = 0; i < numQuads; i++) {
+            unsigned quad[] = {2 * i, 2 * i + 1, 2 * i + 3, 2 * i + 2};
+            polyMesh->add_face(4, quad);
+        }
+        return polyMesh;
+    }
+
+    void RequireSameAsSerial(DD::Image::GeoOp& geoOp, size_t numFaces)
+    {
+        DD::Image::Scene scene;
+        geoOp.build_scene(scene);
+        const auto& geo = scene.object(0);
+
+        VtIntArray expectedCounts;
+        VtIntArray expectedIndices;
+        BuildSerialTopology(geo, expectedCounts, expectedIndices);
+        REQUIRE(expectedCounts.size() == numFaces);
+
+        HdNukeMeshTopologyBuilder builder(geo);
+        REQUIRE(builder.GetFaceCount() == expectedCounts.size());
+        REQUIRE(builder.GetFaceVertexCount() == expectedIndices.size());
+
+        VtIntArray faceVertexCounts;
+        VtIntArray faceVertexIndices;
+        builder.Build(faceVertexCounts, faceVertexIndices);
+        REQUIRE(faceVertexCounts == expectedCounts);
+        REQUIRE(faceVertexIndices == expectedIndices);
+    }
+}
+
+
+TEST_CASE("A HdNukeMeshTopologyBuilder") {
+    DD::Image::Allocators::createDefaultAllocators();
+
+    SECTION("Should flatten a single triangle") {
+        MockGeoOp geoOp{nullptr};
+        DD::Image::Scene scene;
+        geoOp.build_scene(scene);
+        const auto& geo = scene.object(0);
+
+        HdNukeMeshTopologyBuilder builder(geo);
+        REQUIRE(builder.GetFaceCount() == 1);
+        REQUIRE(builder.GetFaceVertexCount() == 3);
+
+        VtIntArray faceVertexCounts;
+        VtIntArray faceVertexIndices;
+        builder.Build(faceVertexCounts, faceVertexIndices);
+        REQUIRE(faceVertexCounts == VtIntArray{3});
+        REQUIRE(faceVertexIndices == VtIntArray{0, 1, 2});
+    }
+
+    SECTION("Should keep the primitive order when building in parallel") {
+        const unsigned numTriangles = 10000;
+        MockTriangleSoupGeoOp geoOp{nullptr, numTriangles};
+        DD::Image::Scene scene;
+        geoOp.build_scene(scene);
+        const auto& geo = scene.object(0);
+
+        VtIntArray faceVertexCounts;
+        VtIntArray faceVertexIndices;
+        HdNukeMeshTopologyBuilder(geo).Build(faceVertexCounts, faceVertexIndices);
+
+        REQUIRE(faceVertexCounts.size() == numTriangles);
+        REQUIRE(faceVertexIndices.size() == numTriangles * 3);
+        for (size_t i = 0; i < faceVertexIndices.size(); i++) {
+            REQUIRE(faceVertexIndices[i] == static_cast<int>(i));
+        }
+    }
+
+    SECTION("Should flatten a polygon") {
+        MockPrimitivesGeoOp geoOp{nullptr, [](DD::Image::GeometryList& out) {
+            out.add_primitive(0, new DD::Image::Polygon(0, 1, 2, 3, true));
+        }};
+        RequireSameAsSerial(geoOp, 1);
+    }
+
+    SECTION("Should flatten a mesh") {
+        MockPrimitivesGeoOp geoOp{nullptr, [](DD::Image::GeometryList& out) {
+            out.add_primitive(0, new DD::Image::Mesh(4, 3, false, false, 0));
+        }};
+        RequireSameAsSerial(geoOp, 4 * 3);
+    }
+
+    SECTION("Should flatten a polymesh") {
+        MockPrimitivesGeoOp geoOp{nullptr, [](DD::Image::GeometryList& out) {
+            out.add_primitive(0, MakeQuadStrip(5, 0));
+        }};
+        RequireSameAsSerial(geoOp, 5);
+    }
+
+    SECTION("Should flatten a mix of primitives in order") {
+        MockPrimitivesGeoOp geoOp{nullptr, [](DD::Image::GeometryList& out) {
+            out.add_primitive(0, new DD::Image::Triangle(0, 1, 2));
+            out.add_primitive(0, MakeQuadStrip(3, 3));
+            out.add_primitive(0, new DD::Image::Polygon(11, 12, 13, 14, true));
+            out.add_primitive(0, new DD::Image::Mesh(2, 2, false, false, 15));
+            out.add_primitive(0, new DD::Image::Triangle(24, 25, 26));
+        }};
+        RequireSameAsSerial(geoOp, 1 + 3 + 1 + 2 * 2 + 1);
+    }
+
+    // A single primitive of at least 65536 faces is split across its faces.
+    SECTION("Should split a large mesh across its faces") {
+        MockPrimitivesGeoOp geoOp{nullptr, [](DD::Image::GeometryList& out) {
+            out.add_primitive(0, new DD::Image::Mesh(512, 256, false, false, 0));
+        }};
+        RequireSameAsSerial(geoOp, 512 * 256);
+    }
+
+    SECTION("Should split a large polymesh across its faces") {
+        MockPrimitivesGeoOp geoOp{nullptr, [](DD::Image::GeometryList& out) {
+            out.add_primitive(0, MakeQuadStrip(100000, 0));
+        }};
+        RequireSameAsSerial(geoOp, 100000);
+    }
+
+    DD::Image::Allocators::destroyDefaultAllocators();
+}
+
+TEST_CASE("HdNukeMeshTopologyBuilder scaling", "[.][benchmark]") {
+    DD::Image::Allocators::createDefaultAllocators();
+
+    MockTriangleSoupGeoOp geoOp{nullptr, 2000000};
+    DD::Image::Scene scene;
+    geoOp.build_scene(scene);
+    const auto& geo = scene.object(0);
+
+    const int maxThreads = tbb::task_scheduler_init::default_num_threads();
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        tbb::task_arena arena(numThreads);
+        BENCHMARK("2M triangles, " + std::to_string(numThreads) + " threads") {
+            VtIntArray faceVertexCounts;
+            VtIntArray faceVertexIndices;
+            arena.execute([&] {
+                HdNukeMeshTopologyBuilder(geo).Build(faceVertexCounts,
+                                                     faceVertexIndices);
+            });
+            return faceVertexIndices.size();
+        };
+    }
+
+    DD::Image::Allocators::destroyDefaultAllocators();
+}
@@ -30,6 +30,8 @@
 #include <pxr/base/tf/staticTokens.h>
 #include <pxr/usd/sdf/path.h>
 
+#include <functional>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 struct AdapterSharedState;
@@ -59,6 +61,68 @@ public:
     }
 };
 
+/// Builds a single object holding \p numTriangles disconnected triangles.
+class MockTriangleSoupGeoOp : public DD::Image::GeoOp
+{
+public:
+    MockTriangleSoupGeoOp(Node* n, unsigned numTriangles)
+      : GeoOp(n)
+      , _numTriangles(numTriangles)
+    {
+    }
+
+    const char* node_help() const override
+    {
+        return "MockTriangleSoupGeoOp";
+    }
+    const char* Class() const override
+    {
+        return "MockTriangleSoupGeoOp";
+    }
+
+    void geometry_engine(DD::Image::Scene& scene, DD::Image::GeometryList& out) override
+    {
+      out.add_object(0);
+      for (unsigned i = 0; i < _numTriangles; i++) {
+        out.add_primitive(0, new DD::Image::Triangle(i * 3, i * 3 + 1, i * 3 + 2));
+      }
+    }
+
+private:
+    unsigned _numTriangles;
+};
+
+/// Builds a single object out of the primitives \p addPrimitives adds to it.
+class MockPrimitivesGeoOp : public DD::Image::GeoOp
+{
+public:
+    using AddPrimitives = std::function<void(DD::Image::GeometryList&)>;
+
+    MockPrimitivesGeoOp(Node* n, AddPrimitives addPrimitives)
+      : GeoOp(n)
+      , _addPrimitives(std::move(addPrimitives))
+    {
+    }
+
+    const char* node_help() const override
+    {
+        return "MockPrimitivesGeoOp";
+    }
+    const char* Class() const override
+    {
+        return "MockPrimitivesGeoOp";
+    }
+
+    void geometry_engine(DD::Image::Scene& scene, DD::Image::GeometryList& out) override
+    {
+      out.add_object(0);
+      _addPrimitives(out);
+    }
+
+private:
+    AddPrimitives _addPrimitives;
+};
+
 class MockAdapter : public HdNukeAdapter
 {
 public:
@@ -0,0 +1,99 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/objectIdentity.h"
+
+#include <pxr/pxr.h>
+
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    HdNukeObjectKey Object(uint64_t srcId, const std::string& name = std::string(),
+                           const std::string& primType = "mesh",
+                           const std::string& adapterType = "GenericGeoInfo")
+    {
+        HdNukeObjectKey object;
+        object.srcId = srcId;
+        object.primType = primType;
+        object.adapterType = adapterType;
+        object.name = name;
+        return object;
+    }
+
+    using Ids = std::vector<std::string>;
+}
+
+TEST_CASE("HdNukeObjectIdentities") {
+    HdNukeObjectIdentities identities;
+
+    SECTION("Should give new objects ids from their prim type and index") {
+        REQUIRE(identities.Update({Object(7), Object(3, "", "points")})
+                == Ids{"mesh_0", "points_1"});
+    }
+
+    SECTION("Should give named objects ids from their prim type and name") {
+        REQUIRE(identities.Update({Object(7, "body"), Object(3, "wheel"), Object(4, "wheel")})
+                == Ids{"mesh_body", "mesh_wheel", "mesh_wheel_1"});
+    }
+
+    SECTION("Should keep the ids of named objects whatever their source id") {
+        identities.Update({Object(7, "body"), Object(3, "wheel")});
+        REQUIRE(identities.Update({Object(30, "wheel"), Object(70, "body")})
+                == Ids{"mesh_wheel", "mesh_body"});
+    }
+
+    SECTION("Should keep the ids of objects with the same source id") {
+        identities.Update({Object(1), Object(2), Object(3)});
+        REQUIRE(identities.Update({Object(3), Object(1)})
+                == Ids{"mesh_2", "mesh_0"});
+    }
+
+    SECTION("Should give objects whose source id changed the ids that went away") {
+        identities.Update({Object(1), Object(2), Object(3)});
+        REQUIRE(identities.Update({Object(1), Object(20), Object(30)})
+                == Ids{"mesh_0", "mesh_1", "mesh_2"});
+    }
+
+    SECTION("Should only take over ids of the same types") {
+        identities.Update({Object(1), Object(2, "", "points")});
+        const Ids ids = identities.Update({Object(10, "", "points"), Object(20),
+                                           Object(30, "", "mesh", "InstancedGeo")});
+        REQUIRE(ids[0] == "points_1");
+        REQUIRE(ids[1] == "mesh_0");
+        REQUIRE(ids[2] == "mesh_2");
+    }
+
+    SECTION("Should keep new ids clear of ids in use or just gone") {
+        identities.Update({Object(1), Object(2), Object(3)});
+        const Ids ids = identities.Update({Object(2), Object(1),
+                                           Object(5, "", "mesh", "InstancedGeo")});
+        REQUIRE(ids[0] == "mesh_1");
+        REQUIRE(ids[1] == "mesh_0");
+        REQUIRE(ids[2] == "mesh_2_1");
+    }
+
+    SECTION("Should match without keeping the objects") {
+        identities.Update({Object(1), Object(2)});
+        REQUIRE(identities.Match({Object(2), Object(10)}) == Ids{"mesh_1", "mesh_0"});
+        REQUIRE(identities.Update({Object(2)}) == Ids{"mesh_1"});
+        REQUIRE(identities.Update({Object(1), Object(2)}) == Ids{"mesh_0", "mesh_1"});
+    }
+}
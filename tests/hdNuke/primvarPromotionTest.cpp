@@ -0,0 +1,84 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/primvarPromotion.h"
+
+#include <pxr/pxr.h>
+
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST_CASE("Face-varying primvar promotion") {
+    // Two quads sharing the edge between points 1 and 2, and an unused
+    // point 6.
+    const std::vector<int> faceVertexIndices = {0, 1, 2, 3, 1, 4, 5, 2};
+    const size_t numPoints = 7;
+    std::vector<int> pointFaceVertices;
+
+    SECTION("Should promote values that agree on every point") {
+        const std::vector<float> values = {0, 1, 2, 3, 1, 4, 5, 2};
+        REQUIRE(HdNukeFindUniformPointValues(
+            values.data(), sizeof(float), faceVertexIndices.data(),
+            faceVertexIndices.size(), numPoints, pointFaceVertices));
+        REQUIRE(pointFaceVertices.size() == numPoints);
+        REQUIRE(pointFaceVertices[6] == -1);
+
+        std::vector<float> pointValues(numPoints, -1.0f);
+        HdNukeGatherPointValues(values.data(), sizeof(float), pointFaceVertices,
+                                pointValues.data());
+        REQUIRE(pointValues == std::vector<float>({0, 1, 2, 3, 4, 5, 0}));
+    }
+
+    SECTION("Should keep values that differ between faces") {
+        const std::vector<float> values = {0, 1, 2, 3, 1, 4, 5, 7};
+        REQUIRE_FALSE(HdNukeFindUniformPointValues(
+            values.data(), sizeof(float), faceVertexIndices.data(),
+            faceVertexIndices.size(), numPoints, pointFaceVertices));
+    }
+
+    SECTION("Should reject indices out of range") {
+        const std::vector<float> values(faceVertexIndices.size(), 1.0f);
+        REQUIRE_FALSE(HdNukeFindUniformPointValues(
+            values.data(), sizeof(float), faceVertexIndices.data(),
+            faceVertexIndices.size(), 4, pointFaceVertices));
+    }
+
+    SECTION("Should handle large meshes") {
+        // A strip of quads, enough to be split between threads.
+        const size_t numQuads = 100000;
+        std::vector<int> stripIndices;
+        std::vector<float> values;
+        for (size_t i = 0; i < numQuads; i++) {
+            const int quad[] = {int(i * 2), int(i * 2 + 1), int(i * 2 + 3), int(i * 2 + 2)};
+            for (int point : quad) {
+                stripIndices.push_back(point);
+                values.push_back(point * 0.5f);
+            }
+        }
+        const size_t stripPoints = numQuads * 2 + 2;
+        REQUIRE(HdNukeFindUniformPointValues(
+            values.data(), sizeof(float), stripIndices.data(),
+            stripIndices.size(), stripPoints, pointFaceVertices));
+
+        values[values.size() / 2 + 1] += 1.0f;
+        REQUIRE_FALSE(HdNukeFindUniformPointValues(
+            values.data(), sizeof(float), stripIndices.data(),
+            stripIndices.size(), stripPoints, pointFaceVertices));
+    }
+}
@@ -0,0 +1,98 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/primvarRequirements.h"
+
+#include <pxr/pxr.h>
+#include <pxr/imaging/hd/tokens.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    HdMaterialNode Node(const char* identifier)
+    {
+        HdMaterialNode node;
+        node.path = SdfPath("/material/" + std::string(identifier));
+        node.identifier = TfToken(identifier);
+        return node;
+    }
+}
+
+TEST_CASE("HdNukeMatchNamePattern") {
+    REQUIRE(HdNukeMatchNamePattern("vel", "vel"));
+    REQUIRE_FALSE(HdNukeMatchNamePattern("vel", "velocity"));
+    REQUIRE(HdNukeMatchNamePattern("vel*", "velocity"));
+    REQUIRE(HdNukeMatchNamePattern("*", ""));
+    REQUIRE(HdNukeMatchNamePattern("*id", "particle_id"));
+    REQUIRE_FALSE(HdNukeMatchNamePattern("*id", "idle"));
+    REQUIRE(HdNukeMatchNamePattern("P?", "PW"));
+    REQUIRE_FALSE(HdNukeMatchNamePattern("P?", "P"));
+    REQUIRE(HdNukeMatchNamePattern("a*b*c", "aXbYbZc"));
+    REQUIRE_FALSE(HdNukeMatchNamePattern("a*b*c", "aXbYcZ"));
+}
+
+TEST_CASE("HdNukePrimvarRequirements") {
+    HdNukePrimvarRequirements requirements;
+
+    SECTION("Should require what renderers read on their own") {
+        REQUIRE(requirements.IsRequired(HdTokens->points));
+        REQUIRE(requirements.IsRequired(HdTokens->normals));
+        REQUIRE(requirements.IsRequired(HdTokens->displayColor));
+        REQUIRE_FALSE(requirements.IsRequired(TfToken("st")));
+        REQUIRE_FALSE(requirements.IsRequired(TfToken("PW")));
+        REQUIRE_FALSE(requirements.IsRequired(HdTokens->velocities));
+    }
+
+    SECTION("Should require what the material reads") {
+        HdMaterialNode reader = Node("UsdPrimvarReader_float3");
+        reader.parameters[TfToken("varname")] = VtValue(TfToken("PW"));
+        HdMaterialNode stringReader = Node("UsdPrimvarReader_float");
+        stringReader.parameters[TfToken("varname")] = VtValue(std::string("mask"));
+
+        HdMaterialNetworkMap material;
+        HdMaterialNetwork& network = material.map[TfToken("surface")];
+        network.nodes = {Node("UsdPreviewSurface"), Node("UsdUVTexture"),
+                         reader, stringReader};
+        network.primvars.push_back(TfToken("rest"));
+        requirements.AddMaterial(material);
+
+        REQUIRE(requirements.IsRequired(TfToken("st")));
+        REQUIRE(requirements.IsRequired(TfToken("PW")));
+        REQUIRE(requirements.IsRequired(TfToken("mask")));
+        REQUIRE(requirements.IsRequired(TfToken("rest")));
+        REQUIRE_FALSE(requirements.IsRequired(HdTokens->velocities));
+    }
+
+    SECTION("Should require names matching the whitelist") {
+        requirements.AddPatterns("vel, user_*  id?");
+        REQUIRE(requirements.IsRequired(TfToken("vel")));
+        REQUIRE(requirements.IsRequired(TfToken("user_mask")));
+        REQUIRE(requirements.IsRequired(TfToken("id0")));
+        REQUIRE_FALSE(requirements.IsRequired(TfToken("id")));
+        REQUIRE_FALSE(requirements.IsRequired(TfToken("PW")));
+    }
+
+    SECTION("Should compare by what is required") {
+        HdNukePrimvarRequirements other;
+        REQUIRE(requirements == other);
+        other.AddPrimvar(TfToken("PW"));
+        REQUIRE(requirements != other);
+        requirements.AddPatterns("PW");
+        REQUIRE(requirements == other);
+    }
+}
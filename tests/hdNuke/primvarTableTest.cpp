@@ -0,0 +1,157 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/primvarTable.h"
+
+#include <pxr/pxr.h>
+
+#include <string>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    // What the primvars of one adapter may take up inline, for a mesh with
+    // UVs.
+    constexpr size_t PrimvarTableBudget = 192;
+
+    const TfToken points("points");
+    const TfToken normals("normals");
+    const TfToken st("st");
+    const TfToken displayColor("displayColor");
+    const TfToken wireframeColor("overrideWireframeColor");
+    const TfToken point("point");
+    const TfToken color("color");
+}
+
+TEST_CASE("HdNukePrimvarTable") {
+    HdNukePrimvarTable table;
+
+    SECTION("Should find primvars by name") {
+        table.Add(points, HdInterpolationVertex, point);
+        table.Add(displayColor, HdInterpolationConstant, color, VtValue(1));
+
+        REQUIRE(table.GetSize() == 2);
+        REQUIRE(table.Find(points) != nullptr);
+        REQUIRE(table.Find(points)->value.IsEmpty());
+        REQUIRE(table.GetValue(displayColor).IsHolding<int>());
+        REQUIRE(table.Find(normals) == nullptr);
+        REQUIRE(table.GetValue(normals).IsEmpty());
+    }
+
+    SECTION("Should replace a primvar added again in place") {
+        table.Add(points, HdInterpolationVertex, point);
+        table.Add(st, HdInterpolationFaceVarying, TfToken());
+        table.Add(points, HdInterpolationVertex, point, VtValue(2));
+
+        REQUIRE(table.GetSize() == 2);
+        REQUIRE(table.begin()->name == points);
+        REQUIRE(table.GetValue(points).UncheckedGet<int>() == 2);
+    }
+
+    SECTION("Should only set the values and interpolations of primvars it has") {
+        table.Add(st, HdInterpolationFaceVarying, TfToken());
+
+        REQUIRE(table.SetValue(st, VtValue(3)));
+        REQUIRE(table.SetInterpolation(st, HdInterpolationVertex));
+        REQUIRE_FALSE(table.SetValue(normals, VtValue(4)));
+        REQUIRE_FALSE(table.SetInterpolation(normals, HdInterpolationVertex));
+        REQUIRE(table.GetSize() == 1);
+        REQUIRE(table.Find(st)->interpolation == HdInterpolationVertex);
+    }
+
+    SECTION("Should move values out") {
+        table.Add(normals, HdInterpolationVertex, TfToken(), VtValue(5));
+
+        REQUIRE(table.TakeValue(normals).UncheckedGet<int>() == 5);
+        REQUIRE(table.GetValue(normals).IsEmpty());
+        REQUIRE(table.TakeValue(st).IsEmpty());
+    }
+
+    SECTION("Should list descriptors by interpolation in the order added") {
+        table.Add(wireframeColor, HdInterpolationConstant, wireframeColor);
+        table.Add(points, HdInterpolationVertex, point);
+        table.Add(normals, HdInterpolationVertex, TfToken());
+        table.Add(displayColor, HdInterpolationConstant, color);
+
+        const HdPrimvarDescriptorVector constant =
+            table.GetDescriptors(HdInterpolationConstant);
+        REQUIRE(constant.size() == 2);
+        REQUIRE(constant[0].name == wireframeColor);
+        REQUIRE(constant[1].name == displayColor);
+        REQUIRE(constant[1].role == color);
+
+        const HdPrimvarDescriptorVector vertex =
+            table.GetDescriptors(HdInterpolationVertex);
+        REQUIRE(vertex.size() == 2);
+        REQUIRE(vertex[0].name == points);
+        REQUIRE(vertex[1].name == normals);
+
+        REQUIRE(table.GetDescriptors(HdInterpolationUniform).empty());
+    }
+
+    SECTION("Should compare layouts without the values") {
+        HdNukePrimvarTable other;
+        table.Add(points, HdInterpolationVertex, point, VtValue(1));
+        other.Add(points, HdInterpolationVertex, point);
+        REQUIRE(table.HasSameLayout(other));
+
+        other.SetInterpolation(points, HdInterpolationFaceVarying);
+        REQUIRE_FALSE(table.HasSameLayout(other));
+
+        other.Clear();
+        REQUIRE(other.IsEmpty());
+        REQUIRE_FALSE(table.HasSameLayout(other));
+    }
+
+    SECTION("Should keep the values of primvars it shares with a new layout") {
+        HdNukePrimvarTable other;
+        table.Add(normals, HdInterpolationVertex, TfToken(), VtValue(6));
+        table.Add(st, HdInterpolationVertex, TfToken(), VtValue(7));
+        other.Add(points, HdInterpolationVertex, point);
+        other.Add(normals, HdInterpolationFaceVarying, TfToken(), VtValue(8));
+
+        table.SetLayout(other);
+
+        REQUIRE(table.HasSameLayout(other));
+        REQUIRE(table.GetValue(points).IsEmpty());
+        REQUIRE(table.GetValue(normals).UncheckedGet<int>() == 6);
+        REQUIRE(table.Find(st) == nullptr);
+    }
+
+    SECTION("Should hold a simple mesh's primvars inline within the budget") {
+        table.Add(wireframeColor, HdInterpolationConstant, wireframeColor);
+        table.Add(points, HdInterpolationVertex, point);
+        table.Add(st, HdInterpolationFaceVarying, TfToken(), VtValue(2));
+        table.Add(displayColor, HdInterpolationConstant, color);
+
+        REQUIRE(table.GetMemoryUsage() == sizeof(HdNukePrimvarTable));
+        REQUIRE(table.GetMemoryUsage() <= PrimvarTableBudget);
+    }
+
+    SECTION("Should count primvars that don't fit inline") {
+        for (unsigned i = 0; i <= HdNukePrimvarTable::InlineCapacity; i++) {
+            table.Add(TfToken("primvar" + std::to_string(i)),
+                      HdInterpolationVertex, TfToken());
+        }
+
+        REQUIRE(table.GetSize() == HdNukePrimvarTable::InlineCapacity + 1);
+        REQUIRE(table.GetMemoryUsage()
+                >= sizeof(HdNukePrimvarTable)
+                   + table.GetSize() * sizeof(HdNukePrimvarTable::Entry));
+    }
+}
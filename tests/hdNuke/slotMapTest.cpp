@@ -0,0 +1,122 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/slotMap.h"
+
+#include <pxr/pxr.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST_CASE("HdNukeSlotMap") {
+    HdNukeSlotMap<std::string> slotMap;
+
+    SECTION("Should find values by handle") {
+        HdNukeSlotHandle a = slotMap.Insert("a");
+        HdNukeSlotHandle b = slotMap.Insert("b");
+
+        REQUIRE(slotMap.GetSize() == 2);
+        REQUIRE(a != b);
+        REQUIRE(slotMap.Get(a) != nullptr);
+        REQUIRE(*slotMap.Get(a) == "a");
+        REQUIRE(*slotMap.Get(b) == "b");
+    }
+
+    SECTION("Should not find anything with an invalid handle") {
+        slotMap.Insert("a");
+
+        HdNukeSlotHandle invalid;
+        REQUIRE_FALSE(invalid.IsValid());
+        REQUIRE_FALSE(slotMap.Contains(invalid));
+        REQUIRE(slotMap.Get(invalid) == nullptr);
+        REQUIRE_FALSE(slotMap.Erase(invalid));
+    }
+
+    SECTION("Should keep the other values when erasing one") {
+        HdNukeSlotHandle a = slotMap.Insert("a");
+        HdNukeSlotHandle b = slotMap.Insert("b");
+        HdNukeSlotHandle c = slotMap.Insert("c");
+
+        REQUIRE(slotMap.Erase(a));
+
+        REQUIRE(slotMap.GetSize() == 2);
+        REQUIRE(slotMap.Get(a) == nullptr);
+        REQUIRE(*slotMap.Get(b) == "b");
+        REQUIRE(*slotMap.Get(c) == "c");
+        REQUIRE_FALSE(slotMap.Erase(a));
+    }
+
+    SECTION("Should not find an erased value once its slot is reused") {
+        HdNukeSlotHandle a = slotMap.Insert("a");
+        slotMap.Erase(a);
+        HdNukeSlotHandle b = slotMap.Insert("b");
+
+        REQUIRE(b.index == a.index);
+        REQUIRE(slotMap.Get(a) == nullptr);
+        REQUIRE(*slotMap.Get(b) == "b");
+    }
+
+    SECTION("Should keep the values contiguous") {
+        std::vector<HdNukeSlotHandle> handles;
+        for (int i = 0; i < 5; ++i) {
+            handles.push_back(slotMap.Insert(std::to_string(i)));
+        }
+        slotMap.Erase(handles[1]);
+        slotMap.Erase(handles[3]);
+
+        std::vector<std::string> values(slotMap.begin(), slotMap.end());
+        std::sort(values.begin(), values.end());
+        REQUIRE(values == std::vector<std::string>{"0", "2", "4"});
+
+        for (size_t i = 0; i < slotMap.GetSize(); ++i) {
+            REQUIRE(slotMap.Get(slotMap.GetHandle(i)) == &*(slotMap.begin() + i));
+        }
+    }
+
+    SECTION("Should not find anything after clearing") {
+        HdNukeSlotHandle a = slotMap.Insert("a");
+        HdNukeSlotHandle b = slotMap.Insert("b");
+
+        slotMap.Clear();
+
+        REQUIRE(slotMap.IsEmpty());
+        REQUIRE(slotMap.Get(a) == nullptr);
+        REQUIRE(slotMap.Get(b) == nullptr);
+
+        HdNukeSlotHandle c = slotMap.Insert("c");
+        REQUIRE(slotMap.GetSize() == 1);
+        REQUIRE(*slotMap.Get(c) == "c");
+        REQUIRE(slotMap.Get(a) == nullptr);
+        REQUIRE(slotMap.Get(b) == nullptr);
+    }
+}
+
+TEST_CASE("HdNukeSlotMap with move-only values") {
+    HdNukeSlotMap<std::unique_ptr<int>> slotMap;
+    HdNukeSlotHandle a = slotMap.Insert(std::unique_ptr<int>(new int(1)));
+    HdNukeSlotHandle b = slotMap.Insert(std::unique_ptr<int>(new int(2)));
+
+    slotMap.Erase(a);
+
+    REQUIRE(slotMap.GetSize() == 1);
+    REQUIRE(**slotMap.Get(b) == 2);
+}
@@ -0,0 +1,84 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/timeSampleCache.h"
+
+#include <pxr/pxr.h>
+
+#include <string>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+    using Cache = HdNukeTimeSampleCache<std::string>;
+
+    Cache::ValuePtr Value(const char* value)
+    {
+        return std::make_shared<const std::string>(value);
+    }
+}
+
+TEST_CASE("HdNukeTimeSampleCache") {
+    Cache cache(3);
+
+    SECTION("Should find an entry by time and hash") {
+        cache.Insert(10.25, 1, Value("a"));
+        REQUIRE(cache.Find(10.25, 1) != nullptr);
+        REQUIRE(*cache.Find(10.25, 1) == "a");
+        REQUIRE(cache.Find(10.5, 1) == nullptr);
+    }
+
+    SECTION("Should not find an entry whose inputs changed") {
+        cache.Insert(10.25, 1, Value("a"));
+        REQUIRE(cache.Find(10.25, 2) == nullptr);
+    }
+
+    SECTION("Should match times that only differ by rounding") {
+        cache.Insert(10.0 + 1.0 / 3.0, 1, Value("a"));
+        REQUIRE(cache.Find(11.0 - 2.0 / 3.0, 1) != nullptr);
+    }
+
+    SECTION("Should replace the entry for a time") {
+        cache.Insert(10.0, 1, Value("a"));
+        cache.Insert(10.0, 2, Value("b"));
+        REQUIRE(cache.GetSize() == 1);
+        REQUIRE(cache.Find(10.0, 1) == nullptr);
+        REQUIRE(*cache.Find(10.0, 2) == "b");
+    }
+
+    SECTION("Should drop the least recently used entry when full") {
+        cache.Insert(1.0, 1, Value("a"));
+        cache.Insert(2.0, 1, Value("b"));
+        cache.Insert(3.0, 1, Value("c"));
+        REQUIRE(cache.Find(1.0, 1) != nullptr);
+        cache.Insert(4.0, 1, Value("d"));
+        REQUIRE(cache.GetSize() == 3);
+        REQUIRE(cache.Find(2.0, 1) == nullptr);
+        REQUIRE(cache.Find(1.0, 1) != nullptr);
+        REQUIRE(cache.Find(3.0, 1) != nullptr);
+        REQUIRE(cache.Find(4.0, 1) != nullptr);
+    }
+
+    SECTION("Should drop entries over a smaller capacity") {
+        cache.Insert(1.0, 1, Value("a"));
+        cache.Insert(2.0, 1, Value("b"));
+        cache.SetCapacity(1);
+        REQUIRE(cache.GetSize() == 1);
+        REQUIRE(cache.Find(2.0, 1) != nullptr);
+    }
+}
@@ -0,0 +1,115 @@
+// Copyright 2019-present The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <gmock/gmock.h>
+#include <catch2/catch.hpp>
+
+#include "../../src/hdNuke/vertexWelding.h"
+
+#include <pxr/pxr.h>
+
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST_CASE("Vertex welding") {
+    SECTION("Should merge coincident points") {
+        // Two quads stored with their own copies of the shared edge.
+        const std::vector<float> points = {
+            0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0,
+            1, 0, 0,  2, 0, 0,  2, 1, 0,  1, 1, 0
+        };
+        const HdNukeWeldMap weldMap =
+            HdNukeBuildWeldMap(points.data(), points.size() / 3, 0.0f);
+
+        REQUIRE(weldMap.GetWeldedPointCount() == 6);
+        REQUIRE(weldMap.pointRemap == std::vector<int>({0, 1, 2, 3, 1, 4, 5, 2}));
+        REQUIRE(weldMap.representatives == std::vector<int>({0, 1, 2, 3, 5, 6}));
+    }
+
+    SECTION("Should merge points within the tolerance across cells") {
+        // Either side of a cell boundary at a tolerance of 0.1.
+        const std::vector<float> points = {
+            0.09f, 0, 0,  5, 5, 5,  0.11f, 0, 0,  0.3f, 0, 0
+        };
+        const HdNukeWeldMap weldMap =
+            HdNukeBuildWeldMap(points.data(), points.size() / 3, 0.1f);
+
+        REQUIRE(weldMap.pointRemap == std::vector<int>({0, 1, 0, 2}));
+        REQUIRE(weldMap.representatives == std::vector<int>({0, 1, 3}));
+    }
+
+    SECTION("Should chain merges through points in between") {
+        const std::vector<float> points = {
+            0, 0, 0,  0.08f, 0, 0,  0.16f, 0, 0,  0.24f, 0, 0
+        };
+        const HdNukeWeldMap weldMap =
+            HdNukeBuildWeldMap(points.data(), points.size() / 3, 0.1f);
+
+        REQUIRE(weldMap.pointRemap == std::vector<int>({0, 0, 0, 0}));
+        REQUIRE(weldMap.representatives == std::vector<int>({0}));
+    }
+
+    SECTION("Should return an empty map if no points are merged") {
+        const std::vector<float> points = {
+            0, 0, 0,  1, 0, 0,  0, 1, 0
+        };
+        const HdNukeWeldMap weldMap =
+            HdNukeBuildWeldMap(points.data(), points.size() / 3, 0.01f);
+
+        REQUIRE(weldMap.IsEmpty());
+        REQUIRE(weldMap.pointRemap.empty());
+    }
+
+    SECTION("Should remap face vertex indices") {
+        const std::vector<float> points = {
+            0, 0, 0,  1, 0, 0,  0, 0, 0
+        };
+        const HdNukeWeldMap weldMap =
+            HdNukeBuildWeldMap(points.data(), points.size() / 3, 0.0f);
+
+        std::vector<int> indices = {0, 1, 2, 2, 1};
+        HdNukeRemapPointIndices(weldMap, indices.data(), indices.size());
+        REQUIRE(indices == std::vector<int>({0, 1, 0, 0, 1}));
+
+        // An empty map leaves the indices alone.
+        std::vector<int> unchanged = {0, 1, 2};
+        HdNukeRemapPointIndices(HdNukeWeldMap(), unchanged.data(), unchanged.size());
+        REQUIRE(unchanged == std::vector<int>({0, 1, 2}));
+    }
+}
+
+TEST_CASE("Vertex welding of a large mesh", "[.][benchmark]") {
+    // A 1000x1000 grid of quads with every face storing its own points.
+    const int size = 1000;
+    std::vector<float> points;
+    points.reserve(size * size * 4 * 3);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+            for (const auto& corner : corners) {
+                points.push_back((x + corner[0]) * 0.01f);
+                points.push_back((y + corner[1]) * 0.01f);
+                points.push_back(0.0f);
+            }
+        }
+    }
+
+    BENCHMARK("4M points") {
+        return HdNukeBuildWeldMap(points.data(), points.size() / 3, 1e-5f)
+            .GetWeldedPointCount();
+    };
+}
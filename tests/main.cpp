@@ -14,6 +14,7 @@
 //
 
 #define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch2/catch.hpp"
 #include "gmock/gmock.h"
 #include <iostream>